@@ -19,25 +19,31 @@ file(READ "${CMAKE_MODULE_PATH}/BMI2.cpp" test_source_bmi2)
 CHECK_CXX_SOURCE_RUNS("${test_source_bmi2}" HAVE_BMI2)
 set(CMAKE_REQUIRED_FLAGS "")
 
-
-if(HAVE_SSE42)
-  message(STATUS "${Green}Compiler supports SSE4.2${ColourReset}")
-  if(NOT MSVC)
-    CheckAndAppendCompilerFlags(${CMAKE_BUILD_TYPE} "-msse4.2")
-  endif()
-else()
+if(PORTABLE)
+  # bits.hpp detects popcnt and BMI2 at runtime (see cpu_features.hpp)
+  message(STATUS "${Green}Portable build: SSE4.2 and BMI2 are detected at runtime${ColourReset}")
   set(HAVE_SSE42 0)
-  message(STATUS "${Red}Compiler does NOT supports SSE4.2${ColourReset}")
-endif()
+  set(HAVE_BMI2 0)
+else()
+  if(HAVE_SSE42)
+    message(STATUS "${Green}Compiler supports SSE4.2${ColourReset}")
+    if(NOT MSVC)
+      CheckAndAppendCompilerFlags(${CMAKE_BUILD_TYPE} "-msse4.2")
+    endif()
+  else()
+    set(HAVE_SSE42 0)
+    message(STATUS "${Red}Compiler does NOT supports SSE4.2${ColourReset}")
+  endif()
 
-if(HAVE_BMI2)
-  message(STATUS "${Green}Compiler supports BMI2${ColourReset}")
-  if(NOT MSVC)
-    CheckAndAppendCompilerFlags(${CMAKE_BUILD_TYPE} "-mbmi2")
+  if(HAVE_BMI2)
+    message(STATUS "${Green}Compiler supports BMI2${ColourReset}")
+    if(NOT MSVC)
+      CheckAndAppendCompilerFlags(${CMAKE_BUILD_TYPE} "-mbmi2")
+    endif()
+  else()
+    set(HAVE_BMI2 0)
+    message(STATUS "${Red}Compiler does NOT supports BMI2${ColourReset}")
   endif()
-else()
-  set(HAVE_BMI2 0)
-  message(STATUS "${Red}Compiler does NOT supports BMI2${ColourReset}")
 endif()
 
 file(READ "${CMAKE_MODULE_PATH}/MODETI.cpp" test_source_modeti)
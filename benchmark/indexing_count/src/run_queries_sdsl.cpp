@@ -2,7 +2,9 @@
  * Run Queries
  */
 #include <sdsl/suffix_arrays.hpp>
+#include <array>
 #include <string>
+#include <vector>
 
 #include <stdlib.h>
 #include "interface.h"
@@ -15,6 +17,7 @@
 #include <sys/resource.h>
 
 #define COUNT 		('C')
+#define BATCH_COUNT 	('B')
 #define LOCATE 		('L')
 #define EXTRACT 	('E')
 #define DISPLAY 	('D')
@@ -25,6 +28,7 @@ using namespace std;
 
 /* local headers */
 void do_count(const CSA_TYPE&);
+void do_batch_count(const CSA_TYPE&);
 void do_locate(const CSA_TYPE&);
 void pfile_info(ulong* length, ulong* numpatt);
 double getTime(void);
@@ -99,6 +103,14 @@ int main(int argc, char* argv[])
                 }
             do_count(csa);
             break;
+        case BATCH_COUNT:
+            if (argc > 3)
+                if (*argv[3] == VERBOSE) {
+                    Verbose = 1;
+                    fprintf(stdout,"%c", COUNT);
+                }
+            do_batch_count(csa);
+            break;
         case LOCATE:
             if (argc > 3)
                 if (*argv[3] == VERBOSE) {
@@ -166,6 +178,50 @@ do_count(const CSA_TYPE& csa)
     free(pattern);
 }
 
+/* Reads all patterns and counts them with backward_search_batch */
+void
+do_batch_count(const CSA_TYPE& csa)
+{
+    ulong length, tot_numocc = 0, numpatt;
+    double time, tot_time = 0;
+
+    pfile_info(&length, &numpatt);
+
+    vector<string> patterns(numpatt, string(length, 0));
+    for (ulong i = 0; i < numpatt; ++i) {
+        if (fread(&patterns[i][0], sizeof(uchar), length, stdin) != length) {
+            fprintf(stderr, "Error: cannot read patterns file\n");
+            exit(1);
+        }
+    }
+
+    /* Count */
+    vector<array<CSA_TYPE::size_type, 2>> ranges;
+    time = getTime();
+    backward_search_batch(csa, patterns, ranges);
+    tot_time = getTime() - time;
+
+    for (ulong i = 0; i < numpatt; ++i) {
+        ulong numocc = ranges[i][1] + 1 - ranges[i][0];
+        if (Verbose) {
+            fwrite(&length, sizeof(length), 1, stdout);
+            fwrite(patterns[i].data(), sizeof(uchar), length, stdout);
+            fwrite(&numocc, sizeof(numocc), 1, stdout);
+        }
+        tot_numocc += numocc;
+    }
+
+    fprintf(stderr, "# Total_Num_occs_found = %lu\n", tot_numocc);
+    fprintf(stderr, "# Count_time_in_milli_sec = %.4f\n", tot_time*1000);
+    fprintf(stderr, "# Count_time/Pattern_chars = %.4f\n",
+            (tot_time * 1000) / (length * numpatt));
+    fprintf(stderr, "# Count_time/Num_patterns = %.4f\n\n",
+            (tot_time * 1000) / numpatt);
+    fprintf(stderr, "# (Load_time+Count_time)/Pattern_chars = %.4f\n",
+            ((Load_time+tot_time) * 1000) / (length * numpatt));
+    fprintf(stderr, "# (Load_time+Count_time)/Num_patterns = %.4f\n\n",
+            ((Load_time+tot_time) * 1000) / numpatt);
+}
 
 void
 do_locate(const CSA_TYPE& csa)
@@ -273,6 +329,7 @@ void usage(char* progname)
     fprintf(stderr, "Usage:  %s <index> <type> [length] [V]\n", progname);
     fprintf(stderr, "\n\t<type>   denotes the type of queries:\n");
     fprintf(stderr, "\t         %c counting queries;\n", COUNT);
+    fprintf(stderr, "\t         %c counting queries with backward_search_batch;\n", BATCH_COUNT);
     fprintf(stderr, "\t         %c locating queries;\n", LOCATE);
     fprintf(stderr, "\t         %c displaying queries;\n", DISPLAY);
     fprintf(stderr, "\t         %c extracting queries.\n\n", EXTRACT);
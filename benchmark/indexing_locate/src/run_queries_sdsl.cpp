@@ -2,7 +2,10 @@
  * Run Queries
  */
 #include <sdsl/suffix_arrays.hpp>
+#include <sdsl/query_executor.hpp>
+#include <chrono>
 #include <string>
+#include <vector>
 
 #include <stdlib.h>
 #include "interface.h"
@@ -16,6 +19,7 @@
 
 #define COUNT 		('C')
 #define LOCATE 		('L')
+#define LOCATE_MT 	('M')
 #define EXTRACT 	('E')
 #define DISPLAY 	('D')
 #define VERBOSE 	('V')
@@ -26,6 +30,7 @@ using namespace std;
 /* local headers */
 void do_count(const CSA_TYPE&);
 void do_locate(const CSA_TYPE&);
+void do_locate_mt(const CSA_TYPE&, ulong threads);
 void do_extract(const CSA_TYPE&);
 //void do_display(ulong length);
 void pfile_info(ulong* length, ulong* numpatt);
@@ -87,6 +92,9 @@ int main(int argc, char* argv[])
                 }
             do_locate(csa);
             break;
+        case LOCATE_MT:
+            do_locate_mt(csa, argc > 3 ? strtoul(argv[3], NULL, 10) : 0);
+            break;
         case EXTRACT:
             if (argc > 3)
                 if (*argv[3] == VERBOSE) {
@@ -213,6 +221,48 @@ do_locate(const CSA_TYPE& csa)
 }
 
 
+void
+do_locate_mt(const CSA_TYPE& csa, ulong threads)
+{
+    ulong length, numpatt = 0, tot_numocc = 0;
+    uchar* pattern;
+
+    pfile_info(&length, &numpatt);
+
+    pattern = (uchar*) malloc(sizeof(uchar) * (length));
+    if (pattern == NULL) {
+        fprintf(stderr, "Error: cannot allocate\n");
+        exit(1);
+    }
+    vector<string> patterns;
+    patterns.reserve(numpatt);
+    for (ulong i = 0; i < numpatt; ++i) {
+        if (fread(pattern, sizeof(*pattern), length, stdin) != length) {
+            fprintf(stderr, "Error: cannot read patterns file\n");
+            perror("run_queries");
+            exit(1);
+        }
+        patterns.emplace_back((char*)pattern, length);
+    }
+    free(pattern);
+
+    query_executor<CSA_TYPE> exec(csa, threads);
+    /* getTime() sums up the CPU time of all threads, so we measure wall time */
+    auto start = chrono::steady_clock::now();
+    auto occs = exec.locate(patterns);
+    double tot_time = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    for (const auto& occ : occs) {
+        tot_numocc += occ.size();
+    }
+
+    fprintf(stderr, "# threads = %lu\n", (ulong)exec.threads());
+    fprintf(stderr, "# processed_pattern = %lu\n", numpatt);
+    fprintf(stderr, "# Total_Num_occs_found = %lu\n", tot_numocc);
+    fprintf(stderr, "# Locate_time_in_secs = %.2f\n", tot_time);
+    fprintf(stderr, "# Locate_time/Num_occs = %.4f\n\n", (tot_time * 1000) / tot_numocc);
+    fprintf(stderr, "# (Load_time+Locate_time)/Num_occs = %.4f\n\n", ((tot_time+Load_time) * 1000) / tot_numocc);
+}
+
 /* Open patterns file and read header */
 void
 pfile_info(ulong* length, ulong* numpatt)
@@ -318,15 +368,18 @@ void usage(char* progname)
     fprintf(stderr, "genpatterns or genintervals.\n");
     fprintf(stderr, "%s reports on the standard error time statistics\n", progname);
     fprintf(stderr, "regarding to running the queries.\n\n");
-    fprintf(stderr, "Usage:  %s <index> <type> [length] [V]\n", progname);
+    fprintf(stderr, "Usage:  %s <index> <type> [length|threads] [V]\n", progname);
     fprintf(stderr, "\n\t<type>   denotes the type of queries:\n");
     fprintf(stderr, "\t         %c counting queries;\n", COUNT);
     fprintf(stderr, "\t         %c locating queries;\n", LOCATE);
+    fprintf(stderr, "\t         %c locating queries with several threads;\n", LOCATE_MT);
     fprintf(stderr, "\t         %c displaying queries;\n", DISPLAY);
     fprintf(stderr, "\t         %c extracting queries.\n\n", EXTRACT);
     fprintf(stderr, "\n\t[length] must be provided in case of displaying queries (D)\n");
     fprintf(stderr, "\t         and denotes the number of characters to display\n");
     fprintf(stderr, "\t         before and after each pattern occurrence.\n");
+    fprintf(stderr, "\n\t[threads] number of threads for multi-threaded locating\n");
+    fprintf(stderr, "\t         queries (M). Default: number of hardware threads.\n");
     fprintf(stderr, "\n\t[V]      with this options it reports on the standard output\n");
     fprintf(stderr, "\t         the results of the queries. The results file should be\n");
     fprintf(stderr, "\t         compared with trusted one by compare program.\n\n");
@@ -0,0 +1,103 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <sdsl/bit_vectors.hpp>
+#include <sdsl/simd_popcount.hpp>
+
+using namespace std;
+using namespace sdsl;
+
+using namespace std::chrono;
+using timer = std::chrono::high_resolution_clock;
+
+//! Counts the 1-bits of v in blocks of block_words words with the given kernel
+/*! \param v           The bit vector.
+ *  \param kernel      The popcount kernel.
+ *  \param block_words Number of words which are passed to one kernel call.
+ *  \param reps        Number of passes over v.
+ *  \return Sum of all counts (to prevent the compiler from removing the loop).
+ */
+uint64_t count_blocks(const bit_vector& v, simd_popcount::kernel_type kernel,
+                      uint64_t block_words, uint64_t reps)
+{
+    const uint64_t* data = v.data();
+    uint64_t words = v.capacity() >> 6;
+    uint64_t cnt = 0;
+    for (uint64_t r = 0; r < reps; ++r) {
+        for (uint64_t i = 0; i < words; i += block_words) {
+            cnt += simd_popcount::words(kernel, data + i, std::min(block_words, words - i));
+        }
+    }
+    return cnt;
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 3) {
+        cout << "Usage: " << argv[0] << " log_size density" << endl;
+        cout << " generates a random bit vector of 2^log_size bits, in which each bit" << endl;
+        cout << " is set with probability density, and counts its 1-bits in blocks" << endl;
+        cout << " of different sizes with all popcount kernels supported by the CPU." << endl;
+        return 1;
+    }
+    uint64_t log_size = stoull(argv[1]);
+    double density = stod(argv[2]);
+    bit_vector bv(1ULL << log_size, 0);
+    std::mt19937_64 rng(17);
+    std::bernoulli_distribution coin(density);
+    for (uint64_t i = 0; i < bv.size(); ++i) {
+        bv[i] = coin(rng);
+    }
+    uint64_t words = bv.size() >> 6;
+    uint64_t reps = std::max((uint64_t)1, (uint64_t)((1ULL << 30) / bv.size())); // process at least 2^30 bits
+
+    cout << "# log_size = " << log_size << endl;
+    cout << "# density = " << density << endl;
+    cout << "# best_kernel = " << simd_popcount::name(simd_popcount::best_kernel()) << endl;
+    cout << "kernel;block_words;ns_per_word;GB_per_s;ones" << endl;
+    const simd_popcount::kernel_type kernels[] = {simd_popcount::scalar, simd_popcount::avx2,
+                                                  simd_popcount::avx512
+                                                 };
+    for (uint64_t block_words : {(uint64_t)6, (uint64_t)8, (uint64_t)32, (uint64_t)256, (uint64_t)4096, words}) {
+        for (auto kernel : kernels) {
+            if (!simd_popcount::supported(kernel)) continue;
+            count_blocks(bv, kernel, block_words, 1); // warm up
+            auto start = timer::now();
+            uint64_t ones = count_blocks(bv, kernel, block_words, reps);
+            auto stop = timer::now();
+            double ns = duration_cast<nanoseconds>(stop - start).count();
+            cout << simd_popcount::name(kernel) << ";" << block_words << ";"
+                 << ns / (words * reps) << ";" << (8.0 * words * reps) / ns << ";" << ones / reps
+                 << endl;
+        }
+    }
+
+    // library functions which use the dispatched kernel
+    auto start = timer::now();
+    uint64_t ones = 0;
+    for (uint64_t r = 0; r < reps; ++r) {
+        ones += util::cnt_one_bits(bv);
+    }
+    auto stop = timer::now();
+    cout << "# cnt_one_bits_ns_per_word = "
+         << (double)duration_cast<nanoseconds>(stop - start).count() / (words * reps) << endl;
+
+    rank_support_scan<1> rs_scan(&bv);
+    start = timer::now();
+    for (uint64_t r = 0; r < reps; ++r) {
+        ones += rs_scan(bv.size() - (r & 63));
+    }
+    stop = timer::now();
+    cout << "# rank_support_scan_ns_per_word = "
+         << (double)duration_cast<nanoseconds>(stop - start).count() / (words * reps) << endl;
+
+    start = timer::now();
+    for (uint64_t r = 0; r < reps; ++r) {
+        rank_support_v5<1> rs_v5(&bv);
+        ones += rs_v5(bv.size());
+    }
+    stop = timer::now();
+    cout << "# rank_support_v5_construct_ns_per_word = "
+         << (double)duration_cast<nanoseconds>(stop - start).count() / (words * reps) << endl;
+    cout << "# checksum = " << ones << endl;
+}
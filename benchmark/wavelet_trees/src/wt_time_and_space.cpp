@@ -46,6 +46,65 @@ uint64_t test_inverse_select(const t_wt& wt, const vector<size_type>& is, uint64
     return cnt;
 }
 
+// test access_batch, rank_batch and inverse_select_batch; all return 0 if the
+// wavelet tree does not provide the batch methods
+template<class t_wt>
+auto test_access_batch(const t_wt& wt, const vector<size_type>& is, uint64_t times, int)
+-> decltype(wt.access_batch(nullptr, 0, nullptr), uint64_t())
+{
+    vector<value_type> res(times);
+    wt.access_batch(is.data(), times, res.data());
+    uint64_t cnt=0;
+    for (uint64_t i=0; i<times; ++i) {
+        cnt += res[i];
+    }
+    return cnt;
+}
+
+template<class t_wt>
+uint64_t test_access_batch(const t_wt&, const vector<size_type>&, uint64_t, long)
+{
+    return 0; // access_batch not implemented
+}
+
+template<class t_wt>
+auto test_rank_batch(const t_wt& wt, const vector<size_type>& is, const vector<value_type>& cs, uint64_t times, int)
+-> decltype(wt.rank_batch(nullptr, nullptr, 0, nullptr), uint64_t())
+{
+    vector<size_type> res(times);
+    wt.rank_batch(is.data(), cs.data(), times, res.data());
+    uint64_t cnt=0;
+    for (uint64_t i=0; i<times; ++i) {
+        cnt += res[i];
+    }
+    return cnt;
+}
+
+template<class t_wt>
+uint64_t test_rank_batch(const t_wt&, const vector<size_type>&, const vector<value_type>&, uint64_t, long)
+{
+    return 0; // rank_batch not implemented
+}
+
+template<class t_wt>
+auto test_inverse_select_batch(const t_wt& wt, const vector<size_type>& is, uint64_t times, int)
+-> decltype(wt.inverse_select_batch(nullptr, 0, nullptr), uint64_t())
+{
+    vector<pair<size_type, value_type>> res(times);
+    wt.inverse_select_batch(is.data(), times, res.data());
+    uint64_t cnt=0;
+    for (uint64_t i=0; i<times; ++i) {
+        cnt += res[i].first;
+    }
+    return cnt;
+}
+
+template<class t_wt>
+uint64_t test_inverse_select_batch(const t_wt&, const vector<size_type>&, uint64_t, long)
+{
+    return 0; // inverse_select_batch not implemented
+}
+
 // test interval_symbols
 template<class t_wt>
 uint64_t
@@ -258,6 +317,27 @@ int main(int argc, char* argv[])
     cout << "# inverse_select_time = " << duration_cast<microseconds>(stop-start).count()/(double)reps << endl;
     cout << "# inverse_select_check = " << check << endl;
 
+    // access_batch
+    start = timer::now();
+    check = test_access_batch(wt, is, reps, 0);
+    stop = timer::now();
+    cout << "# access_batch_time = " << duration_cast<microseconds>(stop-start).count()/(double)reps << endl;
+    cout << "# access_batch_check = " << check << endl;
+
+    // rank_batch
+    start = timer::now();
+    check = test_rank_batch(wt, is, cs, reps, 0);
+    stop = timer::now();
+    cout << "# rank_batch_time = " << duration_cast<microseconds>(stop-start).count()/(double)reps << endl;
+    cout << "# rank_batch_check = " << check << endl;
+
+    // inverse_select_batch
+    start = timer::now();
+    check = test_inverse_select_batch(wt, is, reps, 0);
+    stop = timer::now();
+    cout << "# inverse_select_batch_time = " << duration_cast<microseconds>(stop-start).count()/(double)reps << endl;
+    cout << "# inverse_select_batch_check = " << check << endl;
+
     // interval_symbols
     const uint64_t reps_interval_symbols = wt.sigma < 10000 ? reps : reps/100;
     start = timer::now();
@@ -11,7 +11,8 @@ int main(int argc, char** argv)
 {
     if (argc < 2) {
         cout << "Usage: " << argv[0] << " file" << endl;
-        cout << " Creates a CST and CSA for a byte file and visualizes the memory utilization during construction." << endl;
+        cout << " Creates a CST and CSA for a byte file and visualizes the memory utilization during construction" << endl;
+        cout << " and the wall time, CPU time, I/O and peak memory of each construction phase." << endl;
         return 1;
     }
 
@@ -31,6 +32,10 @@ int main(int argc, char** argv)
     cout << "writing memory usage visualization to cst-construction.html\n";
     memory_monitor::write_memory_log<HTML_FORMAT>(cstofs);
     cstofs.close();
+    std::ofstream cstprofs("cst-construction-profile.html");
+    cout << "writing phase profile to cst-construction-profile.html\n";
+    memory_monitor::write_profile<HTML_FORMAT>(cstprofs);
+    cstprofs.close();
     util::clear(cst);
 
     memory_monitor::start();
@@ -46,5 +51,9 @@ int main(int argc, char** argv)
     cout << "writing memory usage visualization to csa-construction.html\n";
     memory_monitor::write_memory_log<HTML_FORMAT>(csaofs);
     csaofs.close();
+    std::ofstream csaprofs("csa-construction-profile.json");
+    cout << "writing phase profile to csa-construction-profile.json\n";
+    memory_monitor::write_profile<JSON_FORMAT>(csaprofs);
+    csaprofs.close();
 
 }
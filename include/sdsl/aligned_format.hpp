@@ -0,0 +1,226 @@
+// Copyright (c) 2016, the SDSL Project Authors.  All rights reserved.
+// Please see the AUTHORS file for details.  Use of this source code is governed
+// by a BSD license that can be found in the LICENSE file.
+/*! \file aligned_format.hpp
+    \brief aligned_format.hpp contains the on-disk format in which all
+           int_vector payloads are aligned to cache line boundaries.
+*/
+#ifndef INCLUDED_SDSL_ALIGNED_FORMAT
+#define INCLUDED_SDSL_ALIGNED_FORMAT
+
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <streambuf>
+#include <vector>
+
+namespace sdsl {
+
+//! Entry of the table of contents of a file in the aligned format.
+struct toc_entry {
+	uint64_t offset; //!< Byte offset of an int_vector payload in the file.
+	uint64_t size;   //!< Size of the payload in bytes.
+};
+
+//! Aligned on-disk format.
+/*!
+ * The file layout is
+ * \verbatim
+   [magic][version][serialized structure][toc entries][#entries][toc offset]
+   \endverbatim
+ * where all fields except the structure are 64-bit words. Inside the
+ * structure, each int_vector header is followed by a byte \f$p\f$ and
+ * \f$p\f$ zero bytes, such that the payload starts at a multiple of
+ * aligned_format::alignment. Everything else is identical to the plain
+ * format. Since the payloads are aligned, load_mapped can map all of them,
+ * and the table of contents (see read_toc) lists the payload regions, e.g.
+ * to prefetch or madvise them individually.
+ *
+ * The format is only used for streams which are bound to a writer or
+ * reader object. In particular, size_in_bytes and the structure_tree
+ * still report the sizes of the plain format.
+ */
+class aligned_format {
+public:
+	//! The string "SDSLALGN" read as little endian 64-bit word.
+	static uint64_t magic() { return 0x4e474c414c534453ULL; }
+	//! Version of the format.
+	static uint64_t version() { return 1; }
+	//! Alignment of the payloads in bytes.
+	static uint64_t alignment() { return 64; }
+
+private:
+	struct state_type {
+		const std::ostream*	out = nullptr;
+		const std::istream*	in  = nullptr;
+		std::vector<toc_entry>* toc = nullptr;
+	};
+
+	static state_type& state()
+	{
+		static thread_local state_type s;
+		return s;
+	}
+
+	//! Forwards all output to another stream buffer and counts the written bytes.
+	class counting_streambuf : public std::streambuf {
+	private:
+		std::streambuf* m_dest;
+		uint64_t		m_pos = 0;
+
+	public:
+		explicit counting_streambuf(std::streambuf* dest) : m_dest(dest) {}
+
+	protected:
+		int_type overflow(int_type c) override
+		{
+			if (traits_type::eq_int_type(c, traits_type::eof())) return traits_type::not_eof(c);
+			if (traits_type::eq_int_type(m_dest->sputc(traits_type::to_char_type(c)),
+										 traits_type::eof()))
+				return traits_type::eof();
+			++m_pos;
+			return c;
+		}
+
+		std::streamsize xsputn(const char* s, std::streamsize n) override
+		{
+			std::streamsize written = m_dest->sputn(s, n);
+			m_pos += written;
+			return written;
+		}
+
+		int sync() override { return m_dest->pubsync(); }
+
+		pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode) override
+		{
+			if (off != 0 or dir != std::ios_base::cur) return pos_type(off_type(-1));
+			return pos_type(off_type(m_pos));
+		}
+	};
+
+public:
+	//! Writes a file in the aligned format to an output stream.
+	/*! The constructor writes the file header, finish() the table of
+	 *  contents. Structures have to be serialized to stream().
+	 */
+	class writer {
+	private:
+		counting_streambuf	 m_buf;
+		std::ostream		   m_out;
+		std::vector<toc_entry> m_toc;
+		state_type			   m_prev;
+
+	public:
+		explicit writer(std::ostream& out) : m_buf(out.rdbuf()), m_out(&m_buf), m_prev(state())
+		{
+			uint64_t header[2] = {magic(), version()};
+			m_out.write((const char*)header, sizeof(header));
+			state().out = &m_out;
+			state().toc = &m_toc;
+		}
+		writer(const writer&) = delete;
+		writer& operator=(const writer&) = delete;
+		~writer() { state() = m_prev; }
+
+		//! The stream to which the structure has to be serialized.
+		std::ostream& stream() { return m_out; }
+
+		//! Writes the table of contents.
+		void finish()
+		{
+			uint64_t toc_offset = (uint64_t)m_out.tellp();
+			for (const auto& e : m_toc) {
+				m_out.write((const char*)&e, sizeof(e));
+			}
+			uint64_t trailer[2] = {(uint64_t)m_toc.size(), toc_offset};
+			m_out.write((const char*)trailer, sizeof(trailer));
+			m_out.flush();
+		}
+	};
+
+	//! Reads the header of a file and binds the aligned format to the stream if present.
+	/*! If the stream does not start with the magic number, it is rewound
+	 *  and read in the plain format.
+	 */
+	class reader {
+	private:
+		state_type m_prev;
+		bool	   m_aligned = false;
+
+	public:
+		explicit reader(std::istream& in) : m_prev(state())
+		{
+			uint64_t header[2] = {0, 0};
+			in.read((char*)header, sizeof(uint64_t));
+			if (in and header[0] == magic()) {
+				in.read((char*)(header + 1), sizeof(uint64_t));
+				if (!in or header[1] > version()) {
+					throw std::runtime_error("aligned_format: unsupported version");
+				}
+				m_aligned = true;
+				state().in = &in;
+			} else {
+				in.clear();
+				in.seekg(0);
+			}
+		}
+		reader(const reader&) = delete;
+		reader& operator=(const reader&) = delete;
+		~reader() { state() = m_prev; }
+
+		//! Returns true if the file is in the aligned format.
+		bool aligned() const { return m_aligned; }
+	};
+
+	//! Writes the padding in front of a payload of bytes bytes, if out is bound to a writer.
+	/*! \returns The number of written bytes.
+	 */
+	static uint64_t write_padding(std::ostream& out, uint64_t bytes)
+	{
+		state_type& s = state();
+		if (s.out != &out) return 0;
+		uint64_t pos = (uint64_t)out.tellp() + 1;
+		uint8_t  pad = (alignment() - pos % alignment()) % alignment();
+		char	 zeros[64] = {0};
+		out.put((char)pad);
+		out.write(zeros, pad);
+		s.toc->push_back({pos + pad, bytes});
+		return 1 + pad;
+	}
+
+	//! Skips the padding in front of a payload, if in is bound to a reader.
+	static void skip_padding(std::istream& in)
+	{
+		if (state().in != &in) return;
+		char zeros[64];
+		in.read(zeros, 1);
+		in.read(zeros, (uint8_t)zeros[0]);
+	}
+};
+
+//! Reads the table of contents of a file in the aligned format.
+/*! \param in        Stream of the file.
+ *  \param file_size Size of the file in bytes.
+ *  \param toc       Receives one entry per int_vector payload.
+ *  \returns false if the file is not in the aligned format.
+ */
+inline bool read_toc(std::istream& in, uint64_t file_size, std::vector<toc_entry>& toc)
+{
+	uint64_t header[2] = {0, 0}, trailer[2] = {0, 0};
+	in.read((char*)header, sizeof(header));
+	if (!in or header[0] != aligned_format::magic() or file_size < 4 * sizeof(uint64_t))
+		return false;
+	in.seekg(file_size - sizeof(trailer));
+	in.read((char*)trailer, sizeof(trailer));
+	if (!in or trailer[1] + trailer[0] * sizeof(toc_entry) + sizeof(trailer) != file_size)
+		return false;
+	toc.resize(trailer[0]);
+	in.seekg(trailer[1]);
+	in.read((char*)toc.data(), toc.size() * sizeof(toc_entry));
+	return (bool)in;
+}
+
+} // end namespace sdsl
+
+#endif
@@ -0,0 +1,574 @@
+// Copyright (c) 2016, the SDSL Project Authors.  All rights reserved.
+// Please see the AUTHORS file for details.  Use of this source code is governed
+// by a BSD license that can be found in the LICENSE file.
+/*!\file bit_vector_cl.hpp
+   \brief bit_vector_cl.hpp contains the sdsl::bit_vector_cl class, and
+          classes which support rank and select for bit_vector_cl.
+*/
+#ifndef INCLUDED_SDSL_BIT_VECTOR_CL
+#define INCLUDED_SDSL_BIT_VECTOR_CL
+
+#include "int_vector.hpp"
+#include "util.hpp"
+#include "iterators.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+//! Namespace for the succinct data structure library
+namespace sdsl {
+
+template <uint8_t t_b = 1> // forward declaration needed for friend declaration
+class rank_support_cl;	 // in bit_vector_cl
+
+template <uint8_t t_b = 1, uint32_t t_sample_dens = 4096> // forward declaration needed for friend
+class select_support_cl;								  // declaration in bit_vector_cl
+
+//! Moves words [offset..offset+words) of data to the first 64-byte aligned position.
+/*! data has to provide 7 words of padding. The padding is cleared, and
+ *  data is copied to the heap if it lives in a read-only mapping.
+ *  \returns The new offset.
+ */
+inline int_vector<64>::size_type cache_line_align(int_vector<64>&			 data,
+												  int_vector<64>::size_type offset,
+												  int_vector<64>::size_type words)
+{
+	if (data.empty()) return offset;
+	int_vector<64>::size_type new_offset = ((64 - ((uintptr_t)data.data() & 63)) & 63) / 8;
+	if (new_offset == offset) return offset;
+	if (memory_manager::is_mapped(data)) { // mappings are read-only
+		int_vector<64> tmp(data);
+		data = std::move(tmp);
+		return cache_line_align(data, offset, words);
+	}
+	memmove(data.data() + new_offset, data.data() + offset, words * sizeof(uint64_t));
+	// clear the padding, parts of the old words may remain there
+	std::fill(data.data(), data.data() + new_offset, 0);
+	std::fill(data.data() + new_offset + words, data.data() + data.size(), 0);
+	return new_offset;
+}
+
+//! A bit vector which interleaves the bits with rank information in cache lines.
+/*!
+ * The bits are stored in 512-bit lines which are aligned to cache line
+ * boundaries. Line \f$L\f$ holds the bits \f$[448L..448L+448)\f$ in its
+ * words 1 to 7. Its first word holds (in the style of poppy)
+ *  - bits 0..31: the number of set bits in front of the line, relative to
+ *    the start of its block of \f$2^{23}\f$ lines, and
+ *  - bits 32..58: the number of set bits in the first 2, 4 and 6 payload
+ *    words of the line (9 bits each).
+ *
+ * The absolute counts of the blocks are stored in a separate array of
+ * \f$n/2^{32}\f$ words, which stays in cache. A rank query therefore
+ * touches exactly one cache line and needs at most two popcounts. A
+ * select query reads one cache line of hints, which narrows the answer
+ * down to a few lines, and picks the word in the answer line with the
+ * counters of its first 2, 4 and 6 words (see select_support_cl).
+ *
+ * In contrast to bit_vector_il, which interleaves a 64-bit counter every
+ * t_bs bits, each rank query reads a single aligned cache line. The
+ * space overhead is 64/448 = 14.3% plus the select hints.
+ *
+ * Data is kept aligned by moving it after a copy or load, if the new
+ * buffer has a different alignment than the old one. The lines are
+ * always serialized at offset 0, so the serialized form does not depend
+ * on the address of the buffer. A structure loaded with load_mapped is
+ * copied to the heap if its lines are not aligned in the mapping.
+ */
+class bit_vector_cl {
+public:
+	typedef bit_vector::size_type						size_type;
+	typedef size_type									value_type;
+	typedef bit_vector::difference_type					difference_type;
+	typedef random_access_const_iterator<bit_vector_cl> iterator;
+	typedef iterator									const_iterator;
+	typedef bv_tag										index_category;
+
+	friend class rank_support_cl<1>;
+	friend class rank_support_cl<0>;
+	template <uint8_t, uint32_t>
+	friend class select_support_cl;
+
+	typedef rank_support_cl<1>   rank_1_type;
+	typedef rank_support_cl<0>   rank_0_type;
+	typedef select_support_cl<1> select_1_type;
+	typedef select_support_cl<0> select_0_type;
+
+	enum { line_words = 8 };		//!< 64-bit words per line
+	enum { line_bits = 7 * 64 };	//!< payload bits per line
+	enum { block_lines_log = 23 };  //!< log of the number of lines per block
+
+private:
+	size_type	  m_size   = 0; //!< Size of the original bit vector
+	size_type	  m_lines  = 0; //!< Number of lines
+	size_type	  m_offset = 0; //!< Position of the first line in m_data (in words)
+	int_vector<64> m_data;		//!< Lines plus padding for the alignment
+	int_vector<64> m_block_rank; //!< Number of set bits in front of each block
+
+	const uint64_t* line(size_type l) const { return m_data.data() + m_offset + l * line_words; }
+
+	//! Number of set bits in front of line l.
+	size_type line_rank(size_type l) const
+	{
+		return m_block_rank[l >> block_lines_log] + (uint32_t)line(l)[0];
+	}
+
+	//! Moves the lines to the first 64-byte aligned position of m_data.
+	void align() { m_offset = cache_line_align(m_data, m_offset, m_lines * line_words); }
+
+public:
+	bit_vector_cl() {}
+	bit_vector_cl(const bit_vector_cl& v)
+		: m_size(v.m_size)
+		, m_lines(v.m_lines)
+		, m_offset(v.m_offset)
+		, m_data(v.m_data)
+		, m_block_rank(v.m_block_rank)
+	{
+		align();
+	}
+	bit_vector_cl(bit_vector_cl&&) = default;
+	bit_vector_cl& operator=(const bit_vector_cl& v)
+	{
+		if (this != &v) {
+			bit_vector_cl tmp(v);
+			*this = std::move(tmp);
+		}
+		return *this;
+	}
+	bit_vector_cl& operator=(bit_vector_cl&&) = default;
+
+	bit_vector_cl(const bit_vector& bv)
+	{
+		m_size = bv.size();
+		// the last line also exists if m_size is a multiple of line_bits, so that
+		// rank(size()) can be answered without a special case
+		m_lines		 = m_size / line_bits + 1;
+		m_data		 = int_vector<64>(m_lines * line_words + line_words - 1, 0);
+		m_block_rank = int_vector<64>((m_lines >> block_lines_log) + 1, 0);
+		m_offset	 = ((64 - ((uintptr_t)m_data.data() & 63)) & 63) / 8;
+		uint64_t* p  = m_data.data() + m_offset;
+
+		const uint64_t* bvp		= bv.data();
+		size_type		words   = (m_size + 63) >> 6;
+		uint64_t		cum_sum = 0;
+		for (size_type l = 0, i = 0; l < m_lines; ++l, p += line_words) {
+			if ((l & bits::lo_set[block_lines_log]) == 0) m_block_rank[l >> block_lines_log] = cum_sum;
+			uint64_t cnt[line_words] = {0}; // cnt[k] = number of set bits in the payload words 1..k
+			for (size_type k = 1; k < line_words; ++k) {
+				if (i < words) {
+					p[k] = bvp[i++];
+					if (i == words and (m_size & 63)) p[k] &= bits::lo_set[m_size & 63];
+				}
+				cnt[k] = cnt[k - 1] + bits::cnt(p[k]);
+			}
+			p[0] = (cum_sum - m_block_rank[l >> block_lines_log]) | cnt[2] << 32 | cnt[4] << 41 |
+				   cnt[6] << 50;
+			cum_sum += cnt[7];
+		}
+	}
+
+	//! Accessing the i-th element of the original bit_vector
+	/*! \param i An index i with \f$ 0 \leq i < size()  \f$.
+         *  \return The i-th bit of the original bit_vector
+         *  \par Time complexity
+         *     \f$ \Order{1} \f$
+         */
+	value_type operator[](size_type i) const
+	{
+		assert(i < m_size);
+		size_type r = i % line_bits;
+		return (line(i / line_bits)[1 + (r >> 6)] >> (r & 63)) & 1ULL;
+	}
+
+	//! Get the integer value of the binary string of length len starting at position idx.
+	/*! \param idx Starting index of the binary representation of the integer.
+         *  \param len Length of the binary representation of the integer. Default value is 64.
+         *   \returns The integer value of the binary string of length len starting at position idx.
+         *
+         *  \pre idx+len-1 in [0..size()-1]
+         *  \pre len in [1..64]
+         */
+	uint64_t get_int(size_type idx, uint8_t len = 64) const
+	{
+		assert(idx + len - 1 < m_size);
+		size_type		b_r = idx % line_bits, e_r = (idx + len - 1) % line_bits;
+		const uint64_t* b_w = line(idx / line_bits) + 1 + (b_r >> 6);
+		const uint64_t* e_w = line((idx + len - 1) / line_bits) + 1 + (e_r >> 6);
+		if (b_w == e_w) { // spans one word
+			return (*b_w >> (idx & 63)) & bits::lo_set[len];
+		} else { // spans two words
+			uint8_t b_len = 64 - (idx & 63);
+			return (*b_w >> (idx & 63)) | (*e_w & bits::lo_set[len - b_len]) << b_len;
+		}
+	}
+
+	//! Returns the size of the original bit vector.
+	size_type size() const { return m_size; }
+
+	//! Serializes the data structure into the given ostream
+	size_type
+	serialize(std::ostream& out, structure_tree_node* v = nullptr, std::string name = "") const
+	{
+		structure_tree_node* child = structure_tree::add_child(v, name, util::class_name(*this));
+		size_type			 written_bytes = 0;
+		written_bytes += write_member(m_size, out, child, "size");
+		written_bytes += write_member(m_lines, out, child, "lines");
+		written_bytes += write_member((size_type)0, out, child, "offset");
+		if (0 == m_offset) {
+			written_bytes += m_data.serialize(out, child, "data");
+		} else {
+			int_vector<64> data(m_data.size(), 0);
+			std::copy(line(0), line(m_lines), data.begin());
+			written_bytes += data.serialize(out, child, "data");
+		}
+		written_bytes += m_block_rank.serialize(out, child, "block_rank");
+		structure_tree::add_size(child, written_bytes);
+		return written_bytes;
+	}
+
+	//! Loads the data structure from the given istream.
+	void load(std::istream& in)
+	{
+		read_member(m_size, in);
+		read_member(m_lines, in);
+		read_member(m_offset, in);
+		m_data.load(in);
+		m_block_rank.load(in);
+		align();
+	}
+
+	iterator begin() const { return iterator(this, 0); }
+
+	iterator end() const { return iterator(this, size()); }
+
+	bool operator==(const bit_vector_cl& v) const
+	{
+		if (m_size != v.m_size) return false;
+		return std::equal(line(0), line(m_lines), v.line(0));
+	}
+
+	bool operator!=(const bit_vector_cl& v) const { return !(*this == v); }
+};
+
+//! Rank support for bit_vector_cl.
+/*! Reads one cache line per query.
+ *  \tparam t_b Bit pattern `0` or `1`.
+ */
+template <uint8_t t_b>
+class rank_support_cl {
+	static_assert(t_b == 1 or t_b == 0, "rank_support_cl only supports bitpatterns 0 or 1.");
+
+public:
+	typedef bit_vector::size_type size_type;
+	typedef bit_vector_cl		  bit_vector_type;
+	enum { bit_pat = t_b };
+	enum { bit_pat_len = (uint8_t)1 };
+
+private:
+	const bit_vector_type* m_v;
+
+	size_type rank1(size_type i) const
+	{
+		size_type		l	= i / bit_vector_type::line_bits;
+		size_type		r	= i - l * bit_vector_type::line_bits;
+		const uint64_t* p	= m_v->line(l);
+		uint64_t		h	= p[0];
+		size_type		w	= r >> 6; // payload word which contains bit i
+		// add the count of the first 0, 2, 4 or 6 payload words; field 0 of (h >> 32 << 9) is zero
+		size_type res = m_v->m_block_rank[l >> bit_vector_type::block_lines_log] + (uint32_t)h +
+						(((h >> 32 << 9) >> (9 * (w >> 1))) & 0x1FF);
+		// if w is odd, payload word w-1 (=p[w]) is not covered by the counts
+		res += bits::cnt(p[w] & -(uint64_t)(w & 1));
+		return res + bits::cnt(p[w + 1] & bits::lo_set[r & 63]);
+	}
+
+public:
+	rank_support_cl(const bit_vector_type* v = nullptr) { set_vector(v); }
+
+	//! Returns the number of occurrences of the bit pattern in [0..i).
+	size_type rank(size_type i) const
+	{
+		assert(i <= m_v->size());
+		if (t_b) return rank1(i);
+		return i - rank1(i);
+	}
+
+	size_type operator()(size_type i) const { return rank(i); }
+
+	//! Prefetches the cache line needed by rank(i).
+	void prefetch(size_type i) const { SDSL_PREFETCH(m_v->line(i / bit_vector_type::line_bits)); }
+
+	size_type size() const { return m_v->size(); }
+
+	void set_vector(const bit_vector_type* v = nullptr) { m_v = v; }
+
+	rank_support_cl(const rank_support_cl&) = default;
+	rank_support_cl(rank_support_cl&&)		= default;
+	rank_support_cl& operator=(const rank_support_cl&) = default;
+	rank_support_cl& operator=(rank_support_cl&&) = default;
+
+	void load(std::istream&, const bit_vector_type* v = nullptr) { set_vector(v); }
+
+	size_type
+	serialize(std::ostream& out, structure_tree_node* v = nullptr, std::string name = "") const
+	{
+		return serialize_empty_object(out, v, name, this);
+	}
+};
+
+//! Select support for bit_vector_cl.
+/*! The occurrences are divided into blocks of t_sample_dens. Each block
+ *  has one 64-byte aligned hint line:
+ *   - word 0: the line of the first occurrence of the block, or, if bit 63
+ *     is set, the index of the block in an array of explicit positions,
+ *   - words 1..7: 32 fields of 14 bits; field j < 32 holds the line of
+ *     occurrence \f$j\cdot t\_sample\_dens/32\f$ of the block and field 32
+ *     the line of its last occurrence, relative to word 0.
+ *  A block is stored explicitly if its occurrences span t_sample_dens or
+ *  more lines (or \f$2^{14}\f$), i.e. where the density is below 1/448.
+ *
+ *  A query reads the hint line, which bounds the answer to the lines of
+ *  t_sample_dens/32 occurrences, walks these lines forward (or binary
+ *  searches them if there are more than 8) and selects the word in the
+ *  answer line with its in-line counters of the first 2, 4 and 6 words.
+ *  So a query costs two cache misses (hint line and answer line, or hint
+ *  line and explicit position) if the t_sample_dens/32 occurrences lie in
+ *  one line, which holds for densities above about t_sample_dens/14336,
+ *  plus one miss for each further line otherwise.
+ *
+ *  The hints take 512 bits per t_sample_dens occurrences, e.g. 6.25% of
+ *  the bit vector for density 1/2 and the default t_sample_dens = 4096.
+ *  Explicit blocks take \f$\log n\f$ bits per occurrence, which is less
+ *  than \f$\log n/448\f$ bits per bit of the bit vector.
+ *
+ *  \tparam t_b           Bit pattern `0` or `1`.
+ *  \tparam t_sample_dens Number of occurrences per hint line; a multiple of 32.
+ */
+template <uint8_t t_b, uint32_t t_sample_dens>
+class select_support_cl {
+	static_assert(t_b == 1 or t_b == 0, "select_support_cl only supports bitpatterns 0 or 1.");
+	static_assert(t_sample_dens >= 32 and t_sample_dens % 32 == 0,
+				  "select_support_cl: t_sample_dens has to be a positive multiple of 32.");
+
+public:
+	typedef bit_vector::size_type size_type;
+	typedef bit_vector_cl		  bit_vector_type;
+	enum { bit_pat = t_b };
+	enum { bit_pat_len = (uint8_t)1 };
+
+private:
+	enum { sub_dens = t_sample_dens / 32 }; // occurrences between two fields
+	enum { field_width = 14 };
+	enum { linear_lines = 8 }; // longer intervals of lines are binary searched
+
+	const bit_vector_type* m_v	  = nullptr;
+	size_type			   m_blocks = 0;
+	size_type			   m_offset = 0; // position of the first hint line in m_hints (in words)
+	int_vector<64>		   m_hints;	  // hint lines plus padding for the alignment
+	int_vector<>		   m_explicit;   // positions of the occurrences of the explicit blocks
+
+	const uint64_t* hint(size_type k) const
+	{
+		return m_hints.data() + m_offset + k * bit_vector_type::line_words;
+	}
+
+	static size_type field(const uint64_t* h, size_type j)
+	{
+		return bits::read_int(h + 1 + (j - 1) * field_width / 64, ((j - 1) * field_width) % 64,
+							  field_width);
+	}
+
+	static void set_field(uint64_t* h, size_type j, uint64_t x)
+	{
+		bits::write_int(h + 1 + (j - 1) * field_width / 64, x, ((j - 1) * field_width) % 64,
+						field_width);
+	}
+
+	//! Number of occurrences in front of line l.
+	size_type line_cnt(size_type l) const
+	{
+		size_type ones = m_v->line_rank(l);
+		return t_b ? ones : l * bit_vector_type::line_bits - ones;
+	}
+
+	static uint64_t word(uint64_t w) { return t_b ? w : ~w; }
+
+	//! Number of occurrences in the first 2w payload words of a line with header h.
+	static size_type pair_cnt(uint64_t h, size_type w)
+	{
+		size_type ones = w ? (h >> (32 + 9 * (w - 1))) & 0x1FF : 0;
+		return t_b ? ones : 128 * w - ones;
+	}
+
+	//! Writes the hint line h of a block with the positions pos[0..cnt).
+	static void add_block(uint64_t*						h,
+						  const std::vector<size_type>& pos,
+						  size_type						cnt,
+						  std::vector<size_type>&		explicit_pos)
+	{
+		size_type first = pos[0] / bit_vector_type::line_bits;
+		size_type last  = pos[cnt - 1] / bit_vector_type::line_bits;
+		if (last - first >= std::min((size_type)t_sample_dens, bits::lo_set[field_width])) {
+			h[0] = 1ULL << 63 | explicit_pos.size() / t_sample_dens;
+			explicit_pos.insert(explicit_pos.end(), pos.begin(), pos.begin() + cnt);
+			return;
+		}
+		h[0] = first;
+		for (size_type j = 1; j <= 32; ++j) {
+			size_type o = std::min(j * sub_dens, cnt - 1);
+			set_field(h, j, pos[j < 32 ? o : cnt - 1] / bit_vector_type::line_bits - first);
+		}
+	}
+
+	void align()
+	{
+		m_offset = cache_line_align(m_hints, m_offset, m_blocks * bit_vector_type::line_words);
+	}
+
+	//! Calls f(pos) for the positions of all occurrences in increasing order.
+	template <class t_f>
+	void for_each_occurrence(t_f f) const
+	{
+		for (size_type l = 0; l < m_v->m_lines; ++l) {
+			const uint64_t* p = m_v->line(l);
+			for (size_type w = 0; w < 7; ++w) {
+				uint64_t x = word(p[1 + w]);
+				while (x) {
+					size_type pos = l * bit_vector_type::line_bits + w * 64 + bits::lo(x);
+					if (pos >= m_v->size()) return;
+					f(pos);
+					x &= x - 1;
+				}
+			}
+		}
+	}
+
+public:
+	select_support_cl(const bit_vector_type* v = nullptr)
+	{
+		set_vector(v);
+		if (v == nullptr) return;
+		size_type total = rank_support_cl<t_b>(v)(v->size());
+		m_blocks		= (total + t_sample_dens - 1) / t_sample_dens;
+		m_hints			= int_vector<64>(
+		m_blocks * bit_vector_type::line_words + bit_vector_type::line_words - 1, 0);
+		m_offset = ((64 - ((uintptr_t)m_hints.data() & 63)) & 63) / 8;
+
+		std::vector<size_type> pos(t_sample_dens), explicit_pos;
+		size_type			   cnt = 0, k = 0;
+		for_each_occurrence([&](size_type p) {
+			pos[cnt++] = p;
+			if (cnt == t_sample_dens) {
+				add_block(m_hints.data() + m_offset + (k++) * bit_vector_type::line_words, pos, cnt,
+						  explicit_pos);
+				cnt = 0;
+			}
+		});
+		if (cnt > 0)
+			add_block(m_hints.data() + m_offset + k * bit_vector_type::line_words, pos, cnt,
+					  explicit_pos);
+		m_explicit =
+		int_vector<>(explicit_pos.size(), 0, bits::hi(std::max(v->size(), (size_type)1)) + 1);
+		std::copy(explicit_pos.begin(), explicit_pos.end(), m_explicit.begin());
+	}
+
+	select_support_cl(const select_support_cl& ss)
+		: m_v(ss.m_v)
+		, m_blocks(ss.m_blocks)
+		, m_offset(ss.m_offset)
+		, m_hints(ss.m_hints)
+		, m_explicit(ss.m_explicit)
+	{
+		align();
+	}
+	select_support_cl(select_support_cl&&) = default;
+	select_support_cl& operator=(const select_support_cl& ss)
+	{
+		if (this != &ss) {
+			select_support_cl tmp(ss);
+			*this = std::move(tmp);
+		}
+		return *this;
+	}
+	select_support_cl& operator=(select_support_cl&&) = default;
+
+	//! Returns the position of the i-th occurrence in the bit vector.
+	/*! \pre \f$ 1 \leq i \leq rank(size()) \f$
+	 */
+	size_type select(size_type i) const
+	{
+		size_type		o = i - 1, r = o % t_sample_dens;
+		const uint64_t* h = hint(o / t_sample_dens);
+		if (h[0] >> 63) return m_explicit[(h[0] & bits::lo_set[63]) * t_sample_dens + r];
+		size_type j  = r / sub_dens;
+		size_type lb = h[0] + (j ? field(h, j) : 0);
+		size_type rb = h[0] + field(h, j + 1);
+		// find the last line l in [lb..rb] with line_cnt(l) < i; line_cnt(lb) < i holds
+		if (rb - lb <= linear_lines) {
+			while (lb < rb and line_cnt(lb + 1) < i)
+				++lb;
+		} else {
+			while (lb < rb) {
+				size_type mid = lb + (rb - lb + 1) / 2;
+				if (line_cnt(mid) < i) {
+					lb = mid;
+				} else {
+					rb = mid - 1;
+				}
+			}
+		}
+		const uint64_t* p = m_v->line(lb);
+		i -= line_cnt(lb);
+		// select the pair of payload words with the in-line counters
+		size_type w = (i > pair_cnt(p[0], 2)) ? ((i > pair_cnt(p[0], 3)) ? 3 : 2)
+											  : ((i > pair_cnt(p[0], 1)) ? 1 : 0);
+		i -= pair_cnt(p[0], w);
+		w *= 2;
+		size_type cnt = bits::cnt(word(p[1 + w]));
+		if (i > cnt) {
+			i -= cnt;
+			++w;
+		}
+		return lb * bit_vector_type::line_bits + w * 64 + bits::sel(word(p[1 + w]), i);
+	}
+
+	size_type operator()(size_type i) const { return select(i); }
+
+	size_type size() const { return m_v->size(); }
+
+	void set_vector(const bit_vector_type* v = nullptr) { m_v = v; }
+
+	void load(std::istream& in, const bit_vector_type* v = nullptr)
+	{
+		set_vector(v);
+		read_member(m_blocks, in);
+		read_member(m_offset, in);
+		m_hints.load(in);
+		m_explicit.load(in);
+		align();
+	}
+
+	size_type
+	serialize(std::ostream& out, structure_tree_node* v = nullptr, std::string name = "") const
+	{
+		structure_tree_node* child = structure_tree::add_child(v, name, util::class_name(*this));
+		size_type			 written_bytes = 0;
+		written_bytes += write_member(m_blocks, out, child, "blocks");
+		written_bytes += write_member((size_type)0, out, child, "offset");
+		if (0 == m_offset) {
+			written_bytes += m_hints.serialize(out, child, "hints");
+		} else {
+			int_vector<64> hints(m_hints.size(), 0);
+			std::copy(hint(0), hint(m_blocks), hints.begin());
+			written_bytes += hints.serialize(out, child, "hints");
+		}
+		written_bytes += m_explicit.serialize(out, child, "explicit");
+		structure_tree::add_size(child, written_bytes);
+		return written_bytes;
+	}
+};
+
+} // end namespace sdsl
+#endif
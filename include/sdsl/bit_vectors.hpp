@@ -10,6 +10,7 @@
 
 #include "int_vector.hpp"
 #include "bit_vector_il.hpp"
+#include "bit_vector_cl.hpp"
 #include "rrr_vector.hpp"
 #include "sd_vector.hpp"
 #include "hyb_vector.hpp"
@@ -11,6 +11,7 @@
 #include <stdint.h> // for uint64_t uint32_t declaration
 #include <iostream> // for cerr
 #include <cassert>
+#include "cpu_features.hpp"
 #ifdef __SSE4_2__
 #include <xmmintrin.h>
 #endif
@@ -493,6 +494,13 @@ inline uint64_t bits_impl<T>::cnt(uint64_t x)
 #ifdef __SSE4_2__
 	return __builtin_popcountll(x);
 #else
+#ifdef SDSL_CPU_DISPATCH
+	if (cpu_features::popcnt) {
+		uint64_t res;
+		asm("popcntq %1, %0" : "=r"(res) : "rm"(x));
+		return res;
+	}
+#endif
 #ifdef POPCOUNT_TL
 	return lt_cnt[x & 0xFFULL] + lt_cnt[(x >> 8) & 0xFFULL] + lt_cnt[(x >> 16) & 0xFFULL] +
 		   lt_cnt[(x >> 24) & 0xFFULL] + lt_cnt[(x >> 32) & 0xFFULL] + lt_cnt[(x >> 40) & 0xFFULL] +
@@ -583,7 +591,14 @@ inline uint32_t bits_impl<T>::sel(uint64_t x, uint32_t i)
 	// taken from folly
 	return _tzcnt_u64(_pdep_u64(1ULL << (i - 1), x));
 #endif
-#ifdef __SSE4_2__
+#ifdef SDSL_CPU_DISPATCH
+	if (cpu_features::bmi2) {
+		uint64_t res;
+		asm("pdepq %2, %1, %0\n\ttzcntq %0, %0" : "=&r"(res) : "r"(1ULL << (i - 1)), "rm"(x));
+		return res;
+	}
+#endif
+#if defined(__SSE4_2__) or defined(SDSL_CPU_DISPATCH)
 	uint64_t s = x, b;
 	s		   = s - ((s >> 1) & 0x5555555555555555ULL);
 	s		   = (s & 0x3333333333333333ULL) + ((s >> 2) & 0x3333333333333333ULL);
@@ -653,7 +668,7 @@ inline uint32_t bits_impl<T>::_sel(uint64_t x, uint32_t i)
 template <typename T>
 inline uint32_t bits_impl<T>::hi(uint64_t x)
 {
-#ifdef __SSE4_2__
+#if defined(__SSE4_2__) or defined(SDSL_CPU_DISPATCH)
 	if (x == 0) return 0;
 	return 63 - __builtin_clzll(x);
 #else
@@ -679,7 +694,7 @@ inline uint32_t bits_impl<T>::hi(uint64_t x)
 template <typename T>
 inline uint32_t bits_impl<T>::lo(uint64_t x)
 {
-#ifdef __SSE4_2__
+#if defined(__SSE4_2__) or defined(SDSL_CPU_DISPATCH)
 	if (x == 0) return 0;
 	return __builtin_ctzll(x);
 #else
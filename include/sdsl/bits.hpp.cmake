@@ -11,6 +11,7 @@
 #include <stdint.h> // for uint64_t uint32_t declaration
 #include <iostream> // for cerr
 #include <cassert>
+#include "cpu_features.hpp"
 
 // clang-format off
 #if @HAVE_SSE42@
@@ -498,6 +499,13 @@ inline uint64_t bits_impl<T>::cnt(uint64_t x)
 	return __builtin_popcountll(x);
 #else
 // clang-format on
+#ifdef SDSL_CPU_DISPATCH
+	if (cpu_features::popcnt) {
+		uint64_t res;
+		asm("popcntq %1, %0" : "=r"(res) : "rm"(x));
+		return res;
+	}
+#endif
 #ifdef POPCOUNT_TL
 	return lt_cnt[x & 0xFFULL] + lt_cnt[(x >> 8) & 0xFFULL] + lt_cnt[(x >> 16) & 0xFFULL] +
 		   lt_cnt[(x >> 24) & 0xFFULL] + lt_cnt[(x >> 32) & 0xFFULL] + lt_cnt[(x >> 40) & 0xFFULL] +
@@ -589,7 +597,14 @@ inline uint32_t bits_impl<T>::sel(uint64_t x, uint32_t i)
 	// taken from folly
 	return _tzcnt_u64(_pdep_u64(1ULL << (i - 1), x));
 #endif
-#if @HAVE_SSE42@
+#ifdef SDSL_CPU_DISPATCH
+	if (cpu_features::bmi2) {
+		uint64_t res;
+		asm("pdepq %2, %1, %0\n\ttzcntq %0, %0" : "=&r"(res) : "r"(1ULL << (i - 1)), "rm"(x));
+		return res;
+	}
+#endif
+#if @HAVE_SSE42@ or defined(SDSL_CPU_DISPATCH)
 	// clang-format on
 	uint64_t s = x, b;
 	s		   = s - ((s >> 1) & 0x5555555555555555ULL);
@@ -661,7 +676,7 @@ template <typename T>
 inline uint32_t bits_impl<T>::hi(uint64_t x)
 {
 // clang-format off
-#if @HAVE_SSE42@
+#if @HAVE_SSE42@ or defined(SDSL_CPU_DISPATCH)
 	if (x == 0) return 0;
 	return 63 - __builtin_clzll(x);
 #else
@@ -689,7 +704,7 @@ template <typename T>
 inline uint32_t bits_impl<T>::lo(uint64_t x)
 {
 // clang-format off
-#if @HAVE_SSE42@
+#if @HAVE_SSE42@ or defined(SDSL_CPU_DISPATCH)
 	if (x == 0) return 0;
 	return __builtin_ctzll(x);
 #else
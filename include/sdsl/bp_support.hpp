@@ -24,5 +24,6 @@
 #include "bp_support_g.hpp"
 #include "bp_support_gg.hpp"
 #include "bp_support_sada.hpp"
+#include "bp_support_rmm.hpp"
 
 #endif
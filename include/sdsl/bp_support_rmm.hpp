@@ -0,0 +1,666 @@
+// Copyright (c) 2016, the SDSL Project Authors.  All rights reserved.
+// Please see the AUTHORS file for details.  Use of this source code is governed
+// by a BSD license that can be found in the LICENSE file.
+/*! \file bp_support_rmm.hpp
+    \brief bp_support_rmm.hpp contains a balanced parentheses support structure
+     based on a range min-max tree.
+*/
+#ifndef INCLUDED_SDSL_BP_SUPPORT_RMM
+#define INCLUDED_SDSL_BP_SUPPORT_RMM
+
+#include "int_vector.hpp"
+#include "rank_support.hpp"
+#include "select_support.hpp"
+#include "bp_support_algorithm.hpp"
+#include "util.hpp"
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+namespace sdsl {
+
+//! A class that provides support for bit_vectors that represent a BP sequence.
+/*! This data structure supports the following operations:
+ *   - find_open
+ *   - find_close
+ *   - enclose
+ *   - double_enclose
+ *   - rank
+ *   - select
+ *   - excess
+ *   - rr_enclose
+ *   - rmq
+ *  An opening parenthesis in the balanced parentheses sequence is represented by a 1 in the bit_vector
+ *  and a closing parenthesis by a 0.
+ *
+ *  The sequence is divided into blocks of t_blk parentheses. A complete
+ *  binary tree over the blocks (the range min-max tree) stores the minimal
+ *  and maximal excess value of each subtree. A forward or backward excess
+ *  search first scans the block of the query and then walks up and down
+ *  the tree to the nearest block which contains the desired excess; there
+ *  is no intermediate level which is scanned linearly as in
+ *  bp_support_sada. Inside a block, whole 64-bit words whose excess range
+ *  cannot contain the desired value are skipped with one popcount and the
+ *  other words are searched bytewise with the lookup tables of
+ *  bp_support_algorithm.hpp.
+ *
+ *  \tparam t_blk     The size of the blocks; a multiple of 64. The tree takes
+ *                    about 4 log n / t_blk bits per parenthesis, so t_blk = 512
+ *                    halves the space of the default at a slower search.
+ *  \tparam t_rank    Type of rank support used for the underlying bitvector.
+ *  \tparam t_select  Type of select support used for the underlying bitvector.
+ *
+ *  \par References
+ *      - Kunihiko Sadakane, Gonzalo Navarro:
+ *        Fully-Functional Succinct Trees.
+ *        SODA 2010: 134-149
+ *      - Diego Arroyuelo, Rodrigo Cánovas, Gonzalo Navarro, Kunihiko Sadakane:
+ *        Succinct Trees in Practice.
+ *        ALENEX 2010: 84-97
+ *
+ *  @ingroup bps
+ */
+template <uint32_t t_blk	= 256,
+		  class t_rank		= rank_support_v5<>,
+		  class t_select	= select_support_mcl<>>
+class bp_support_rmm {
+public:
+	typedef bit_vector::size_type		size_type;
+	typedef bit_vector::difference_type difference_type;
+	typedef int_vector<>				min_max_array_type;
+	typedef t_rank						rank_type;
+	typedef t_select					select_type;
+
+private:
+	static_assert(t_blk > 0 and t_blk % 64 == 0, "bp_support_rmm: t_blk should be a multiple of 64!");
+	const bit_vector* m_bp = nullptr; // the supported balanced parentheses sequence as bit_vector
+	rank_type		  m_bp_rank;	  // RS for the BP sequence => see excess() and rank()
+	select_type		  m_bp_select;	// SS for the BP sequence => see select()
+
+	// min and max excess + m_size of the tree nodes; node v at 2v and 2v+1
+	min_max_array_type m_min_max;
+
+	size_type m_size   = 0; // number of supported parentheses
+	size_type m_blocks = 0; // number of blocks
+	size_type m_inner  = 0; // number of inner nodes of the tree, a power of 2 minus 1
+
+	inline static size_type block_idx(size_type i) { return i / t_blk; }
+
+	inline static bool is_root(size_type v) { return v == 0; }
+
+	inline static bool is_left_child(size_type v) { return v % 2; }
+
+	inline static size_type parent(size_type v) { return (v - 1) / 2; }
+
+	inline static size_type left_child(size_type v) { return 2 * v + 1; }
+
+	inline bool is_leaf(size_type v) const { return v >= m_inner; }
+
+	inline difference_type min_value(size_type v) const
+	{
+		return (difference_type)m_min_max[2 * v] - (difference_type)m_size;
+	}
+
+	inline difference_type max_value(size_type v) const
+	{
+		return (difference_type)m_min_max[2 * v + 1] - (difference_type)m_size;
+	}
+
+	//! True if the excess values of the subtree of v contain ex.
+	inline bool contains(size_type v, difference_type ex) const
+	{
+		return min_value(v) <= ex and ex <= max_value(v);
+	}
+
+	//! Excess value before position i, i.e. excess(i-1) with excess(-1) = 0.
+	inline difference_type excess_before(size_type i) const
+	{
+		return (difference_type)(m_bp_rank(i) << 1) - (difference_type)i;
+	}
+
+	//! Searches the minimal j in [j, end) with excess(j) = target, where cur = excess(j-1).
+	/*! On success j is the answer; otherwise j = end and cur = excess(end-1).
+	 */
+	bool fwd_scan(size_type& j, size_type end, difference_type& cur, difference_type target) const
+	{
+		const uint64_t* data = m_bp->data();
+		while (j < end) {
+			if ((j & 63) == 0 and j + 64 <= end) {
+				difference_type d = target - cur;
+				if (d < -64 or d > 64) { // not reachable in this word
+					cur += (difference_type)(bits::cnt(data[j >> 6]) << 1) - 64;
+					j += 64;
+					continue;
+				}
+			}
+			if ((j & 7) == 0 and j + 8 <= end) {
+				uint32_t		w = (data[j >> 6] >> (j & 63)) & 0xFF;
+				difference_type d = target - cur;
+				if (d >= -8 and d < 8) {
+					uint32_t p = excess::data.near_fwd_pos[((d + 8) << 8) | w];
+					if (p < 8) {
+						j += p;
+						return true;
+					}
+				} else if (d == 8 and w == 0xFF) {
+					j += 7;
+					return true;
+				}
+				cur += excess::data.word_sum[w];
+				j += 8;
+				continue;
+			}
+			cur += (data[j >> 6] >> (j & 63)) & 1 ? 1 : -1;
+			if (cur == target) return true;
+			++j;
+		}
+		return false;
+	}
+
+	//! Searches the maximal j in [begin, j] with excess(j) = target, where cur = excess(j).
+	/*! On success j is the answer, which can also be begin-1; otherwise
+	 *  j = begin-1 and cur = excess(begin-1). Positions are signed, so
+	 *  that -1 denotes the position before the sequence.
+	 */
+	bool bwd_scan(difference_type& j, difference_type begin, difference_type& cur,
+				  difference_type target) const
+	{
+		const uint64_t* data = m_bp->data();
+		while (j >= begin) {
+			if (cur == target) return true;
+			if ((j & 63) == 63 and j - 63 >= begin) {
+				difference_type d = target - cur;
+				if (d < -64 or d > 64) { // not reachable in this word
+					cur -= (difference_type)(bits::cnt(data[j >> 6]) << 1) - 64;
+					j -= 64;
+					continue;
+				}
+			}
+			if ((j & 7) == 7 and j - 7 >= begin) {
+				// checks excess(j-1), ..., excess(j-8)
+				uint32_t		w = (data[j >> 6] >> ((j - 7) & 63)) & 0xFF;
+				difference_type d = target - cur;
+				if (d >= -8 and d < 8) {
+					uint32_t p = excess::data.near_bwd_pos[((d + 8) << 8) | w];
+					if (p < 8) {
+						j = j - 8 + p;
+						return true;
+					}
+				} else if (d == 8 and w == 0) {
+					j -= 8;
+					return true;
+				}
+				cur -= excess::data.word_sum[w];
+				j -= 8;
+				continue;
+			}
+			cur -= (data[j >> 6] >> (j & 63)) & 1 ? 1 : -1;
+			--j;
+		}
+		return cur == target;
+	}
+
+	//! Calculate the min parenthesis \f$j>i\f$ with \f$excess(j)=excess(i)+rel\f$
+	/*! \param i   The index of a parenthesis in the supported sequence.
+	 *  \param rel The excess difference to the excess value of parentheses \f$i\f$.
+	 *  \return    If there exists a parenthesis \f$ j>i\f$ with
+	 *             \f$ excess(j) = excess(i)+rel \f$, \f$j\f$ is returned
+	 *             otherwise size().
+	 */
+	size_type fwd_excess(size_type i, difference_type rel) const
+	{
+		// (1) search the block of i with excess values relative to excess(i)
+		difference_type cur = 0;
+		size_type		j   = i + 1;
+		if (fwd_scan(j, std::min((block_idx(i) + 1) * t_blk, m_size), cur, rel)) return j;
+		difference_type target = excess(i) + rel;
+		// (2) go up the tree to the first right sibling which contains the target
+		size_type v = m_inner + block_idx(i);
+		while (!is_root(v)) {
+			if (is_left_child(v) and v + 1 < m_inner + m_blocks and contains(v + 1, target)) {
+				++v;
+				break;
+			}
+			v = parent(v);
+		}
+		if (is_root(v)) return size();
+		// (3) go down the tree to the leftmost block which contains the target
+		while (!is_leaf(v)) {
+			v = left_child(v);
+			if (!contains(v, target)) ++v;
+		}
+		size_type b = v - m_inner;
+		j			= b * t_blk;
+		cur			= excess_before(j);
+		fwd_scan(j, std::min((b + 1) * t_blk, m_size), cur, target);
+		return j;
+	}
+
+	//! Calculate the maximal parenthesis \f$ j<i \f$ with \f$ excess(j) = excess(i)+rel \f$
+	/*! \param i    The index of a parenthesis in the supported sequence.
+	 *  \param rel  The excess difference to the excess value of parenthesis \f$i\f$.
+	 *  \return     If there exists a parenthesis \f$j<i\f$ with \f$ excess(j) = excess(i)+rel\f$, \f$j\f$ is returned;
+	 *              -1 if the desired excess value is 0 and it is not reached before i, otherwise size().
+	 */
+	size_type bwd_excess(size_type i, difference_type rel) const
+	{
+		if (i == 0) return rel == -excess(0) ? -1 : size();
+		// (1) search the block of i with excess values relative to excess(i)
+		difference_type j   = i - 1;
+		difference_type cur = (*m_bp)[i] ? -1 : 1;
+		if (bwd_scan(j, block_idx(i) * t_blk, cur, rel)) return j;
+		difference_type target = excess(i) + rel;
+		// (2) go up the tree to the first left sibling which contains the target
+		size_type v = m_inner + block_idx(i);
+		while (!is_root(v)) {
+			if (!is_left_child(v) and contains(v - 1, target)) {
+				--v;
+				break;
+			}
+			v = parent(v);
+		}
+		if (is_root(v)) return target == 0 ? -1 : size();
+		// (3) go down the tree to the rightmost block which contains the target
+		while (!is_leaf(v)) {
+			v = left_child(v) + 1;
+			if (v >= m_inner + m_blocks or !contains(v, target)) --v;
+		}
+		size_type b = v - m_inner;
+		j			= (b + 1) * t_blk - 1;
+		cur			= excess(j);
+		bwd_scan(j, b * t_blk, cur, target);
+		return j;
+	}
+
+	//! Rightmost block with the minimal excess in blocks [bl, br] and its minimum.
+	size_type min_block(size_type bl, size_type br, difference_type& min_ex) const
+	{
+		// bottom-up traversal of the nodes which cover the range, see the
+		// iterative segment tree; with 1-based node numbers the leaves are at m_inner+1+b
+		size_type lo = bl + m_inner + 1, hi = br + m_inner + 2;
+		size_type left[128], right[128];
+		size_type nl = 0, nr = 0;
+		while (lo < hi) {
+			if (lo & 1) left[nl++] = (lo++) - 1;
+			if (hi & 1) right[nr++] = (--hi) - 1;
+			lo >>= 1;
+			hi >>= 1;
+		}
+		size_type v = 0;
+		min_ex		= std::numeric_limits<difference_type>::max();
+		for (size_type x = 0; x < nl; ++x)
+			if (min_value(left[x]) <= min_ex) {
+				min_ex = min_value(left[x]);
+				v	  = left[x];
+			}
+		for (size_type x = nr; x-- > 0;)
+			if (min_value(right[x]) <= min_ex) {
+				min_ex = min_value(right[x]);
+				v	  = right[x];
+			}
+		while (!is_leaf(v)) {
+			v = left_child(v) + 1;
+			if (v >= m_inner + m_blocks or min_value(v) != min_ex) --v;
+		}
+		return v - m_inner;
+	}
+
+public:
+	const rank_type&		  bp_rank	= m_bp_rank;   //!< RS for the underlying BP sequence.
+	const select_type&		  bp_select = m_bp_select; //!< SS for the underlying BP sequence.
+	const min_max_array_type& min_max   = m_min_max;   //!< The range min-max tree.
+
+	bp_support_rmm() {}
+
+	//! Copy constructor
+	bp_support_rmm(const bp_support_rmm& v)
+		: m_bp(v.m_bp)
+		, m_bp_rank(v.m_bp_rank)
+		, m_bp_select(v.m_bp_select)
+		, m_min_max(v.m_min_max)
+		, m_size(v.m_size)
+		, m_blocks(v.m_blocks)
+		, m_inner(v.m_inner)
+	{
+		m_bp_rank.set_vector(m_bp);
+		m_bp_select.set_vector(m_bp);
+	}
+
+	//! Move constructor
+	bp_support_rmm(bp_support_rmm&& bp_support) { *this = std::move(bp_support); }
+
+	//! Assignment operator
+	bp_support_rmm& operator=(bp_support_rmm&& bp_support)
+	{
+		if (this != &bp_support) {
+			m_bp	  = std::move(bp_support.m_bp);
+			m_bp_rank = std::move(bp_support.m_bp_rank);
+			m_bp_rank.set_vector(m_bp);
+			m_bp_select = std::move(bp_support.m_bp_select);
+			m_bp_select.set_vector(m_bp);
+			m_min_max = std::move(bp_support.m_min_max);
+			m_size	= std::move(bp_support.m_size);
+			m_blocks  = std::move(bp_support.m_blocks);
+			m_inner   = std::move(bp_support.m_inner);
+		}
+		return *this;
+	}
+
+	//! Assignment operator
+	bp_support_rmm& operator=(const bp_support_rmm& v)
+	{
+		if (this != &v) {
+			bp_support_rmm tmp(v);
+			*this = std::move(tmp);
+		}
+		return *this;
+	}
+
+	//! Constructor
+	explicit bp_support_rmm(const bit_vector* bp)
+		: m_bp(bp)
+		, m_size(bp == nullptr ? 0 : bp->size())
+		, m_blocks((m_size + t_blk - 1) / t_blk)
+		, m_inner(0)
+	{
+		if (bp == nullptr or bp->size() == 0) return;
+		// initialize rank and select
+		util::init_support(m_bp_rank, bp);
+		util::init_support(m_bp_select, bp);
+
+		// m_inner = (next power of 2 greater than or equal to m_blocks)-1
+		m_inner = 1;
+		while (m_inner < m_blocks)
+			m_inner <<= 1;
+		--m_inner;
+
+		// empty subtrees get min > max, so that they never contain an excess value
+		size_type nodes = m_inner + m_blocks;
+		m_min_max		= int_vector<>(2 * nodes, 0, bits::hi(2 * m_size + 1) + 1);
+		const uint64_t* data = bp->data();
+		difference_type ex   = 0;
+		for (size_type b = 0; b < m_blocks; ++b) {
+			difference_type min_ex = m_size, max_ex = -(difference_type)m_size;
+			size_type		end	= std::min((b + 1) * t_blk, m_size);
+			for (size_type j = b * t_blk; j < end; ++j) {
+				ex += (data[j >> 6] >> (j & 63)) & 1 ? 1 : -1;
+				min_ex = std::min(min_ex, ex);
+				max_ex = std::max(max_ex, ex);
+			}
+			m_min_max[2 * (m_inner + b)]	 = min_ex + m_size;
+			m_min_max[2 * (m_inner + b) + 1] = max_ex + m_size;
+		}
+		for (size_type v = m_inner; v-- > 0;) {
+			size_type		l = left_child(v), r = l + 1;
+			difference_type min_ex = m_size + 1, max_ex = -(difference_type)m_size;
+			if (l < nodes) {
+				min_ex = min_value(l);
+				max_ex = max_value(l);
+			}
+			if (r < nodes) {
+				min_ex = std::min(min_ex, min_value(r));
+				max_ex = std::max(max_ex, max_value(r));
+			}
+			m_min_max[2 * v]	 = min_ex + m_size;
+			m_min_max[2 * v + 1] = max_ex + m_size;
+		}
+	}
+
+	void set_vector(const bit_vector* bp)
+	{
+		m_bp = bp;
+		m_bp_rank.set_vector(bp);
+		m_bp_select.set_vector(bp);
+	}
+
+	/*! Calculates the excess value at index i.
+	 * \param i The index of which the excess value should be calculated.
+	 */
+	inline difference_type excess(size_type i) const { return excess_before(i + 1); }
+
+	/*! Returns the number of opening parentheses up to and including index i.
+	 * \pre{ \f$ 0\leq i < size() \f$ }
+	 */
+	size_type rank(size_type i) const { return m_bp_rank(i + 1); }
+
+	/*! Returns the index of the i-th opening parenthesis.
+	 * \param i Number of the parenthesis to select.
+	 * \pre{ \f$1\leq i < rank(size())\f$ }
+	 * \post{ \f$ 0\leq select(i) < size() \f$ }
+	 */
+	size_type select(size_type i) const { return m_bp_select(i); }
+
+	/*! Calculate the index of the matching closing parenthesis to the parenthesis at index i.
+	 * \param i Index of an parenthesis. 0 <= i < size().
+	 * \return * i, if the parenthesis at index i is closing,
+	 *         * the position j of the matching closing parenthesis, if a matching parenthesis exists,
+	 *         * size() if no matching closing parenthesis exists.
+	 */
+	size_type find_close(size_type i) const
+	{
+		assert(i < m_size);
+		if (!(*m_bp)[i]) { // if there is a closing parenthesis at index i return i
+			return i;
+		}
+		return fwd_excess(i, -1);
+	}
+
+	//! Calculate the matching opening parenthesis to the closing parenthesis at position i
+	/*! \param i Index of a closing parenthesis.
+	 * \return * i, if the parenthesis at index i is closing,
+	 *         * the position j of the matching opening parenthesis, if a matching parenthesis exists,
+	 *         * size() if no matching closing parenthesis exists.
+	 */
+	size_type find_open(size_type i) const
+	{
+		assert(i < m_size);
+		if ((*m_bp)[i]) { // if there is a opening parenthesis at index i return i
+			return i;
+		}
+		size_type bwd_ex = bwd_excess(i, 0);
+		if (bwd_ex == size())
+			return size();
+		else
+			return bwd_ex + 1;
+	}
+
+	//! Calculate the index of the opening parenthesis corresponding to the closest matching parenthesis pair enclosing i.
+	/*! \param i Index of an opening parenthesis.
+	 *  \return The index of the opening parenthesis corresponding to the closest matching parenthesis pair enclosing i,
+	 *          or size() if no such pair exists.
+	 */
+	size_type enclose(size_type i) const
+	{
+		assert(i < m_size);
+		if (!(*m_bp)[i]) { // if there is closing parenthesis at position i
+			return find_open(i);
+		}
+		size_type bwd_ex = bwd_excess(i, -2);
+		if (bwd_ex == size())
+			return size();
+		else
+			return bwd_ex + 1;
+	}
+
+	//! The range restricted enclose operation for parentheses pairs \f$(i,\mu(i))\f$ and \f$(j,\mu(j))\f$.
+	/*! \param i First opening parenthesis.
+	 *  \param j Second opening parenthesis \f$ i<j \wedge findclose(i) < j \f$.
+	 *  \return The smallest index, say k, of an opening parenthesis such that findclose(i) < k < j and
+	 *  findclose(j) < findclose(k). If such a k does not exists, restricted_enclose(i,j) returns size().
+	 */
+	size_type rr_enclose(const size_type i, const size_type j) const
+	{
+		assert(j < m_size);
+		assert((*m_bp)[i] == 1 and (*m_bp)[j] == 1);
+		const size_type mip1 = find_close(i) + 1;
+		if (mip1 >= j) return size();
+		return rmq_open(mip1, j);
+	}
+
+	/*! Search the interval [l,r-1] for an opening parenthesis, say i, such that find_close(i) >= r.
+	 * \param l The left end (inclusive) of the interval to search for the result.
+	 * \param r The right end (exclusive) of the interval to search for the result.
+	 * \return The minimal opening parenthesis i with \f$ \ell \leq i < r \f$ and \f$ find_close(i) \geq r \f$;
+	 *         if no such i exists size() is returned.
+	 */
+	size_type rmq_open(const size_type l, const size_type r) const
+	{
+		assert(r < m_bp->size());
+		if (l >= r) return size();
+		size_type res = rmq(l, r - 1);
+		assert(res >= l and res <= r - 1);
+		if ((*m_bp)[res] == 1) { // The parenthesis with minimal excess is opening
+			assert(find_close(res) >= r);
+			return res;
+		} else {
+			res = res + 1; // go to the next parenthesis to the right
+			if (res < r) { // The parenthesis with minimal excess if closing and the next opening parenthesis is less than r
+				assert((*m_bp)[res] == 1);
+				size_type ec = enclose(res);
+				if (ec < l or ec == size()) {
+					assert(find_close(res) >= r);
+					return res;
+				} else {
+					assert(find_close(ec) >= r);
+					return ec;
+				}
+			} else if (res == r) {
+				size_type ec =
+				enclose(res); // if m_bp[res]==0 => find_open(res), if m_bp[res]==1 => enclose(res)
+				if (ec >= l) {
+					assert(ec == size() or excess(ec) == excess(res - 1));
+					return ec;
+				}
+			}
+		}
+		return size();
+	}
+
+	//! The range minimum query (rmq) returns the index of the parenthesis with minimal excess in the range \f$[l..r]\f$
+	/*! \param l The left border of the interval \f$[l..r]\f$ (\f$l\leq r\f$).
+	 *  \param r The right border of the interval \f$[l..r]\f$ (\f$l \leq r\f$).
+	 *  \return The rightmost position of the minimal excess value.
+	 */
+	size_type rmq(size_type l, size_type r) const
+	{
+		assert(l <= r);
+		size_type		bl = block_idx(l), br = block_idx(r);
+		difference_type min_rel_ex = 0;
+		if (bl == br) return near_rmq(*m_bp, l, r, min_rel_ex);
+		// the block of l
+		size_type		min_pos = near_rmq(*m_bp, l, (bl + 1) * t_blk - 1, min_rel_ex);
+		difference_type min_ex  = excess(l) + min_rel_ex;
+		// the blocks between l and r
+		if (bl + 1 < br) {
+			difference_type ex;
+			size_type		b = min_block(bl + 1, br - 1, ex);
+			if (ex <= min_ex) {
+				min_ex  = ex;
+				min_pos = near_rmq(*m_bp, b * t_blk, (b + 1) * t_blk - 1, min_rel_ex);
+			}
+		}
+		// the block of r
+		size_type pos = near_rmq(*m_bp, br * t_blk, r, min_rel_ex);
+		if (excess(br * t_blk) + min_rel_ex <= min_ex) min_pos = pos;
+		return min_pos;
+	}
+
+	//! The double enclose operation
+	/*! \param i Index of an opening parenthesis.
+	 *  \param j Index of an opening parenthesis \f$ i<j \wedge findclose(i) < j \f$.
+	 *  \return The maximal opening parenthesis, say k, such that \f$ k<j \wedge k>findclose(j) \f$.
+	 *          If such a k does not exists, double_enclose(i,j) returns size().
+	 */
+	size_type double_enclose(size_type i, size_type j) const
+	{
+		assert(j > i);
+		assert((*m_bp)[i] == 1 and (*m_bp)[j] == 1);
+		size_type k = rr_enclose(i, j);
+		if (k == size())
+			return enclose(j);
+		else
+			return enclose(k);
+	}
+
+	//! Return the number of zeros which proceed position i in the balanced parentheses sequence.
+	/*! \param i Index of an parenthesis.
+	 */
+	size_type preceding_closing_parentheses(size_type i) const
+	{
+		assert(i < m_size);
+		if (!i) return 0;
+		size_type ones = m_bp_rank(i);
+		if (ones) { // ones > 0
+			assert(m_bp_select(ones) < i);
+			return i - m_bp_select(ones) - 1;
+		} else {
+			return i;
+		}
+	}
+
+	//! Returns the level ancestor of the node i.
+	/*! \param i The index of a parenthesis (i.e., a node).
+	 *  \param d The level, i.e., which node to select on the path from the node i up to the root.
+	 *           The level d = 0 will return the node itself, d = 1 will return its parent, and so on.
+	 */
+	size_type level_anc(size_type i, size_type d) const
+	{
+		assert(i < m_size);
+		size_type bwd_ex = bwd_excess(i, -d - 1);
+		if (bwd_ex == size())
+			return size();
+		else
+			return bwd_ex + 1;
+	}
+
+	/*! The size of the supported balanced parentheses sequence.
+	 * \return the size of the supported balanced parentheses sequence.
+	 */
+	size_type size() const { return m_size; }
+
+	//! Serializes the bp_support_rmm to a stream.
+	/*!
+	 * \param out The outstream to which the data structure is written.
+	 * \return The number of bytes written to out.
+	 */
+	size_type
+	serialize(std::ostream& out, structure_tree_node* v = nullptr, std::string name = "") const
+	{
+		structure_tree_node* child = structure_tree::add_child(v, name, util::class_name(*this));
+		size_type			 written_bytes = 0;
+		written_bytes += write_member(m_size, out, child, "size");
+		written_bytes += write_member(m_blocks, out, child, "block_cnt");
+		written_bytes += write_member(m_inner, out, child, "inner_nodes");
+
+		written_bytes += m_bp_rank.serialize(out, child, "bp_rank");
+		written_bytes += m_bp_select.serialize(out, child, "bp_select");
+
+		written_bytes += m_min_max.serialize(out, child, "min_max");
+
+		structure_tree::add_size(child, written_bytes);
+		return written_bytes;
+	}
+
+	//! Load the bp_support_rmm for a bit_vector v.
+	/*!
+	 * \param in The instream from which the data strucutre is read.
+	 * \param bp Bit vector representing a balanced parentheses sequence that is supported by this data structure.
+	 */
+	void load(std::istream& in, const bit_vector* bp)
+	{
+		m_bp = bp;
+		read_member(m_size, in);
+		assert(m_size == bp->size());
+		read_member(m_blocks, in);
+		read_member(m_inner, in);
+
+		m_bp_rank.load(in, m_bp);
+		m_bp_select.load(in, m_bp);
+
+		m_min_max.load(in);
+	}
+};
+
+} // end namespace
+
+#endif
@@ -13,7 +13,7 @@
 #include "rank_support.hpp"
 #include "select_support.hpp"
 #include "bp_support_algorithm.hpp"
-#include "fast_cache.hpp"
+#include "query_cache.hpp"
 #include <stack>
 #include <map>
 #include <set>
@@ -81,12 +81,10 @@ private:
 	size_type m_med_blocks = 0; // number of medium sized blocks
 	size_type m_med_inner_blocks =
 	0; // number of inner nodes in the min max tree of the medium sized blocks
-//#define USE_CACHE
-#ifdef USE_CACHE
-	mutable fast_cache find_close_cache;
-	mutable fast_cache find_open_cache;
-	mutable fast_cache select_cache;
-#endif
+	mutable query_cache m_cache; // answers of select, find_close and find_open
+
+	enum { select_query = 0, find_close_query = 1, find_open_query = 2 };
+	static uint64_t cache_key(size_type i, uint64_t query) { return (i << 2) | query; }
 
 	inline static size_type sml_block_idx(size_type i) { return i / t_sml_blk; }
 
@@ -332,6 +330,7 @@ public:
 		, m_sml_blocks(v.m_sml_blocks)
 		, m_med_blocks(v.m_med_blocks)
 		, m_med_inner_blocks(v.m_med_inner_blocks)
+		, m_cache(v.m_cache)
 	{
 		m_bp_rank.set_vector(m_bp);
 		m_bp_select.set_vector(m_bp);
@@ -357,6 +356,7 @@ public:
 			m_sml_blocks	   = std::move(bp_support.m_sml_blocks);
 			m_med_blocks	   = std::move(bp_support.m_med_blocks);
 			m_med_inner_blocks = std::move(bp_support.m_med_inner_blocks);
+			m_cache			   = std::move(bp_support.m_cache);
 		}
 		return *this;
 	}
@@ -447,6 +447,16 @@ public:
 		m_bp_select.set_vector(bp);
 	}
 
+	//! The cache for the answers of select, find_close and find_open.
+	/*! The cache is disabled by default. It can be enabled at runtime, also
+	 *  through a const reference (e.g. cst.bp_support.cache()), but not
+	 *  while other threads run queries:
+	 *  \code
+	 *  bps.cache().configure(query_cache::per_thread, 1 << 16);
+	 *  \endcode
+	 */
+	query_cache& cache() const { return m_cache; }
+
 	/*! Calculates the excess value at index i.
          * \param i The index of which the excess value should be calculated.
          */
@@ -464,16 +474,14 @@ public:
          */
 	size_type select(size_type i) const
 	{
-#ifdef USE_CACHE
-		size_type a = 0;
-		if (select_cache.exists(i, a)) {
-			return a;
-		} else {
-			a = m_bp_select(i);
-			select_cache.write(i, a);
+		if (m_cache.enabled()) {
+			uint64_t a = 0;
+			if (!m_cache.lookup(cache_key(i, select_query), a)) {
+				a = m_bp_select(i);
+				m_cache.store(cache_key(i, select_query), a);
+			}
 			return a;
 		}
-#endif
 		return m_bp_select(i);
 	}
 
@@ -489,16 +497,14 @@ public:
 		if (!(*m_bp)[i]) { // if there is a closing parenthesis at index i return i
 			return i;
 		}
-#ifdef USE_CACHE
-		size_type a = 0;
-		if (find_close_cache.exists(i, a)) {
-			return a;
-		} else {
-			a = fwd_excess(i, -1);
-			find_close_cache.write(i, a);
+		if (m_cache.enabled()) {
+			uint64_t a = 0;
+			if (!m_cache.lookup(cache_key(i, find_close_query), a)) {
+				a = fwd_excess(i, -1);
+				m_cache.store(cache_key(i, find_close_query), a);
+			}
 			return a;
 		}
-#endif
 		return fwd_excess(i, -1);
 	}
 
@@ -514,20 +520,15 @@ public:
 		if ((*m_bp)[i]) { // if there is a opening parenthesis at index i return i
 			return i;
 		}
-#ifdef USE_CACHE
-		size_type a = 0;
-		if (find_open_cache.exists(i, a)) {
-			return a;
-		} else {
-			size_type bwd_ex = bwd_excess(i, 0);
-			if (bwd_ex == size())
-				a = size();
-			else
-				a = bwd_ex + 1;
-			find_open_cache.write(i, a);
+		if (m_cache.enabled()) {
+			uint64_t a = 0;
+			if (!m_cache.lookup(cache_key(i, find_open_query), a)) {
+				size_type bwd_ex = bwd_excess(i, 0);
+				a				 = (bwd_ex == size()) ? size() : bwd_ex + 1;
+				m_cache.store(cache_key(i, find_open_query), a);
+			}
 			return a;
 		}
-#endif
 		size_type bwd_ex = bwd_excess(i, 0);
 		if (bwd_ex == size())
 			return size();
@@ -897,6 +898,7 @@ public:
 
 		m_sml_block_min_max.load(in);
 		m_med_block_min_max.load(in);
+		m_cache.configure(m_cache.policy(), m_cache.capacity()); // drop old answers
 	}
 };
 
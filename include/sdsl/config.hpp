@@ -14,6 +14,13 @@
 #define SDSL_UNUSED
 #endif
 
+// Hint to the processor to load the cache line containing addr.
+#ifndef MSVC_COMPILER
+#define SDSL_PREFETCH(addr) __builtin_prefetch((const void*)(addr))
+#else
+#define SDSL_PREFETCH(addr)
+#endif
+
 namespace sdsl {
 
 // forward declarations
@@ -48,7 +55,9 @@ typedef std::map<std::string, std::string> tMSS;
 
 enum format_type { JSON_FORMAT, R_FORMAT, HTML_FORMAT };
 
-enum byte_sa_algo_type { LIBDIVSUFSORT, SE_SAIS };
+enum byte_sa_algo_type { LIBDIVSUFSORT, SE_SAIS, PARALLEL_PREFIX_DOUBLING };
+
+enum lcp_algo_type { LCP_PHI, LCP_SEMI_EXTERN_PHI, LCP_PHI_PARALLEL };
 
 //! Helper class for construction process
 struct cache_config {
@@ -14,6 +14,7 @@
 #include "construct_lcp.hpp"
 #include "construct_bwt.hpp"
 #include "construct_sa.hpp"
+#include "construct_plan.hpp"
 #include <string>
 
 namespace sdsl {
@@ -38,6 +39,36 @@ void append_zero_symbol(int_vector& text)
 	text[text.size() - 1] = 0;
 }
 
+//! Makes plan the plan of the current construction and logs it as memory_monitor event.
+inline void _use_plan(const construct_plan& plan)
+{
+	last_construct_plan() = plan;
+	if (construct_config().memory_budget) {
+		memory_monitor::event("plan " + plan.to_string());
+	}
+}
+
+template <uint8_t t_width>
+void _construct_sa(cache_config& config, const construct_plan& plan)
+{
+	construct_config().byte_algo_sa = plan.sa_algo;
+	construct_config().num_threads  = plan.sa_threads;
+	construct_sa<t_width>(config);
+}
+
+template <uint8_t t_width>
+void _construct_lcp(cache_config& config, const construct_plan& plan)
+{
+	construct_config().num_threads = plan.lcp_threads;
+	if (plan.lcp_algo == LCP_PHI_PARALLEL) {
+		construct_lcp_PHI_parallel<t_width>(config);
+	} else if (t_width == 8 and plan.lcp_algo == LCP_SEMI_EXTERN_PHI) {
+		construct_lcp_semi_extern_PHI(config);
+	} else {
+		construct_lcp_PHI<t_width>(config);
+	}
+}
+
 
 template <class t_index>
 void construct(t_index& idx, std::string file, uint8_t num_bytes = 0, bool move_input = false)
@@ -106,11 +137,38 @@ t_index& idx, const std::string& file, cache_config& config, uint8_t num_bytes,
 }
 
 // Specialization for CSAs
+template <class t_index>
+constexpr auto _bwt_is_support(int) -> std::integral_constant<bool, (bool)t_index::bwt_is_support>
+{
+	return std::integral_constant<bool, (bool)t_index::bwt_is_support>();
+}
+
+template <class t_index>
+constexpr std::false_type _bwt_is_support(long)
+{
+	return std::false_type();
+}
+
+template <class t_index>
+bool _construct_csa_bwt_is(t_index& idx, cache_config& config, std::true_type)
+{
+	auto event = memory_monitor::event("construct CSA");
+	idx		   = t_index(config, bwt_is_tag());
+	return true;
+}
+
+template <class t_index>
+bool _construct_csa_bwt_is(t_index&, cache_config&, std::false_type)
+{
+	return false;
+}
+
 template <class t_index>
 void construct(
 t_index& idx, const std::string& file, cache_config& config, uint8_t num_bytes, csa_tag)
 {
 	auto			  event	= memory_monitor::event("construct CSA");
+	construct_config_scope config_scope;
 	constexpr uint8_t width	= t_index::alphabet_category::WIDTH;
 	const char*		  KEY_TEXT = key_text_trait<width>::KEY_TEXT;
 	const char*		  KEY_BWT  = key_bwt_trait<width>::KEY_BWT;
@@ -138,11 +196,28 @@ t_index& idx, const std::string& file, cache_config& config, uint8_t num_bytes,
 	if (config.delete_data) {
 		sdsl::remove(file);
 	}
+	// construct_bwt_is does not cache the SA, so it is only planned if the
+	// caller does not keep the files (a CST needs the SA for the LCP)
+	construct_plan plan =
+	plan_construction<width>(config, _bwt_is_support<t_index>(0) and config.delete_files, false);
+	_use_plan(plan);
+	if (plan.bwt_is and !cache_file_exists(conf::KEY_SA, config) and
+		!cache_file_exists(KEY_BWT, config)) {
+		construct_config().num_threads = plan.wt_threads;
+		// (2+3+4) construct BWT and samples in one pass, if the CSA supports it
+		if (_construct_csa_bwt_is(idx, config, _bwt_is_support<t_index>(0))) {
+			if (config.delete_files) {
+				auto event = memory_monitor::event("delete temporary files");
+				util::delete_all_files(config.file_map);
+			}
+			return;
+		}
+	}
 	{
 		// (2) check, if the suffix array is cached
 		auto event = memory_monitor::event("SA");
 		if (!cache_file_exists(conf::KEY_SA, config)) {
-			construct_sa<t_index::alphabet_category::WIDTH>(config);
+			_construct_sa<width>(config, plan);
 		}
 		register_cache_file(conf::KEY_SA, config);
 	}
@@ -156,8 +231,9 @@ t_index& idx, const std::string& file, cache_config& config, uint8_t num_bytes,
 	}
 	{
 		//  (4) use BWT to construct the CSA
-		auto event = memory_monitor::event("construct CSA");
-		idx		   = t_index(config);
+		auto event					   = memory_monitor::event("construct CSA");
+		construct_config().num_threads = plan.wt_threads;
+		idx							   = t_index(config);
 	}
 	if (config.delete_files) {
 		auto event = memory_monitor::event("delete temporary files");
@@ -171,6 +247,7 @@ void construct(
 t_index& idx, const std::string& file, cache_config& config, uint8_t num_bytes, lcp_tag)
 {
 	auto						event	= memory_monitor::event("construct compressed LCP");
+	construct_config_scope		config_scope;
 	const char*					KEY_TEXT = key_text_trait<t_width>::KEY_TEXT;
 	typedef int_vector<t_width> text_type;
 	{
@@ -190,19 +267,17 @@ t_index& idx, const std::string& file, cache_config& config, uint8_t num_bytes,
 				}
 				register_cache_file(KEY_TEXT, config);
 			}
+			construct_plan plan = plan_construction<t_width>(config, false, true);
+			_use_plan(plan);
 			{
 				// (2) check, if the suffix array is cached
 				auto event = memory_monitor::event("SA");
 				if (!cache_file_exists(conf::KEY_SA, config)) {
-					construct_sa<t_width>(config);
+					_construct_sa<t_width>(config, plan);
 				}
 				register_cache_file(conf::KEY_SA, config);
 			}
-			if (t_width == 8) {
-				construct_lcp_semi_extern_PHI(config);
-			} else {
-				construct_lcp_PHI<t_width>(config);
-			}
+			_construct_lcp<t_width>(config, plan);
 		}
 		register_cache_file(conf::KEY_LCP, config);
 	}
@@ -235,6 +310,7 @@ void construct(
 t_index& idx, const std::string& file, cache_config& config, uint8_t num_bytes, cst_tag)
 {
 	auto		event	= memory_monitor::event("construct CST");
+	construct_config_scope config_scope;
 	const char* KEY_TEXT = key_text_trait<t_index::alphabet_category::WIDTH>::KEY_TEXT;
 	const char* KEY_BWT  = key_bwt_trait<t_index::alphabet_category::WIDTH>::KEY_BWT;
 	csa_tag		csa_t;
@@ -252,24 +328,29 @@ t_index& idx, const std::string& file, cache_config& config, uint8_t num_bytes,
 		}
 		register_cache_file(std::string(conf::KEY_CSA) + "_" + util::class_to_hash(csa), config);
 	}
+	constexpr uint8_t width = t_index::alphabet_category::WIDTH;
+	construct_plan	plan  = plan_construction<width>(config, false, true);
+	_use_plan(plan);
 	{
 		// (2) check, if the longest common prefix array is cached
 		auto event = memory_monitor::event("LCP");
 		register_cache_file(KEY_TEXT, config);
 		register_cache_file(KEY_BWT, config);
+		if (!cache_file_exists(conf::KEY_LCP, config) and
+			!cache_file_exists(conf::KEY_SA, config)) {
+			// the CSA was built by construct_bwt_is, which does not cache the SA
+			_construct_sa<width>(config, plan);
+		}
 		register_cache_file(conf::KEY_SA, config);
 		if (!cache_file_exists(conf::KEY_LCP, config)) {
-			if (t_index::alphabet_category::WIDTH == 8) {
-				construct_lcp_semi_extern_PHI(config);
-			} else {
-				construct_lcp_PHI<t_index::alphabet_category::WIDTH>(config);
-			}
+			_construct_lcp<width>(config, plan);
 		}
 		register_cache_file(conf::KEY_LCP, config);
 	}
 	{
-		auto event = memory_monitor::event("CST");
-		idx		   = t_index(config);
+		auto event					   = memory_monitor::event("CST");
+		construct_config().num_threads = plan.wt_threads;
+		idx							   = t_index(config);
 	}
 	if (config.delete_files) {
 		auto event = memory_monitor::event("delete temporary files");
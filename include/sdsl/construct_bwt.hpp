@@ -12,6 +12,7 @@
 #include "sfstream.hpp"
 #include "util.hpp"
 #include "config.hpp" // for cache_config
+#include "divsufsort.hpp"
 
 #include <iostream>
 #include <stdexcept>
@@ -70,6 +71,52 @@ void construct_bwt(cache_config& config)
 	register_cache_file(KEY_BWT, config);
 }
 
+//! Tag which selects the constructor of a CSA which calls construct_bwt_is.
+struct bwt_is_tag {
+};
+
+//! Constructs the BWT of a text over a byte-alphabet by induced sorting, without a cached SA.
+/*!	The suffixes are sorted with the two-stage induced sorting of divsufsort.
+ *  Its final left to right scan completes the SA in increasing order of the
+ *  SA positions, so BWT[i] is written and SA[i] is passed to sa_out as soon
+ *  as position i is reached. The SA is neither stored to disk nor read again;
+ *  samplings of the SA or ISA can be built on the fly (see csa_wt).
+ *  \param config Reference to cache configuration
+ *  \param sa_out Functor called as sa_out(i, SA[i]) for i=0,...,n-1 in increasing order.
+ *  \par Space complexity
+ *		$ n $ bytes for the text and $ 4n $ bytes ($ 8n $ bytes
+ *      for $ n \geq 2^{31} $) for the working array of the sorter.
+ *  \pre Text exist in the cache. Key
+ *         * conf::KEY_TEXT
+ *  \post BWT exist in the cache. Key
+ *         * conf::KEY_BWT
+ */
+template <class t_sa_out>
+void construct_bwt_is(cache_config& config, t_sa_out&& sa_out)
+{
+	typedef int_vector<>::size_type size_type;
+	read_only_mapper<8>				text(conf::KEY_TEXT, config);
+	size_type						n		 = text.size();
+	auto							bwt		 = write_out_mapper<8>::create(cache_file_name(conf::KEY_BWT, config), n, 8);
+	const uint8_t*					c		 = (const uint8_t*)text.data();
+	auto							emit	 = [&](size_type i, size_type sa) {
+		bwt[i] = c[sa ? sa - 1 : n - 1];
+		sa_out(i, sa);
+	};
+	if (n < 0x7FFFFFFFULL) {
+		int_vector<> sa(n, 0, 32);
+		divsufsort(c, (int32_t*)sa.data(), (int32_t)n, [&](int32_t i, int32_t v) {
+			emit(i, v);
+		});
+	} else {
+		int_vector<64> sa(n);
+		divsufsort(c, (int64_t*)sa.data(), (int64_t)n, [&](int64_t i, int64_t v) {
+			emit(i, v);
+		});
+	}
+	register_cache_file(conf::KEY_BWT, config);
+}
+
 } // end namespace
 
 #endif
@@ -10,6 +10,18 @@ namespace sdsl {
 
 struct construct_config_data {
 	byte_sa_algo_type byte_algo_sa = LIBDIVSUFSORT;
+	// Number of threads used by the parallel construction algorithms.
+	uint64_t num_threads = 1;
+	// Build BWT and SA samples of byte CSAs by induced sorting, without caching the SA
+	// (see construct_bwt_is).
+	bool byte_bwt_is = false;
+	// Number of blocks which semi-external algorithms read ahead and write behind in a
+	// background thread (see int_vector_buffer::async_io); 0 = synchronous I/O.
+	uint64_t async_io_depth = 0;
+	// Upper bound for the main memory of construct() in bytes; 0 = no limit. If set, the
+	// algorithms are chosen by plan_construction (see construct_plan.hpp) instead of
+	// byte_algo_sa and byte_bwt_is, and num_threads is the maximal number of threads.
+	uint64_t memory_budget = 0;
 };
 
 extern inline construct_config_data& construct_config() {
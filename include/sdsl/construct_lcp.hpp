@@ -19,6 +19,8 @@
 #include "wt_huff.hpp"
 #include "wt_algorithm.hpp"
 #include "construct_lcp_helper.hpp"
+#include "construct_config.hpp"
+#include "parallel_helper.hpp"
 
 #include <iostream>
 #include <stdexcept>
@@ -181,6 +183,94 @@ void construct_lcp_PHI(cache_config& config)
 }
 
 
+template <class t_idx, class t_text>
+void _construct_lcp_PHI_parallel(const t_text& text, int_vector<>& sa, uint64_t num_threads)
+{
+	typedef int_vector<>::size_type size_type;
+	const size_type					n		= sa.size();
+	const uint64_t					threads = parallel_threads(n, num_threads);
+
+	//	(1) Calculate PHI; every thread writes to distinct positions
+	std::vector<t_idx> plcp(n);
+	parallel_for_blocks(n, threads, [&](uint64_t, uint64_t b, uint64_t e) {
+		for (size_type i = b; i < e; ++i) {
+			plcp[sa[i]] = i ? sa[i - 1] : 0;
+		}
+	});
+
+	//  (2) Calculate PLCP in independent blocks of text positions. Each block
+	//      starts with l=0, which adds at most one LCP value of work per block.
+	parallel_for_blocks(n - 1, threads, [&](uint64_t, uint64_t b, uint64_t e) {
+		for (size_type i = b, l = 0; i < e; ++i) {
+			size_type phii = plcp[i];
+			while (text[i + l] == text[phii + l]) {
+				++l;
+			}
+			plcp[i] = l;
+			if (l) --l;
+		}
+	});
+	plcp[n - 1] = 0;
+
+	//	(3) Transform PLCP into LCP in-place in the SA. Blocks are aligned
+	//      to 64 entries, so no two threads share a word of sa.
+	parallel_for_blocks(n,
+						threads,
+						[&](uint64_t, uint64_t b, uint64_t e) {
+							for (size_type i = b; i < e; ++i) {
+								sa[i] = plcp[sa[i]];
+							}
+						},
+						64);
+	sa[0] = 0;
+}
+
+//! Construct the LCP array for text over byte- or integer-alphabet with several threads.
+/*!	The algorithm computes the lcp array and stores it to disk.
+ *  PHI, PLCP and the final permutation are computed block-wise in
+ *  parallel. The number of threads is taken from construct_config().num_threads.
+ *  \tparam t_width Width of the text. 0==integer alphabet, 8=byte alphabet.
+ *  \param config	Reference to cache configuration
+ *  \pre Text and Suffix array exist in the cache. Keys:
+ *         * conf::KEY_TEXT for t_width=8  or conf::KEY_TEXT_INT for t_width=0
+ *         * conf::KEY_SA
+ *  \post LCP array exist in the cache. Key
+ *         * conf::KEY_LCP
+ *  \par Time complexity
+ *         \f$ \Order{n/p + p \cdot \max lcp} \f$ for p threads
+ *  \par Space complexity
+ *         \f$ n \log \sigma + n \log n \f$ bits and 4n bytes (8n bytes for
+ *         inputs larger than 4GB)
+ *  \par Reference
+ *         Juha Kärkkäinen, Giovanni Manzini, Simon J. Puglisi:
+ *         Permuted Longest-Common-Prefix Array.
+ *         CPM 2009: 181-192
+ */
+template <uint8_t t_width>
+void construct_lcp_PHI_parallel(cache_config& config)
+{
+	static_assert(t_width == 0 or t_width == 8,
+				  "construct_lcp_PHI_parallel: width must be `0` for integer alphabet and `8` "
+				  "for byte alphabet");
+	const char*	KEY_TEXT = key_text_trait<t_width>::KEY_TEXT;
+	int_vector<> lcp;
+	load_from_cache(lcp, conf::KEY_SA, config);
+	if (lcp.size() <= 1) { // Handle special case: Input only the sentinel character.
+		lcp = int_vector<>(lcp.size(), 0);
+	} else {
+		int_vector<t_width> text;
+		load_from_cache(text, KEY_TEXT, config);
+		if (lcp.size() < 0xFFFFFFFFULL) {
+			_construct_lcp_PHI_parallel<uint32_t>(text, lcp, construct_config().num_threads);
+		} else {
+			_construct_lcp_PHI_parallel<uint64_t>(text, lcp, construct_config().num_threads);
+		}
+		util::bit_compress(lcp);
+	}
+	store_to_cache(lcp, conf::KEY_LCP, config);
+}
+
+
 //! Construct the LCP array (only for byte strings)
 /*!	The algorithm computes the lcp array and stores it to disk.
  *  \param config	Reference to cache configuration
@@ -250,6 +340,8 @@ inline void construct_lcp_semi_extern_PHI(cache_config& config)
 									std::ios::out,
 									buffer_size,
 									sa_buf.width()); // open buffer for plcp
+	sa_buf.async_io(construct_config().async_io_depth);
+	lcp_out_buf.async_io(construct_config().async_io_depth);
 
 	for (size_type i = 0, sai_1 = 0, l = 0, sai = 0, iq = 0; i < n; ++i) {
 		/*size_type*/ sai = sa_buf[i];
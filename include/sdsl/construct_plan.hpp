@@ -0,0 +1,227 @@
+// Copyright (c) 2016, the SDSL Project Authors.  All rights reserved.
+// Please see the AUTHORS file for details.  Use of this source code is governed
+// by a BSD license that can be found in the LICENSE file.
+/*! \file construct_plan.hpp
+    \brief construct_plan.hpp contains the planner which chooses the construction algorithms of
+           construct() for a memory budget.
+*/
+#ifndef INCLUDED_SDSL_CONSTRUCT_PLAN
+#define INCLUDED_SDSL_CONSTRUCT_PLAN
+
+#include "config.hpp"
+#include "construct_config.hpp"
+#include "int_vector_buffer.hpp"
+#include "io.hpp"
+#include "bits.hpp"
+#include <algorithm>
+#include <initializer_list>
+#include <limits>
+#include <sstream>
+#include <string>
+
+namespace sdsl {
+
+//! Algorithms and thread counts of the stages of construct().
+struct construct_plan {
+	byte_sa_algo_type sa_algo	= LIBDIVSUFSORT;
+	uint64_t		  sa_threads = 1;
+	// BWT and SA samples by induced sorting (construct_bwt_is), replaces the SA and BWT stage
+	bool		  bwt_is	  = false;
+	lcp_algo_type lcp_algo	= LCP_PHI;
+	uint64_t	  lcp_threads = 1;
+	// threads of the wavelet tree construction of the index
+	uint64_t wt_threads = 1;
+	// estimated main memory peak in bytes; 0 if no budget was given
+	uint64_t peak_bytes = 0;
+	// false, if even the leanest plan exceeds the budget
+	bool fits = true;
+
+	std::string to_string() const
+	{
+		static const char* sa_names[]  = {"divsufsort", "se_sais", "parallel_prefix_doubling"};
+		static const char* lcp_names[] = {"PHI", "semi_extern_PHI", "PHI_parallel"};
+		std::stringstream  ss;
+		if (bwt_is) {
+			ss << "SA+BWT=induced_sorting";
+		} else {
+			ss << "SA=" << sa_names[sa_algo] << "(" << sa_threads << " threads)";
+		}
+		ss << " LCP=" << lcp_names[lcp_algo] << "(" << lcp_threads << " threads)";
+		ss << " WT=" << wt_threads << " threads";
+		if (peak_bytes) {
+			ss << " peak=" << peak_bytes << " bytes";
+		}
+		if (!fits) {
+			ss << " (exceeds budget)";
+		}
+		return ss.str();
+	}
+};
+
+//! The plan of the last call of construct().
+inline construct_plan& last_construct_plan()
+{
+	static construct_plan plan;
+	return plan;
+}
+
+//! The plan which corresponds to the settings of construct_config(), used if no budget is given.
+inline construct_plan default_construct_plan(uint8_t width)
+{
+	construct_plan plan;
+	uint64_t	   threads = construct_config().num_threads;
+	plan.sa_algo		   = construct_config().byte_algo_sa;
+	plan.sa_threads		   = threads;
+	plan.bwt_is			   = construct_config().byte_bwt_is;
+	if (threads > 1) {
+		plan.lcp_algo = LCP_PHI_PARALLEL;
+	} else if (width == 8) {
+		plan.lcp_algo = LCP_SEMI_EXTERN_PHI;
+	} else {
+		plan.lcp_algo = LCP_PHI;
+	}
+	plan.lcp_threads = threads;
+	plan.wt_threads  = threads;
+	return plan;
+}
+
+//! Chooses the fastest construction algorithms whose memory peak fits into budget.
+/*! The stages SA, BWT, LCP and index (wavelet tree) run one after another,
+ *  so each stage takes its fastest algorithm that fits into the budget.
+ *  If no algorithm of a stage fits, the one with the smallest estimate is
+ *  taken and fits is set to false.
+ *  \param n              Length of the text including the sentinel.
+ *  \param width          8 for byte alphabets, 0 for integer alphabets.
+ *  \param text_width     Bits per symbol of the text.
+ *  \param bwt_is_support The index can be built by construct_bwt_is.
+ *  \param need_lcp       The LCP array has to be built.
+ *  \param budget         Memory budget in bytes.
+ *  \param max_threads    Maximal number of threads.
+ *
+ *  The estimates are worst cases of the heap usage measured with
+ *  SDSL_TRACK_ALL_ALLOCATIONS (including the fixed-size buffers of the
+ *  semi-external algorithms); they exceed some of the space complexities
+ *  documented at the algorithms, which do not count all temporary arrays.
+ *  The memory of the resulting index is not included.
+ */
+inline construct_plan plan_construction(uint64_t n,
+										uint8_t  width,
+										uint8_t  text_width,
+										bool	 bwt_is_support,
+										bool	 need_lcp,
+										uint64_t budget,
+										uint64_t max_threads)
+{
+	const uint64_t MB = 1ULL << 20;
+	construct_plan plan;
+	max_threads			= std::max(max_threads, (uint64_t)1);
+	bool	 parallel   = max_threads > 1;
+	uint64_t text_bytes = (n * text_width + 7) / 8;
+	uint64_t sa_bytes   = (n * (bits::hi(n) + 1) + 7) / 8;
+	// divsufsort and construct_bwt_is use 32-bit integers for inputs smaller than 2GB,
+	// the parallel algorithms for inputs smaller than 4GB
+	uint64_t ds_bytes  = n < (1ULL << 31) ? 4 * n : 8 * n;
+	uint64_t par_bytes = n < 0xFFFFFFFFULL ? 4 * n : 8 * n;
+	auto	 add_stage = [&](uint64_t bytes) { plan.peak_bytes = std::max(plan.peak_bytes, bytes); };
+	// index of the first estimate which fits, otherwise of the smallest one
+	auto choose = [&](std::initializer_list<uint64_t> estimates) {
+		size_t i = 0, smallest = 0;
+		for (auto bytes : estimates) {
+			if (bytes <= budget) {
+				add_stage(bytes);
+				return i;
+			}
+			if (bytes < *(estimates.begin() + smallest)) {
+				smallest = i;
+			}
+			++i;
+		}
+		add_stage(*(estimates.begin() + smallest));
+		return smallest;
+	};
+	const uint64_t none = std::numeric_limits<uint64_t>::max();
+
+	// parse the text
+	add_stage(text_bytes);
+
+	// SA and BWT
+	if (width == 8) {
+		uint64_t is_bytes = 2 * n + ds_bytes + n / 4 + MB;
+		if (bwt_is_support and !need_lcp and is_bytes <= budget) {
+			plan.bwt_is = true;
+			add_stage(is_bytes);
+		} else {
+			switch (choose({parallel ? 4 * par_bytes + 3 * n : none,
+							n + ds_bytes + MB,
+							n + 3 * sa_bytes / 2 + 10 * MB})) {
+				case 0:
+					plan.sa_algo	= PARALLEL_PREFIX_DOUBLING;
+					plan.sa_threads = max_threads;
+					break;
+				case 1: plan.sa_algo = LIBDIVSUFSORT; break;
+				default: plan.sa_algo = SE_SAIS;
+			}
+			add_stage(2 * n + MB); // construct_bwt
+		}
+	} else {
+		// qsufsort keeps the SA and the inverse SA in memory
+		add_stage(2 * sa_bytes);
+	}
+
+	// LCP
+	if (need_lcp) {
+		switch (choose({parallel ? text_bytes + sa_bytes + par_bytes : none,
+						text_bytes + sa_bytes + 4 * MB,
+						width == 8 ? n + n / 8 + 10 * MB : none})) {
+			case 0:
+				plan.lcp_algo	= LCP_PHI_PARALLEL;
+				plan.lcp_threads = max_threads;
+				break;
+			case 1: plan.lcp_algo = LCP_PHI; break;
+			default: plan.lcp_algo = LCP_SEMI_EXTERN_PHI;
+		}
+	}
+
+	// wavelet tree of the index; the parallel construction of integer
+	// wavelet trees keeps the input and the next level in memory
+	uint64_t wt_bytes = width == 8 ? n + 4 * MB : text_bytes + 4 * MB;
+	if (choose({parallel ? (width == 8 ? wt_bytes : wt_bytes + 2 * text_bytes) : none, wt_bytes}) == 0) {
+		plan.wt_threads = max_threads;
+	}
+	plan.fits = plan.peak_bytes <= budget;
+	return plan;
+}
+
+//! Plans the construction for the text in the cache (see plan_construction).
+/*! Returns default_construct_plan if construct_config().memory_budget is 0
+ *  or the text is not cached.
+ */
+template <uint8_t t_width>
+construct_plan plan_construction(cache_config& config, bool bwt_is_support, bool need_lcp)
+{
+	const char* KEY_TEXT = key_text_trait<t_width>::KEY_TEXT;
+	if (construct_config().memory_budget == 0 or !cache_file_exists(KEY_TEXT, config)) {
+		return default_construct_plan(t_width);
+	}
+	int_vector_buffer<t_width> text(cache_file_name(KEY_TEXT, config));
+	return plan_construction(text.size(),
+							 t_width,
+							 text.width(),
+							 bwt_is_support,
+							 need_lcp,
+							 construct_config().memory_budget,
+							 construct_config().num_threads);
+}
+
+//! Restores construct_config() at the end of the scope.
+class construct_config_scope {
+	construct_config_data m_saved;
+
+public:
+	construct_config_scope() : m_saved(construct_config()) {}
+	~construct_config_scope() { construct_config() = m_saved; }
+};
+
+} // end namespace sdsl
+
+#endif
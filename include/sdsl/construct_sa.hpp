@@ -17,6 +17,7 @@
 #include "qsufsort.hpp"
 
 #include "construct_sa_se.hpp"
+#include "construct_sa_parallel.hpp"
 #include "construct_config.hpp"
 
 namespace sdsl {
@@ -61,6 +62,34 @@ inline void construct_sa_se(cache_config& config)
 	register_cache_file(conf::KEY_SA, config);
 }
 
+//! Constructs the Suffix Array (SA) from text over byte-alphabet with several threads.
+/*! The algorithm constructs the SA and stores it to disk.
+ *  \param config Reference to cache configuration
+ *  \par Space complexity
+ *       \f$ 12n \f$ bytes of main memory for inputs smaller than 4GB and
+ *       \f$ 24n \f$ bytes otherwise.
+ *  \pre Text exist in the cache. Keys:
+ *         * conf::KEY_TEXT
+ *  \post SA exist in the cache. Key
+ *         * conf::KEY_SA
+ *
+ *  The number of threads is taken from construct_config().num_threads.
+ *  The resulting SA is identical to the one produced by divsufsort.
+ */
+inline void construct_sa_parallel(cache_config& config)
+{
+	read_only_mapper<8> text(conf::KEY_TEXT, config);
+	auto				sa = write_out_mapper<0>::create(
+	cache_file_name(conf::KEY_SA, config), text.size(), bits::hi(text.size()) + 1);
+	const uint8_t* c		   = (const uint8_t*)text.data();
+	uint64_t	   num_threads = construct_config().num_threads;
+	if (text.size() < 0xFFFFFFFFULL) {
+		_construct_sa_parallel<uint32_t>(c, text.size(), sa, num_threads);
+	} else {
+		_construct_sa_parallel<uint64_t>(c, text.size(), sa, num_threads);
+	}
+	register_cache_file(conf::KEY_SA, config);
+}
 
 namespace algorithm {
 
@@ -163,6 +192,8 @@ void construct_sa(cache_config& config)
 			algorithm::calculate_sa((const unsigned char*)text.data(), text.size(), sa);
 		} else if (construct_config().byte_algo_sa == SE_SAIS) {
 			construct_sa_se(config);
+		} else if (construct_config().byte_algo_sa == PARALLEL_PREFIX_DOUBLING) {
+			construct_sa_parallel(config);
 		}
 	} else if (t_width == 0) {
 		// call qsufsort
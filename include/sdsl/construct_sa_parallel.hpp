@@ -0,0 +1,182 @@
+// Copyright (c) 2016, the SDSL Project Authors.  All rights reserved.
+// Please see the AUTHORS file for details.  Use of this source code is governed
+// by a BSD license that can be found in the LICENSE file.
+/*! \file construct_sa_parallel.hpp
+    \brief construct_sa_parallel.hpp contains a multi-threaded suffix array
+           construction algorithm for byte alphabets.
+*/
+#ifndef INCLUDED_SDSL_CONSTRUCT_SA_PARALLEL
+#define INCLUDED_SDSL_CONSTRUCT_SA_PARALLEL
+
+#include "parallel_helper.hpp"
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+namespace sdsl {
+
+//! Calculates the suffix array of a byte text with several threads.
+/*! The algorithm is a parallel prefix doubling algorithm in the style of
+ *  Larsson and Sadakane. Suffixes are first bucketed by their first two
+ *  characters. In round \f$k\f$ all groups of suffixes which share a common
+ *  prefix of length \f$h=2^k\f$ are refined by sorting them according to the
+ *  rank of the suffix \f$h\f$ positions to the right. Groups are independent
+ *  of each other and are distributed over the threads; large groups are
+ *  sorted with a parallel merge sort.
+ *
+ * \tparam t_idx  Integer type used for ranks and suffix numbers. Has to be
+ *                able to represent n.
+ * \param text    Pointer to the text.
+ * \param n       Length of the text.
+ * \param sa      Random access container of size n which will contain the SA.
+ * \param num_threads Number of threads.
+ *
+ * \par Space complexity
+ *      \f$ 3n \cdot sizeof(t\_idx) \f$ bytes in addition to text and SA.
+ * \par Time complexity
+ *      \f$ \Order{n\log^2 n / p} \f$ in the worst case for p threads.
+ *
+ * \par Reference
+ *     N. Jesper Larsson, Kunihiko Sadakane:
+ *     ,,Faster suffix sorting'',
+ *     Theoretical Computer Science 387(3), 2007.
+ */
+template <class t_idx, class t_sa>
+void _construct_sa_parallel(const uint8_t* text, uint64_t n, t_sa& sa, uint64_t num_threads)
+{
+	typedef std::pair<t_idx, t_idx> entry_type; // (sort key, suffix)
+	struct task_type {
+		uint64_t beg, end;	 // elements [beg,end) of the SA
+		uint64_t g_beg, g_end; // group [g_beg,g_end) which contains the task
+	};
+	if (n == 0) return;
+	const uint64_t			threads = parallel_threads(n, num_threads);
+	std::vector<entry_type> w(n);
+	std::vector<t_idx>		rank(n);
+
+	// (1) bucket sort by the first two characters; ranks are always one
+	//     plus the first position of the group of the suffix. Rank 0 is
+	//     reserved for positions behind the end of the text.
+	const uint64_t sigma2 = 256 * 257;
+	auto		   key2   = [&](uint64_t i) -> uint64_t {
+		return (uint64_t)text[i] * 257 + (i + 1 < n ? (uint64_t)text[i + 1] + 1 : 0);
+	};
+	std::vector<std::vector<uint64_t>> cnt(threads, std::vector<uint64_t>(sigma2, 0));
+	parallel_for_blocks(n, threads, [&](uint64_t t, uint64_t b, uint64_t e) {
+		for (uint64_t i = b; i < e; ++i)
+			++cnt[t][key2(i)];
+	});
+	std::vector<uint64_t>				  bucket_start(sigma2 + 1, 0);
+	std::vector<std::pair<t_idx, t_idx>> groups;
+	for (uint64_t c = 0, sum = 0; c < sigma2; ++c) {
+		bucket_start[c] = sum;
+		for (uint64_t t = 0; t < threads; ++t) {
+			uint64_t x = cnt[t][c];
+			cnt[t][c]  = sum;
+			sum += x;
+		}
+		if (sum - bucket_start[c] > 1) {
+			groups.emplace_back(bucket_start[c], sum);
+		}
+	}
+	parallel_for_blocks(n, threads, [&](uint64_t t, uint64_t b, uint64_t e) {
+		for (uint64_t i = b; i < e; ++i) {
+			uint64_t c				= key2(i);
+			w[cnt[t][c]++].second = i;
+			rank[i]				= bucket_start[c] + 1;
+		}
+	});
+	std::vector<std::vector<uint64_t>>().swap(cnt);
+
+	// (2) prefix doubling on the unsorted groups
+	std::vector<std::vector<std::pair<t_idx, t_idx>>> new_groups(threads);
+	std::vector<task_type>							  tasks;
+	std::vector<uint64_t>							  small_groups, large_groups;
+	const uint64_t no_head = (uint64_t)-1;
+	std::vector<uint64_t> last_head;
+	for (uint64_t h = 2; !groups.empty(); h *= 2) {
+		uint64_t total = 0;
+		for (auto& g : groups)
+			total += g.second - g.first;
+		const uint64_t chunk = std::max((uint64_t)1 << 12, total / (4 * threads));
+		tasks.clear();
+		small_groups.clear();
+		large_groups.clear();
+		for (uint64_t j = 0; j < groups.size(); ++j) {
+			uint64_t gb = groups[j].first, ge = groups[j].second;
+			for (uint64_t b = gb; b < ge; b += chunk) {
+				tasks.push_back({b, std::min(ge, b + chunk), gb, ge});
+			}
+			if (ge - gb > chunk) {
+				large_groups.push_back(j);
+			} else {
+				small_groups.push_back(j);
+			}
+		}
+		// (a) the sort key of suffix s is the rank of suffix s+h
+		parallel_for_each(tasks.size(), threads, [&](uint64_t, uint64_t k) {
+			for (uint64_t i = tasks[k].beg; i < tasks[k].end; ++i) {
+				uint64_t s  = w[i].second;
+				w[i].first = s + h < n ? rank[s + h] : 0;
+			}
+		});
+		// (b) sort each group by the keys
+		auto key_cmp = [](const entry_type& a, const entry_type& b) { return a.first < b.first; };
+		parallel_for_each(small_groups.size(), threads, [&](uint64_t, uint64_t j) {
+			auto& g = groups[small_groups[j]];
+			std::sort(w.begin() + g.first, w.begin() + g.second, key_cmp);
+		});
+		for (uint64_t j : large_groups) {
+			auto& g = groups[j];
+			parallel_sort(w.begin() + g.first, w.begin() + g.second, key_cmp, threads);
+		}
+		// (c) determine the last head of a new group in each task
+		auto is_head = [&](uint64_t i, const task_type& tk) {
+			return i == tk.g_beg or w[i].first != w[i - 1].first;
+		};
+		last_head.assign(tasks.size(), no_head);
+		parallel_for_each(tasks.size(), threads, [&](uint64_t, uint64_t k) {
+			for (uint64_t i = tasks[k].end; i > tasks[k].beg; --i) {
+				if (is_head(i - 1, tasks[k])) {
+					last_head[k] = i - 1;
+					break;
+				}
+			}
+		});
+		for (uint64_t k = 1; k < tasks.size(); ++k) {
+			if (last_head[k] == no_head) last_head[k] = last_head[k - 1];
+		}
+		// (d) assign new ranks and collect the groups which are still unsorted
+		parallel_for_each(tasks.size(), threads, [&](uint64_t t, uint64_t k) {
+			const task_type& tk   = tasks[k];
+			uint64_t		 head = tk.beg == tk.g_beg ? tk.beg : last_head[k - 1];
+			for (uint64_t i = tk.beg; i < tk.end; ++i) {
+				if (is_head(i, tk)) head = i;
+				rank[w[i].second] = head + 1;
+				if ((i + 1 == tk.g_end or w[i + 1].first != w[i].first) and i > head) {
+					new_groups[t].emplace_back(head, i + 1);
+				}
+			}
+		});
+		groups.clear();
+		for (auto& ng : new_groups) {
+			groups.insert(groups.end(), ng.begin(), ng.end());
+			ng.clear();
+		}
+	}
+	std::vector<t_idx>().swap(rank);
+
+	// (3) write the result; borders are aligned to 64 elements, so that no
+	//     two threads write to the same word of a bit-compressed vector
+	parallel_for_blocks(n,
+						threads,
+						[&](uint64_t, uint64_t b, uint64_t e) {
+							for (uint64_t i = b; i < e; ++i)
+								sa[i] = w[i].second;
+						},
+						64);
+}
+
+} // end namespace sdsl
+
+#endif
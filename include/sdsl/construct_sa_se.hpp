@@ -6,6 +6,7 @@
 
 #include "io.hpp"
 #include "int_vector.hpp"
+#include "construct_config.hpp"
 #include "rank_support.hpp"
 #include "select_support.hpp"
 #include <cmath>
@@ -754,8 +755,10 @@ void _construct_sa_se(int_vector_type& text,
 
 	// Step 12 - Scan virtual array from left to right second time
 	right.buffersize(buffersize);
+	right.async_io(construct_config().async_io_depth); // written sequentially
 	right_pointer = 0;
 	int_vector_buffer<> cached_sa(filename_sa, std::ios::out, buffersize, nsize);
+	cached_sa.async_io(construct_config().async_io_depth);
 	size_t				sa_pointer = 0;
 	{
 		size_t							 partsize = bkt_l_sum / parts + 1;
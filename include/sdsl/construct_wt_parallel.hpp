@@ -0,0 +1,300 @@
+// Copyright (c) 2016, the SDSL Project Authors.  All rights reserved.
+// Please see the AUTHORS file for details.  Use of this source code is governed
+// by a BSD license that can be found in the LICENSE file.
+/*! \file construct_wt_parallel.hpp
+    \brief construct_wt_parallel.hpp contains multi-threaded algorithms which
+           fill the bit vectors of wavelet trees and wavelet matrices.
+*/
+#ifndef INCLUDED_SDSL_CONSTRUCT_WT_PARALLEL
+#define INCLUDED_SDSL_CONSTRUCT_WT_PARALLEL
+
+#include "int_vector.hpp"
+#include "parallel_helper.hpp"
+#include "simd_popcount.hpp"
+#include <algorithm>
+#include <iterator>
+#include <vector>
+
+namespace sdsl {
+
+//! Counts the 1-bits of bv in [beg,end).
+inline uint64_t _wt_bit_count(const bit_vector& bv, uint64_t beg, uint64_t end)
+{
+	if (beg >= end) return 0;
+	const uint64_t* data = bv.data();
+	uint64_t		bw = beg >> 6, ew = end >> 6;
+	if (bw == ew) {
+		return bits::cnt((data[bw] >> (beg & 0x3F)) & bits::lo_set[end - beg]);
+	}
+	uint64_t res = bits::cnt(data[bw] >> (beg & 0x3F));
+	res += simd_popcount::words(data + bw + 1, ew - bw - 1);
+	if (end & 0x3F) {
+		res += bits::cnt(data[ew] & bits::lo_set[end & 0x3F]);
+	}
+	return res;
+}
+
+//! Fills the bit vector of a pointer-based wavelet tree (wt_pc) with several threads.
+/*! The input is read sequentially in rounds of up to num_threads blocks.
+ *  In each round
+ *    (1) every thread counts the symbols of its block,
+ *    (2) the symbol counts are turned into per-block node counts, which
+ *        determine where the bits of each block start in each node, and
+ *    (3) every thread writes the bits of its block to these offsets.
+ *  As the bits of a block are placed behind the bits of all previous blocks
+ *  in each node, the result is identical to the sequential construction.
+ *
+ * \param begin       Iterator to the first symbol.
+ * \param end         Iterator past the last symbol.
+ * \param tree        The tree shape; provides bv_pos, bit_path and child.
+ * \param sigma_size  Largest symbol plus one.
+ * \param bv          Zero-initialized bit vector of the size of all nodes.
+ * \param num_threads Number of threads.
+ */
+template <class t_it, class t_tree>
+void _construct_wt_pc_parallel(t_it			  begin,
+							   t_it			  end,
+							   const t_tree&  tree,
+							   uint64_t		  sigma_size,
+							   bit_vector&	bv,
+							   uint64_t		  num_threads)
+{
+	typedef typename t_tree::value_type value_type;
+	const uint64_t						n		= std::distance(begin, end);
+	const uint64_t						threads = parallel_threads(n, num_threads);
+	const uint64_t						nodes   = tree.size();
+	// a block should be large compared to the work for its node counts
+	const uint64_t block = std::max((uint64_t)1 << 20, 4 * sigma_size);
+
+	std::vector<uint64_t> node_pos(nodes);
+	for (uint64_t v = 0; v < nodes; ++v) {
+		node_pos[v] = tree.bv_pos(v);
+	}
+	std::vector<std::vector<uint64_t>> sym_cnt(threads, std::vector<uint64_t>(sigma_size));
+	std::vector<std::vector<uint64_t>> pos(threads, std::vector<uint64_t>(nodes));
+	std::vector<std::vector<uint64_t>> shared_lo(threads, std::vector<uint64_t>(nodes));
+	std::vector<std::vector<uint64_t>> shared_hi(threads, std::vector<uint64_t>(nodes));
+	std::vector<value_type>			   buf;
+	buf.reserve(std::min(n, threads * block));
+	uint64_t* data = bv.data();
+
+	auto it = begin;
+	for (uint64_t done = 0; done < n;) {
+		uint64_t len = std::min(n - done, threads * block);
+		buf.clear();
+		for (uint64_t i = 0; i < len; ++i, ++it) {
+			buf.push_back(*it);
+		}
+		done += len;
+		auto border = [&](uint64_t t) { return (len * t) / threads; };
+
+		// (1) count the symbols of each block
+		parallel_for_each(threads, threads, [&](uint64_t, uint64_t t) {
+			std::fill(sym_cnt[t].begin(), sym_cnt[t].end(), 0);
+			for (uint64_t i = border(t); i < border(t + 1); ++i) {
+				++sym_cnt[t][buf[i]];
+			}
+		});
+		// (2) offsets of the blocks in the nodes
+		for (uint64_t t = 0; t < threads; ++t) {
+			std::fill(pos[t].begin(), pos[t].end(), 0);
+			for (uint64_t c = 0; c < sigma_size; ++c) {
+				if (sym_cnt[t][c] == 0) continue;
+				uint64_t p		  = tree.bit_path(c);
+				uint32_t path_len = p >> 56;
+				auto	 v		  = tree.root();
+				for (uint32_t l = 0; l < path_len; ++l, p >>= 1) {
+					pos[t][v] += sym_cnt[t][c];
+					v = tree.child(v, p & 1);
+				}
+			}
+		}
+		for (uint64_t v = 0; v < nodes; ++v) {
+			for (uint64_t t = 0; t < threads; ++t) {
+				uint64_t cnt	= pos[t][v];
+				pos[t][v]		= node_pos[v];
+				shared_lo[t][v] = node_pos[v] >> 6;
+				shared_hi[t][v] = (node_pos[v] + cnt - 1) >> 6;
+				node_pos[v] += cnt;
+			}
+		}
+		// (3) write the bits; equal symbols are inserted in runs of up to 64
+		parallel_for_each(threads, threads, [&](uint64_t, uint64_t t) {
+			auto insert = [&](value_type c, uint8_t times) {
+				uint64_t p		  = tree.bit_path(c);
+				uint32_t path_len = p >> 56;
+				auto	 v		  = tree.root();
+				for (uint32_t l = 0; l < path_len; ++l, p >>= 1) {
+					if (p & 1) {
+						parallel_or_bits(
+						data, pos[t][v], bits::lo_set[times], times, shared_lo[t][v], shared_hi[t][v]);
+					}
+					pos[t][v] += times;
+					v = tree.child(v, p & 1);
+				}
+			};
+			uint64_t i = border(t), e = border(t + 1);
+			while (i < e) {
+				value_type c	 = buf[i];
+				uint8_t	times = 1;
+				while (++i < e and buf[i] == c and times < 64) {
+					++times;
+				}
+				insert(c, times);
+			}
+		});
+	}
+}
+
+//! Fills the levels of a wavelet tree (wt_int) or a wavelet matrix (wm_int) with several threads.
+/*! Level \f$k\f$ contains bit \f$L-k-1\f$ of each element, where \f$L\f$ is
+ *  the width of rac, in the order of the elements on level \f$k\f$. The
+ *  algorithm processes the levels one after another:
+ *    (1) the bits of the level are written in blocks of 64-bit words and
+ *    (2) the order of the next level is calculated by a stable partition
+ *        of the current order into a second array. For the wavelet matrix
+ *        the whole level is partitioned; for the wavelet tree each node,
+ *        i.e. each run of elements which share the first \f$k\f$ bits, is
+ *        partitioned. Each thread handles a block of the level and derives
+ *        the target positions of its elements from the number of 1-bits in
+ *        its node (or level) before the block, which are counted in the
+ *        already written bits of the level.
+ *
+ * \param rac         The elements; overwritten with their order on level L.
+ * \param tree        Will contain the rac.size() times L bits of the levels.
+ * \param matrix      True for the wavelet matrix, false for the wavelet tree.
+ * \param num_threads Number of threads.
+ * \param zero_cnt    If not null, receives the number of 0-bits of each level.
+ * \return The number of distinct elements.
+ *
+ * \par Space complexity
+ *      \f$ 2n L \f$ bits in addition to the tree.
+ */
+inline uint64_t _construct_wt_levels_parallel(int_vector<>&   rac,
+											  bit_vector&	 tree,
+											  bool			  matrix,
+											  uint64_t		  num_threads,
+											  int_vector<64>* zero_cnt = nullptr)
+{
+	const uint64_t n	   = rac.size();
+	const uint8_t  L	   = rac.width();
+	const uint64_t threads = parallel_threads(n, num_threads);
+	tree				   = bit_vector(n * L, 0);
+	if (zero_cnt != nullptr) {
+		*zero_cnt = int_vector<64>(L, 0);
+	}
+	if (n == 0) return 0;
+	int_vector<> next(n, 0, L);
+	auto		 border = [&](uint64_t t) { return (n * t) / threads; };
+
+	for (uint8_t k = 0; k < L; ++k) {
+		const uint8_t  shift = L - k - 1;
+		const uint64_t level = k * n;
+		// (1) write the bits of the level; blocks start at word borders of tree
+		uint64_t  head = std::min(n, (64 - (level & 0x3F)) & 0x3F);
+		auto	  fill = [&](uint64_t b, uint64_t e) {
+			 for (uint64_t i = b; i < e; i += 64) {
+				 uint64_t word = 0, len = std::min((uint64_t)64, e - i);
+				 for (uint64_t j = 0; j < len; ++j) {
+					 word |= ((rac[i + j] >> shift) & 1ULL) << j;
+				 }
+				 tree.set_int(level + i, word, len);
+			 }
+		};
+		fill(0, head);
+		parallel_for_blocks(
+		n - head, threads, [&](uint64_t, uint64_t b, uint64_t e) { fill(head + b, head + e); }, 64);
+
+		// (2) stable partition into next
+		uint64_t* next_data = next.data();
+		auto	  write		= [&](uint64_t d, uint64_t x, uint64_t r_beg, uint64_t r_end) {
+			 parallel_or_bits(next_data, d * L, x, L, (r_beg * L) >> 6, (r_end * L - 1) >> 6);
+		};
+		// moves the elements [b,e) of a node or level [beg,end) to their target positions
+		auto move = [&](uint64_t beg, uint64_t end, uint64_t b, uint64_t e) {
+			uint64_t ones_node   = _wt_bit_count(tree, level + beg, level + end);
+			uint64_t ones_before = _wt_bit_count(tree, level + beg, level + b);
+			uint64_t ones_here   = (b == beg and e == end) ? ones_node
+														   : _wt_bit_count(tree, level + b, level + e);
+			uint64_t zero_pos	= beg + (b - beg) - ones_before;
+			uint64_t zero_end	= zero_pos + (e - b) - ones_here;
+			uint64_t one_pos	 = end - ones_node + ones_before;
+			uint64_t one_end	 = one_pos + ones_here;
+			uint64_t zero_beg = zero_pos, one_beg = one_pos;
+			for (uint64_t i = b; i < e; ++i) {
+				uint64_t x = rac[i];
+				if ((x >> shift) & 1) {
+					write(one_pos++, x, one_beg, one_end);
+				} else {
+					write(zero_pos++, x, zero_beg, zero_end);
+				}
+			}
+		};
+		parallel_for_blocks(((n * L + 63) >> 6), threads, [&](uint64_t, uint64_t b, uint64_t e) {
+			std::fill(next_data + b, next_data + e, 0);
+		});
+		if (matrix) {
+			parallel_for_each(threads, threads, [&](uint64_t, uint64_t t) {
+				move(0, n, border(t), border(t + 1));
+			});
+			if (zero_cnt != nullptr) {
+				(*zero_cnt)[k] = n - _wt_bit_count(tree, level, level + n);
+			}
+		} else {
+			// the first k bits of x identify its node
+			auto prefix = [&](uint64_t x) { return shift + 1 < 64 ? x >> (shift + 1) : 0; };
+			parallel_for_each(threads, threads, [&](uint64_t, uint64_t t) {
+				uint64_t b = border(t), e = border(t + 1);
+				while (b < e) {
+					uint64_t p = prefix(rac[b]);
+					// nodes are sorted by prefix; only the first node of the block
+					// can start before b
+					uint64_t beg = b;
+					if (b == border(t)) {
+						for (uint64_t lo = 0, hi = b; lo < hi;) {
+							uint64_t mid = lo + (hi - lo) / 2;
+							if (prefix(rac[mid]) < p) {
+								lo = mid + 1;
+							} else {
+								hi = beg = mid;
+							}
+						}
+					}
+					// galloping search for the end of the node
+					uint64_t lo = b, hi = b + 1; // rac[lo] is in the node
+					for (uint64_t step = 2; hi < n and prefix(rac[hi]) == p; step *= 2) {
+						lo = hi;
+						hi = std::min(n, hi + step);
+					}
+					while (lo + 1 < hi) { // rac[hi] is not in the node or hi == n
+						uint64_t mid = lo + (hi - lo) / 2;
+						if (prefix(rac[mid]) == p) {
+							lo = mid;
+						} else {
+							hi = mid;
+						}
+					}
+					uint64_t end = hi;
+					move(beg, end, b, std::min(end, e));
+					b = std::min(end, e);
+				}
+			});
+		}
+		std::swap(rac, next);
+	}
+	// equal elements are adjacent in the order on level L
+	std::vector<uint64_t> distinct(threads, 0);
+	parallel_for_each(threads, threads, [&](uint64_t, uint64_t t) {
+		for (uint64_t i = std::max((uint64_t)1, border(t)); i < border(t + 1); ++i) {
+			distinct[t] += (rac[i] != rac[i - 1]);
+		}
+	});
+	uint64_t res = 1;
+	for (auto d : distinct)
+		res += d;
+	return res;
+}
+
+} // end namespace sdsl
+
+#endif
@@ -0,0 +1,81 @@
+// Copyright (c) 2016, the SDSL Project Authors.  All rights reserved.
+// Please see the AUTHORS file for details.  Use of this source code is governed
+// by a BSD license that can be found in the LICENSE file.
+/*! \file cpu_features.hpp
+    \brief cpu_features.hpp contains the runtime detection of the
+           instruction set extensions used by bits and simd_popcount.
+*/
+#ifndef INCLUDED_SDSL_CPU_FEATURES
+#define INCLUDED_SDSL_CPU_FEATURES
+
+#if (defined(__GNUC__) or defined(__clang__)) and defined(__x86_64__)
+//! Defined if the kernels of bits and simd_popcount are selected at runtime.
+#define SDSL_CPU_DISPATCH
+#endif
+
+//! Namespace for the succinct data structure library.
+namespace sdsl {
+
+//! Instruction set extensions of the CPU the program runs on.
+/*!
+ * The flags are detected once during static initialization. Functions
+ * like bits::cnt and bits::sel test the flag with a well predictable
+ * branch and then execute the instruction with inline assembly, so a
+ * binary compiled for baseline x86-64 gets the same kernels as a binary
+ * compiled with -msse4.2 -mbmi2. If a flag is read before it is
+ * initialized (e.g. from another static initializer), it is false and
+ * the portable fallback is used, which gives the same results.
+ *
+ * The flags are not const, so tests and benchmarks can switch off a
+ * kernel to compare it with the fallback. They must not be changed while
+ * other threads use the library.
+ */
+template <typename T = void>
+struct cpu_features_impl {
+	cpu_features_impl() = delete;
+	//! popcnt instruction (Nehalem, Barcelona and newer).
+	static bool popcnt;
+	//! BMI2 instructions with a fast pdep. Excludes AMD Zen 1 and 2, where pdep is microcoded.
+	static bool bmi2;
+	//! AVX2 instructions.
+	static bool avx2;
+	//! AVX-512F and AVX-512 VPOPCNTDQ instructions.
+	static bool avx512_vpopcntdq;
+
+private:
+#ifdef SDSL_CPU_DISPATCH
+	static bool init()
+	{
+		__builtin_cpu_init();
+		return true;
+	}
+#endif
+};
+
+#ifdef SDSL_CPU_DISPATCH
+template <typename T>
+bool cpu_features_impl<T>::popcnt = init() and __builtin_cpu_supports("popcnt");
+template <typename T>
+bool cpu_features_impl<T>::bmi2 = init() and __builtin_cpu_supports("bmi2") and
+								  !__builtin_cpu_is("znver1") and !__builtin_cpu_is("znver2");
+template <typename T>
+bool cpu_features_impl<T>::avx2 = init() and __builtin_cpu_supports("avx2");
+template <typename T>
+bool cpu_features_impl<T>::avx512_vpopcntdq = init() and __builtin_cpu_supports("avx512f") and
+											  __builtin_cpu_supports("avx512vpopcntdq");
+#else
+template <typename T>
+bool cpu_features_impl<T>::popcnt = false;
+template <typename T>
+bool cpu_features_impl<T>::bmi2 = false;
+template <typename T>
+bool cpu_features_impl<T>::avx2 = false;
+template <typename T>
+bool cpu_features_impl<T>::avx512_vpopcntdq = false;
+#endif
+
+using cpu_features = cpu_features_impl<>;
+
+} // end namespace sdsl
+
+#endif
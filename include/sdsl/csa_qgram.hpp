@@ -0,0 +1,224 @@
+// Copyright (c) 2016, the SDSL Project Authors.  All rights reserved.
+// Please see the AUTHORS file for details.  Use of this source code is governed
+// by a BSD license that can be found in the LICENSE file.
+/*! \file csa_qgram.hpp
+    \brief csa_qgram.hpp contains a CSA with a lookup table for the SA intervals of all q-grams.
+*/
+#ifndef INCLUDED_SDSL_CSA_QGRAM
+#define INCLUDED_SDSL_CSA_QGRAM
+
+#include "csa_sada.hpp"
+#include "csa_wt.hpp"
+#include "int_vector.hpp"
+#include "suffix_array_algorithm.hpp"
+#include "util.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+namespace sdsl {
+
+//! A CSA with a table which maps each q-gram to its SA interval.
+/*!
+ * backward_search() and lex_interval() on the full SA start with the interval
+ * of the last q characters of the pattern, which is one table lookup, instead
+ * of q rank steps. Shorter patterns, q-grams which do not occur and searches
+ * in a sub-interval are passed to t_csa.
+ *
+ * The q-grams over the \f$ b=\sigma-1 \f$ characters of the text (the
+ * sentinel excluded) are numbered in lexicographic order. For each number x
+ * the table stores the number of suffixes which are smaller than x or which
+ * are shorter than q and sort before x. The up to q suffixes which are shorter
+ * than q are stored separately, so the interval of x is found with two
+ * lookups in the table.
+ *
+ * \tparam t_csa CSA type, e.g. csa_wt or csa_sada.
+ * \tparam t_q   Length of the q-grams.
+ *
+ * \par Space complexity
+ *      \f$ (b^q+1)\log n \f$ bits in addition to t_csa.
+ */
+template <class t_csa, uint8_t t_q = 4>
+class csa_qgram : public t_csa {
+	static_assert(t_q > 0, "csa_qgram: q has to be positive");
+
+public:
+	typedef typename t_csa::size_type		size_type;
+	typedef typename t_csa::char_type		char_type;
+	typedef typename t_csa::comp_char_type comp_char_type;
+	enum { q = t_q };
+
+private:
+	size_type	m_base = 0; // number of characters in the q-grams
+	int_vector<> m_prefix;   // m_prefix[x]: number of suffixes before the short suffixes of x
+	int_vector<> m_short;	// q-gram numbers of the suffixes shorter than q, sorted
+
+	// Counts a suffix of length len (without the sentinel) for q-gram number code.
+	void add(size_type code, size_type len)
+	{
+		if (len < m_short.size()) m_short[len] = code;
+		++m_prefix[code];
+	}
+
+	// Walks the suffixes in reversed text order with the LF function.
+	void walk(size_type high, lf_tag)
+	{
+		size_type code = 0, i = 0; // i = ISA[n-1-len]; the sentinel suffix is first
+		for (size_type len = 0; len < this->size(); ++len) {
+			add(code, len);
+			if (len + 1 < this->size()) {
+				char_type c = this->bwt[i];
+				code		= (this->char2comp[c] - 1) * high + code / m_base;
+				i			= this->lf[i];
+			}
+		}
+	}
+
+	// Walks the suffixes in text order with the PSI function. The q-gram of
+	// suffix p is complete after T[p+q-1] is read; the last q suffixes are
+	// padded.
+	void walk(size_type high, psi_tag)
+	{
+		size_type n = this->size();
+		size_type code = 0, i = this->psi[0]; // i = ISA[t]
+		for (size_type t = 0; t + 1 < n + t_q; ++t) {
+			size_type digit = 0;
+			if (t + 1 < n) {
+				digit = this->char2comp[first_row_symbol(i, *this)] - 1;
+				i	 = this->psi[i];
+			}
+			code = (code % high) * m_base + digit;
+			if (t + 1 >= t_q) add(code, n + t_q - 2 - t);
+		}
+	}
+
+	// Counts the suffixes per q-gram number. A suffix shorter than q is
+	// counted for its q-gram padded with the smallest character.
+	void build()
+	{
+		size_type n		= this->size();
+		m_base			= this->sigma - 1;
+		size_type codes = 1, high = 1; // high = b^{q-1}
+		for (size_type j = 0; j < t_q; ++j) {
+			if (m_base > 0 and codes > (1ULL << 40) / m_base) {
+				throw std::logic_error("csa_qgram: the q-gram table has more than 2^40 entries");
+			}
+			high = codes;
+			codes *= m_base;
+		}
+		m_prefix = int_vector<>(codes + 1, 0, bits::hi(n) + 1);
+		m_short  = int_vector<>(std::min((size_type)t_q, n), 0,
+							   bits::hi(std::max(codes, (size_type)1)) + 1);
+		if (m_base > 0) {
+			walk(high, typename t_csa::extract_category());
+		} else {
+			add(0, 0); // only the sentinel
+		}
+		std::sort(m_short.begin(), m_short.end());
+		for (size_type x = 0, sum = 0; x <= codes; ++x) {
+			size_type cnt = m_prefix[x];
+			m_prefix[x]   = sum;
+			sum += cnt;
+		}
+	}
+
+	// Number of suffixes shorter than q which sort directly before q-gram x.
+	size_type short_count(size_type x) const
+	{
+		auto range = std::equal_range(m_short.begin(), m_short.end(), x);
+		return range.second - range.first;
+	}
+
+public:
+	//! Default constructor
+	csa_qgram() = default;
+
+	//! Constructor for the CSA taking a cache_config
+	csa_qgram(cache_config& config) : t_csa(config) { build(); }
+
+	//! Constructor for the CSA without a cached SA (see construct_bwt_is)
+	csa_qgram(cache_config& config, bwt_is_tag tag) : t_csa(config, tag) { build(); }
+
+	//! Returns the SA interval [l_res..r_res] of the last q characters of [begin..end).
+	/*!
+	 * \return False if end-begin < q or the pattern contains the sentinel.
+	 *         Then [l_res..r_res] is not changed.
+	 */
+	template <class t_pat_iter>
+	bool
+	qgram_interval(t_pat_iter begin, t_pat_iter end, size_type& l_res, size_type& r_res) const
+	{
+		if (end - begin < (typename std::iterator_traits<t_pat_iter>::difference_type)t_q)
+			return false;
+		size_type x = 0;
+		for (t_pat_iter it = end - t_q; it != end; ++it) {
+			char_type	  c  = *it;
+			comp_char_type cc = this->char2comp[c];
+			if (cc == 0) {
+				if (c == 0) return false;
+				l_res = 1; // character does not occur in the text
+				r_res = 0;
+				return true;
+			}
+			x = x * m_base + cc - 1;
+		}
+		l_res = m_prefix[x] + short_count(x);
+		r_res = m_prefix[x + 1] - 1;
+		return true;
+	}
+
+	//! Number of entries of the q-gram table.
+	size_type qgrams() const { return m_prefix.size() - 1; }
+
+	//! Serializes the data structure into the given ostream
+	size_type
+	serialize(std::ostream& out, structure_tree_node* v = nullptr, std::string name = "") const
+	{
+		structure_tree_node* child = structure_tree::add_child(v, name, util::class_name(*this));
+		size_type			 written_bytes = 0;
+		written_bytes += t_csa::serialize(out, child, "csa");
+		written_bytes += write_member(m_base, out, child, "base");
+		written_bytes += m_prefix.serialize(out, child, "prefix");
+		written_bytes += m_short.serialize(out, child, "short");
+		structure_tree::add_size(child, written_bytes);
+		return written_bytes;
+	}
+
+	//! Load from a stream.
+	void load(std::istream& in)
+	{
+		t_csa::load(in);
+		read_member(m_base, in);
+		m_prefix.load(in);
+		m_short.load(in);
+	}
+};
+
+//! Backward search for a pattern in an \f$\omega\f$-interval \f$[\ell..r]\f$ in a csa_qgram.
+/*!
+ * If \f$[\ell..r]\f$ is the whole SA, the last q characters of the pattern
+ * are looked up in the q-gram table, and only the remaining characters are
+ * searched by rank operations. If the q-gram does not occur, the search is
+ * done by t_csa, so that the borders of the empty result are the same.
+ * \sa backward_search
+ */
+template <class t_csa, uint8_t t_q, class t_pat_iter>
+typename t_csa::size_type backward_search(const csa_qgram<t_csa, t_q>& csa,
+										  typename t_csa::size_type	l,
+										  typename t_csa::size_type	r,
+										  t_pat_iter					 begin,
+										  t_pat_iter					 end,
+										  typename t_csa::size_type&   l_res,
+										  typename t_csa::size_type&   r_res)
+{
+	typename t_csa::size_type ql = 0, qr = 0;
+	if (l == 0 and r + 1 == csa.size() and csa.qgram_interval(begin, end, ql, qr) and
+		qr + 1 > ql) {
+		l = ql;
+		r = qr;
+		end -= t_q;
+	}
+	return backward_search((const t_csa&)csa, l, r, begin, end, l_res, r_res);
+}
+
+} // end namespace sdsl
+#endif
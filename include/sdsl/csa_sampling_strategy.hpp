@@ -47,6 +47,60 @@
 
 namespace sdsl {
 
+// has_sampling_builder<X>::value is true if the SA or ISA sampling X has a
+// nested class builder, i.e. it can be built from SA values which are passed
+// in SA order (see construct_bwt_is)
+template <typename X>
+struct has_sampling_builder {
+	template <typename T>
+	static constexpr auto check(T*) -> typename std::is_class<typename T::builder>::type
+	{
+		return std::true_type();
+	}
+	template <typename>
+	static constexpr std::false_type check(...)
+	{
+		return std::false_type();
+	}
+	typedef decltype(check<X>(nullptr)) type;
+	static constexpr bool				value = type::value;
+};
+
+// has_phi_support<X>::value is true if the SA sampling X provides phi(p)=SA[ISA[p]-1]
+// and samples the ends of the BWT runs (see backward_search_toehold)
+template <typename X>
+struct has_phi_support {
+	template <typename T>
+	static constexpr auto check(T*) -> decltype(std::declval<const T&>().phi(0), std::true_type())
+	{
+		return std::true_type();
+	}
+	template <typename>
+	static constexpr std::false_type check(...)
+	{
+		return std::false_type();
+	}
+	typedef decltype(check<X>(nullptr)) type;
+	static constexpr bool				value = type::value;
+};
+
+//! Builder which ignores all SA values; it stands in for samplings without a builder.
+struct no_sampling_builder {
+	explicit no_sampling_builder(uint64_t) {}
+	void operator()(uint64_t, uint64_t) {}
+};
+
+// sampling_builder_trait<X>::type is X::builder if it exists and no_sampling_builder otherwise
+template <class X, bool = has_sampling_builder<X>::value>
+struct sampling_builder_trait {
+	typedef typename X::builder type;
+};
+
+template <class X>
+struct sampling_builder_trait<X, false> {
+	typedef no_sampling_builder type;
+};
+
 template <class t_csa, uint8_t t_width = 0>
 class _sa_order_sampling : public int_vector<t_width> {
 public:
@@ -83,6 +137,26 @@ public:
 		}
 	}
 
+	//! Collects the samples from SA values which are passed in increasing order of SA positions.
+	class builder {
+		friend class _sa_order_sampling;
+		base_type m_samples;
+
+	public:
+		explicit builder(size_type n)
+			: m_samples((n + sample_dens - 1) / sample_dens, 0, bits::hi(n) + 1)
+		{
+		}
+
+		void operator()(size_type i, size_type sa)
+		{
+			if (0 == (i % sample_dens)) m_samples[i / sample_dens] = sa;
+		}
+	};
+
+	//! Constructor from a builder, which has seen all SA values (see construct_bwt_is).
+	explicit _sa_order_sampling(builder&& b) : base_type(std::move(b.m_samples)) {}
+
 	//! Determine if index i is sampled or not
 	inline bool is_sampled(size_type i) const { return 0 == (i % sample_dens); }
 
@@ -151,6 +225,36 @@ public:
 		util::init_support(m_rank_marked, &m_marked);
 	}
 
+	//! Collects the samples from SA values which are passed in increasing order of SA positions.
+	class builder {
+		friend class _text_order_sampling;
+		bit_vector m_marked;
+		base_type  m_samples;
+		size_type  m_cnt = 0;
+
+	public:
+		explicit builder(size_type n)
+			: m_marked(n, 0)
+			, m_samples((n + sample_dens - 1) / sample_dens, 0, bits::hi(n / sample_dens) + 1)
+		{
+		}
+
+		void operator()(size_type i, size_type sa)
+		{
+			if (0 == (sa % sample_dens)) {
+				m_marked[i]			 = 1;
+				m_samples[m_cnt++] = sa / sample_dens;
+			}
+		}
+	};
+
+	//! Constructor from a builder, which has seen all SA values (see construct_bwt_is).
+	explicit _text_order_sampling(builder&& b) : base_type(std::move(b.m_samples))
+	{
+		m_marked = t_bv(std::move(b.m_marked));
+		util::init_support(m_rank_marked, &m_marked);
+	}
+
 	//! Copy constructor
 	_text_order_sampling(const _text_order_sampling& st) : base_type(st)
 	{
@@ -576,6 +680,253 @@ struct sa_bwt_sampling {
 	using sampling_category = sa_sampling_tag;
 };
 
+/*
+ *       Text = ABCDEFABCDEF$
+ *              0123456789012
+ *       sa_sample_dens = 8
+ *     SA BWT (1) (2)
+ *     12  F   *       $
+ *     06  F   *       ABCDEF$
+ *     00  $   *   *   ABCDEFABCDEF$
+ *     07  A   *   *   BCDEF$
+ *     01  A   *       BCDEFABCDEF$
+ *     08  B   *   *   CDEF$
+ *     02  B   *       CDEFABCDEF$
+ *     09  C   *   *   DEF$
+ *     03  C   *       DEFABCDEF$
+ *     10  D   *   *   EF$
+ *     04  D   *       EFABCDEF$
+ *     11  E   *   *   F$
+ *     05  E   *       FABCDEF$
+ *
+ *    (1) In the run sampling SA[i] is marked if i is the first or last
+ *    position of a run in the BWT, or if SA[i] is a multiple of
+ *    sa_sample_dens. In this small example every position is at a run
+ *    boundary; in a repetitive text most of the BWT is covered by long runs.
+ *    (2) For each run start i>0 the pair (SA[i], SA[i-1]) is stored in
+ *    text order. phi(p)=SA[ISA[p]-1] is then the value of the predecessor
+ *    q<=p of p in (2) plus p-q.
+ */
+
+//! SA sampling at the boundaries of the BWT runs with support for the phi function.
+/*!
+ * The samples at the ends of the runs are the toeholds of the r-index:
+ * backward_search_toehold() maintains the SA value of the right border of
+ * the interval with them, and locate() gets the other occurrences with
+ * phi(), which is one rank and one select on an sd_vector per occurrence.
+ * The text positions which are multiples of sa_sample_dens are sampled in
+ * addition, so that csa[i] stops after at most sa_sample_dens LF steps.
+ * With a large sa_sample_dens (and isa_sample_dens) the space is
+ * proportional to the number r of runs.
+ *
+ * \tparam t_csa    CSA type.
+ * \tparam t_bv     Bit vector for the marked SA positions and the text positions of the run starts.
+ * \tparam t_rank   Rank support for t_bv.
+ * \tparam t_select Select support for t_bv.
+ * \tparam t_width  Width of the samples.
+ *
+ * \par Space complexity
+ *      About \f$ r\log\frac{n}{r} + (3r + \frac{n}{s})\log n \f$ bits with sd_vector,
+ *      where \f$ s \f$ is the sampling density.
+ *
+ * \par Reference
+ *      Travis Gagie, Gonzalo Navarro, Nicola Prezza:
+ *      Optimal-Time Text Indexing in BWT-runs Bounded Space.
+ *      SODA 2018: 1459-1477
+ */
+template <class t_csa,
+		  class t_bv	  = sd_vector<>,
+		  class t_rank	= typename t_bv::rank_1_type,
+		  class t_select  = typename t_bv::select_1_type,
+		  uint8_t t_width = 0>
+class _run_sampling {
+private:
+	int_vector<t_width> m_samples;	 // SA values of the marked positions in SA order
+	t_bv				m_marked;	  // marked SA positions
+	t_rank				m_rank_marked; // rank support for m_marked
+	t_bv				m_run_start;   // text positions SA[i] of the run starts i>0
+	t_rank				m_rank_run_start;
+	t_select			m_select_run_start;
+	int_vector<>		m_phi; // SA[i-1] for the run starts i>0 in text order
+
+	void set_vectors()
+	{
+		m_rank_marked.set_vector(&m_marked);
+		m_rank_run_start.set_vector(&m_run_start);
+		m_select_run_start.set_vector(&m_run_start);
+	}
+
+public:
+	typedef typename int_vector<>::size_type  size_type;
+	typedef typename int_vector<>::value_type value_type;
+	typedef t_bv							  bv_type;
+	enum { sample_dens = t_csa::sa_sample_dens };
+	enum { text_order = false };
+	typedef sa_sampling_tag sampling_category;
+
+	//! Default constructor
+	_run_sampling() {}
+
+	//! Constructor
+	/*
+         * \param cconfig Cache configuration (BWT and SA are expected to be cached.).
+         * \param csa    Pointer to the corresponding CSA. Not used in this class.
+         * \par Time complexity
+         *      Linear in the size of the suffix array.
+         */
+	_run_sampling(const cache_config& cconfig, SDSL_UNUSED const t_csa* csa = nullptr)
+	{
+		int_vector_buffer<> sa_buf(cache_file_name(conf::KEY_SA, cconfig));
+		int_vector_buffer<t_csa::alphabet_type::int_width> bwt_buf(
+		cache_file_name(key_bwt<t_csa::alphabet_type::int_width>(), cconfig));
+		size_type  n = sa_buf.size();
+		bit_vector marked(n, 0);
+		bit_vector run_start(n, 0);
+		size_type  samples = 0, runs = 0;
+		for (size_type i = 0; i < n; ++i) {
+			size_type sa	= sa_buf[i];
+			bool	  start = i == 0 or bwt_buf[i - 1] != bwt_buf[i];
+			bool	  end   = i + 1 == n or bwt_buf[i] != bwt_buf[i + 1];
+			if (start or end or 0 == (sa % sample_dens)) {
+				marked[i] = 1;
+				++samples;
+			}
+			if (start and i > 0) {
+				run_start[sa] = 1;
+				++runs;
+			}
+		}
+		m_samples = int_vector<t_width>(samples, 0, bits::hi(n) + 1);
+		m_phi	 = int_vector<>(runs, 0, bits::hi(n) + 1);
+		{
+			rank_support_v<> rank_run_start(&run_start);
+			for (size_type i = 0, k = 0, prev_sa = 0; i < n; ++i) {
+				size_type sa = sa_buf[i];
+				if (marked[i]) m_samples[k++] = sa;
+				if (i > 0 and bwt_buf[i - 1] != bwt_buf[i]) m_phi[rank_run_start(sa)] = prev_sa;
+				prev_sa = sa;
+			}
+		}
+		m_marked	= t_bv(marked);
+		m_run_start = t_bv(run_start);
+		util::init_support(m_rank_marked, &m_marked);
+		util::init_support(m_rank_run_start, &m_run_start);
+		util::init_support(m_select_run_start, &m_run_start);
+	}
+
+	//! Copy constructor
+	_run_sampling(const _run_sampling& st)
+		: m_samples(st.m_samples)
+		, m_marked(st.m_marked)
+		, m_rank_marked(st.m_rank_marked)
+		, m_run_start(st.m_run_start)
+		, m_rank_run_start(st.m_rank_run_start)
+		, m_select_run_start(st.m_select_run_start)
+		, m_phi(st.m_phi)
+	{
+		set_vectors();
+	}
+
+	//! Move constructor
+	_run_sampling(_run_sampling&& st)
+		: m_samples(std::move(st.m_samples))
+		, m_marked(std::move(st.m_marked))
+		, m_rank_marked(std::move(st.m_rank_marked))
+		, m_run_start(std::move(st.m_run_start))
+		, m_rank_run_start(std::move(st.m_rank_run_start))
+		, m_select_run_start(std::move(st.m_select_run_start))
+		, m_phi(std::move(st.m_phi))
+	{
+		set_vectors();
+	}
+
+	//! Assignment operation
+	_run_sampling& operator=(const _run_sampling& st)
+	{
+		if (this != &st) {
+			_run_sampling tmp(st);
+			*this = std::move(tmp);
+		}
+		return *this;
+	}
+
+	//! Move assignment operation
+	_run_sampling& operator=(_run_sampling&& st)
+	{
+		m_samples			= std::move(st.m_samples);
+		m_marked			= std::move(st.m_marked);
+		m_rank_marked		= std::move(st.m_rank_marked);
+		m_run_start			= std::move(st.m_run_start);
+		m_rank_run_start	= std::move(st.m_rank_run_start);
+		m_select_run_start = std::move(st.m_select_run_start);
+		m_phi				= std::move(st.m_phi);
+		set_vectors();
+		return *this;
+	}
+
+	//! Determine if index i is sampled or not
+	/*! The first and the last position of each BWT run is sampled.
+	 */
+	inline bool is_sampled(size_type i) const { return m_marked[i]; }
+
+	//! Return the suffix array value for the sampled index i
+	inline value_type operator[](size_type i) const { return m_samples[m_rank_marked(i)]; }
+
+	//! Returns SA[ISA[p]-1] for a text position p with ISA[p] > 0.
+	/*! \par Time complexity
+	 *       One rank and one select on t_bv.
+	 */
+	inline value_type phi(size_type p) const
+	{
+		size_type k = m_rank_run_start(p + 1); // there is a run start at ISA[0], see above
+		return m_phi[k - 1] + p - m_select_run_start(k);
+	}
+
+	//! Number of samples.
+	size_type size() const { return m_samples.size(); }
+
+	//! Number of runs in the BWT.
+	size_type runs() const { return m_phi.size() + (m_marked.size() > 0); }
+
+	size_type
+	serialize(std::ostream& out, structure_tree_node* v = nullptr, std::string name = "") const
+	{
+		structure_tree_node* child = structure_tree::add_child(v, name, util::class_name(*this));
+		size_type			 written_bytes = 0;
+		written_bytes += m_samples.serialize(out, child, "samples");
+		written_bytes += m_marked.serialize(out, child, "marked");
+		written_bytes += m_rank_marked.serialize(out, child, "rank_marked");
+		written_bytes += m_run_start.serialize(out, child, "run_start");
+		written_bytes += m_rank_run_start.serialize(out, child, "rank_run_start");
+		written_bytes += m_select_run_start.serialize(out, child, "select_run_start");
+		written_bytes += m_phi.serialize(out, child, "phi");
+		structure_tree::add_size(child, written_bytes);
+		return written_bytes;
+	}
+
+	void load(std::istream& in)
+	{
+		m_samples.load(in);
+		m_marked.load(in);
+		m_rank_marked.load(in);
+		m_run_start.load(in);
+		m_rank_run_start.load(in);
+		m_select_run_start.load(in);
+		m_phi.load(in);
+		set_vectors();
+	}
+};
+
+template <class t_bit_vec  = sd_vector<>,
+		  class t_rank_sup = typename t_bit_vec::rank_1_type,
+		  class t_sel_sup  = typename t_bit_vec::select_1_type,
+		  uint8_t t_width  = 0>
+struct run_sa_sampling {
+	template <class t_csa>
+	using type				= _run_sampling<t_csa, t_bit_vec, t_rank_sup, t_sel_sup, t_width>;
+	using sampling_category = sa_sampling_tag;
+};
+
 template <class t_csa, uint8_t t_width = 0>
 class _isa_sampling : public int_vector<t_width> {
 public:
@@ -615,6 +966,31 @@ public:
 		}
 	}
 
+	//! Collects the samples from SA values which are passed in increasing order of SA positions.
+	class builder {
+		friend class _isa_sampling;
+		base_type m_samples;
+
+	public:
+		explicit builder(size_type n)
+		{
+			if (n >= 1) {
+				m_samples = base_type((n - 1) / sample_dens + 1, 0, bits::hi(n) + 1);
+			}
+		}
+
+		void operator()(size_type i, size_type sa)
+		{
+			if (0 == (sa % sample_dens)) m_samples[sa / sample_dens] = i;
+		}
+	};
+
+	//! Constructor from a builder, which has seen all SA values (see construct_bwt_is).
+	explicit _isa_sampling(builder&& b, SDSL_UNUSED const sa_type* sa_sample = nullptr)
+		: base_type(std::move(b.m_samples))
+	{
+	}
+
 	//! Returns the ISA value at position j, where
 	inline value_type operator[](size_type i) const
 	{
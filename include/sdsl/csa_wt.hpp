@@ -12,7 +12,8 @@
 #include "suffix_array_helper.hpp"
 #include "iterators.hpp"
 #include "util.hpp"
-#include "fast_cache.hpp"
+#include "construct_bwt.hpp"
+#include "query_cache.hpp"
 #include "csa_sampling_strategy.hpp"
 #include "csa_alphabet_strategy.hpp"
 #include <iostream>
@@ -99,16 +100,31 @@ public:
 	typedef lf_tag									  extract_category;
 	typedef typename alphabet_type::alphabet_category alphabet_category;
 
+	//! True if the CSA can be constructed by construct_bwt_is (see csa_wt(cache_config&, bwt_is_tag)).
+	enum {
+		bwt_is_support =
+		alphabet_type::int_width == 8 and has_sampling_builder<sa_sample_type>::value
+	};
 
 private:
 	t_wt			m_wavelet_tree; // the wavelet tree
 	sa_sample_type  m_sa_sample;	// suffix array samples
 	isa_sample_type m_isa_sample;   // inverse suffix array samples
 	alphabet_type   m_alphabet;
-//#define USE_CSA_CACHE
-#ifdef USE_CSA_CACHE
-	mutable fast_cache csa_cache;
-#endif
+	mutable query_cache m_cache; // answers of operator[]
+
+	template <class t_builder>
+	void init_isa_sample(t_builder&& isa_b, cache_config&)
+	{
+		isa_sample_type isa_s(std::move(isa_b), &m_sa_sample);
+		util::swap_support(m_isa_sample, isa_s, &m_sa_sample, &m_sa_sample);
+	}
+
+	void init_isa_sample(no_sampling_builder&&, cache_config& config)
+	{
+		isa_sample_type isa_s(config, &m_sa_sample);
+		util::swap_support(m_isa_sample, isa_s, &m_sa_sample, &m_sa_sample);
+	}
 
 public:
 	const typename alphabet_type::char2comp_type& char2comp	= m_alphabet.char2comp;
@@ -135,6 +151,7 @@ public:
 		, m_sa_sample(csa.m_sa_sample)
 		, m_isa_sample(csa.m_isa_sample)
 		, m_alphabet(csa.m_alphabet)
+		, m_cache(csa.m_cache)
 	{
 		m_isa_sample.set_vector(&m_sa_sample);
 	}
@@ -145,6 +162,7 @@ public:
 		, m_sa_sample(std::move(csa.m_sa_sample))
 		, m_isa_sample(std::move(csa.m_isa_sample))
 		, m_alphabet(std::move(csa.m_alphabet))
+		, m_cache(std::move(csa.m_cache))
 	{
 		m_isa_sample.set_vector(&m_sa_sample);
 	}
@@ -152,6 +170,13 @@ public:
 	//! Constructor taking a cache_config
 	csa_wt(cache_config& config);
 
+	//! Constructor which builds the BWT and the samples in one pass of construct_bwt_is
+	/*! Only the text has to be cached; the SA is never written to the cache.
+	 *  ISA samplings without a builder are built from the SA samples.
+	 *  \pre bwt_is_support is true.
+	 */
+	csa_wt(cache_config& config, bwt_is_tag);
+
 	//! Number of elements in the \f$\CSA\f$.
 	/*! Required for the Container Concept of the STL.
          *  \sa max_size, empty
@@ -193,6 +218,13 @@ public:
          */
 	inline value_type operator[](size_type i) const;
 
+	//! The cache for the answers of operator[].
+	/*! The cache is disabled by default and can be enabled at runtime
+	 *  (see query_cache). It must not be reconfigured while other threads
+	 *  run queries.
+	 */
+	query_cache& cache() const { return m_cache; }
+
 	//! Assignment Operator.
 	/*!
          *    Required for the Assignable Concept of the STL.
@@ -218,6 +250,7 @@ public:
 			m_isa_sample   = std::move(csa.m_isa_sample);
 			m_isa_sample.set_vector(&m_sa_sample);
 			m_alphabet = std::move(csa.m_alphabet);
+			m_cache	= std::move(csa.m_cache);
 		}
 		return *this;
 	}
@@ -310,6 +343,53 @@ cache_config& config)
 	}
 }
 
+template <class t_wt,
+		  uint32_t t_dens,
+		  uint32_t t_inv_dens,
+		  class t_sa_sample_strat,
+		  class t_isa,
+		  class t_alphabet_strat>
+csa_wt<t_wt, t_dens, t_inv_dens, t_sa_sample_strat, t_isa, t_alphabet_strat>::csa_wt(
+cache_config& config, bwt_is_tag)
+{
+	static_assert(bwt_is_support, "construct_bwt_is requires a byte alphabet and an SA sampling with a builder.");
+	if (!cache_file_exists(conf::KEY_TEXT, config)) {
+		return;
+	}
+	size_type n = 0;
+	{
+		int_vector_buffer<8> text_buf(cache_file_name(conf::KEY_TEXT, config));
+		n = text_buf.size();
+	}
+	typename sa_sample_type::builder							sa_b(n);
+	typename sampling_builder_trait<isa_sample_type>::type isa_b(n);
+	{
+		auto event = memory_monitor::event("BWT and samples by induced sorting");
+		construct_bwt_is(config, [&](size_type i, size_type sa) {
+			sa_b(i, sa);
+			isa_b(i, sa);
+		});
+	}
+	{
+		auto event = memory_monitor::event("construct csa-alpbabet");
+		int_vector_buffer<8> bwt_buf(cache_file_name(conf::KEY_BWT, config));
+		m_alphabet = alphabet_type(bwt_buf, n);
+	}
+	{
+		auto event  = memory_monitor::event("sample SA");
+		m_sa_sample = sa_sample_type(std::move(sa_b));
+	}
+	{
+		auto event = memory_monitor::event("sample ISA");
+		init_isa_sample(std::move(isa_b), config);
+	}
+	{
+		auto event = memory_monitor::event("construct wavelet tree");
+		int_vector_buffer<8> bwt_buf(cache_file_name(conf::KEY_BWT, config));
+		m_wavelet_tree = wavelet_tree_type(bwt_buf.begin(), bwt_buf.end(), config.dir);
+	}
+}
+
 
 template <class t_wt,
 		  uint32_t t_dens,
@@ -320,17 +400,20 @@ template <class t_wt,
 inline auto csa_wt<t_wt, t_dens, t_inv_dens, t_sa_sample_strat, t_isa, t_alphabet_strat>::
 operator[](size_type i) const -> value_type
 {
+	uint64_t cached = 0;
+	if (m_cache.enabled() and m_cache.lookup(i, cached)) return cached;
+	size_type key = i;
 	size_type off = 0;
 	while (!m_sa_sample.is_sampled(i)) {
 		i = lf[i];
 		++off;
 	}
-	value_type result = m_sa_sample[i];
-	if (result + off < size()) {
-		return result + off;
-	} else {
-		return result + off - size();
+	value_type result = m_sa_sample[i] + off;
+	if (result >= size()) {
+		result -= size();
 	}
+	m_cache.store(key, result);
+	return result;
 }
 
 template <class t_wt,
@@ -365,6 +448,7 @@ std::istream& in)
 	m_sa_sample.load(in);
 	m_isa_sample.load(in, &m_sa_sample);
 	m_alphabet.load(in);
+	m_cache.configure(m_cache.policy(), m_cache.capacity()); // drop old answers
 }
 
 } // end namespace sdsl
@@ -1491,9 +1491,18 @@ note:
   return m;
 }
 
-/* Constructs the suffix array by using the sorted order of type B* suffixes. */
-template <typename saidx_t>
-inline void construct_SA(const uint8_t *T, saidx_t *SA, saidx_t *bucket_A, saidx_t *bucket_B, saidx_t n, saidx_t m) {
+/* Ignores the suffix array values passed by construct_SA. */
+struct sa_no_output {
+  template <typename saidx_t>
+  void operator()(saidx_t, saidx_t) const {}
+};
+
+/* Constructs the suffix array by using the sorted order of type B* suffixes.
+   The final left to right scan passes each entry as out(i, SA[i]) in
+   increasing order of i. */
+template <typename saidx_t, class t_out = sa_no_output>
+inline void construct_SA(const uint8_t *T, saidx_t *SA, saidx_t *bucket_A, saidx_t *bucket_B, saidx_t n, saidx_t m,
+                         t_out&& out = t_out()) {
   saidx_t *i, *j, *k;
   saidx_t s;
   int32_t c0, c1, c2;
@@ -1548,6 +1557,7 @@ inline void construct_SA(const uint8_t *T, saidx_t *SA, saidx_t *bucket_A, saidx
       assert(s < 0);
       *i = ~s;
     }
+    out((saidx_t)(i - SA), *i);
   }
 }
 
@@ -1651,6 +1661,38 @@ divsufsort(const uint8_t *T, saidx_t *SA, saidx_t n) {
   return err;
 }
 
+/* Like divsufsort, but also passes each entry as out(i, SA[i]) in increasing
+   order of i as soon as it is final. */
+template <typename saidx_t, class t_out>
+int32_t
+divsufsort(const uint8_t *T, saidx_t *SA, saidx_t n, t_out&& out) {
+  saidx_t *bucket_A, *bucket_B;
+  saidx_t m;
+  int32_t err = 0;
+
+  if(n <= 2) {
+    err = divsufsort(T, SA, n);
+    for(saidx_t i = 0; err == 0 && i < n; ++i) { out(i, SA[i]); }
+    return err;
+  }
+  if(T == NULL || SA == NULL) { return -1; }
+
+  bucket_A = (saidx_t *)malloc(BUCKET_A_SIZE * sizeof(saidx_t));
+  bucket_B = (saidx_t *)malloc(BUCKET_B_SIZE * sizeof(saidx_t));
+
+  if((bucket_A != NULL) && (bucket_B != NULL)) {
+    m = sort_typeBstar(T, SA, bucket_A, bucket_B, n);
+    construct_SA(T, SA, bucket_A, bucket_B, n, m, out);
+  } else {
+    err = -2;
+  }
+
+  free(bucket_B);
+  free(bucket_A);
+
+  return err;
+}
+
 // template <typename saidx_t>
 // saidx_t
 // divbwt(const uint8_t *T, uint8_t *U, saidx_t *A, saidx_t n) {
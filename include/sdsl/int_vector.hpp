@@ -8,6 +8,7 @@
 #ifndef INCLUDED_SDSL_INT_VECTOR
 #define INCLUDED_SDSL_INT_VECTOR
 
+#include "aligned_format.hpp"
 #include "bits.hpp"
 #include "structure_tree.hpp"
 #include "util.hpp"
@@ -294,6 +295,7 @@ private:
 	size_type	  m_capacity; //!< Number of bits reserved by int_vector.
 	uint64_t*	  m_data;  //!< Pointer to the memory for the bits.
 	int_width_type m_width; //!< Width of the integers.
+	bool		   m_mapped = false; //!< m_data points into a mapping of load_mapped.
 
 	// Hidden, since number of bits (size) does not go well together with int value.
 	void bit_resize(const size_type size, const value_type value);
@@ -640,6 +642,10 @@ public:
 	serialize(std::ostream& out, structure_tree_node* v = nullptr, std::string name = "") const;
 
 	//! Load the int_vector for a stream.
+	/*! If in reads from a mapped_streambuf (see load_mapped) and the payload
+	 *  is 8-byte aligned, the int_vector points into the mapping instead of
+	 *  copying the payload.
+	 */
 	void load(std::istream& in);
 
 	//! non const version of [] operator
@@ -1426,11 +1432,12 @@ inline int_vector<t_width>::int_vector(size_type size, value_type default_value,
 
 template <uint8_t t_width>
 inline int_vector<t_width>::int_vector(int_vector&& v)
-	: m_size(v.m_size), m_capacity(v.m_capacity), m_data(v.m_data), m_width(v.m_width)
+	: m_size(v.m_size), m_capacity(v.m_capacity), m_data(v.m_data), m_width(v.m_width), m_mapped(v.m_mapped)
 {
 	v.m_data = nullptr; // ownership of v.m_data now transfered
 	v.m_size = 0;
 	v.m_capacity = 0;
+	v.m_mapped = false;
 }
 
 template <uint8_t t_width>
@@ -1460,13 +1467,16 @@ template <uint8_t	t_width>
 int_vector<t_width>& int_vector<t_width>::operator=(int_vector&& v)
 {
 	if (this != &v) { // if v is not the same object
+		memory_manager::clear(*this); // release the old data, which may be mapped
 		m_size     = v.m_size;
 		m_data     = v.m_data;
 		m_width    = v.m_width;
 		m_capacity = v.m_capacity;
+		m_mapped   = v.m_mapped;
 		v.m_data     = nullptr;
 		v.m_size     = 0;
 		v.m_capacity = 0;
+		v.m_mapped   = false;
 	}
 	return *this;
 }
@@ -1783,6 +1793,7 @@ int_vector<t_width>::serialize(std::ostream& out, structure_tree_node* v, std::s
 {
 	structure_tree_node* child = structure_tree::add_child(v, name, util::class_name(*this));
 	size_type			 written_bytes = int_vector<t_width>::write_header(m_size, m_width, out);
+	written_bytes += aligned_format::write_padding(out, bit_data_size() * sizeof(uint64_t));
 	written_bytes += write_data(out);
 	structure_tree::add_size(child, written_bytes);
 	return written_bytes;
@@ -1793,7 +1804,9 @@ void int_vector<t_width>::load(std::istream& in)
 {
 	size_type size;
 	int_vector<t_width>::read_header(size, m_width, in);
+	aligned_format::skip_padding(in);
 
+	if (memory_manager::map_data(*this, size, in)) return;
 	bit_resize(size);
 	uint64_t* p   = m_data;
 	size_type idx = 0;
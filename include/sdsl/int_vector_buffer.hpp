@@ -10,11 +10,18 @@
 
 #include "int_vector.hpp"
 #include "iterators.hpp"
+#include <algorithm>
 #include <cassert>
+#include <condition_variable>
 #include <fstream>
 #include <iostream>
+#include <list>
+#include <memory>
+#include <mutex>
 #include <stdio.h>
 #include <string>
+#include <thread>
+#include <vector>
 
 namespace sdsl {
 
@@ -38,6 +45,181 @@ private:
 	uint64_t m_size		  = 0; // size of int_vector_buffer
 	uint64_t m_begin	  = 0; // number in elements
 
+	//! A block which is read ahead or written behind by the I/O thread.
+	struct io_block {
+		enum state_type { queued, active, done };
+		uint64_t			begin = 0; // first element of the block
+		uint64_t			pos   = 0; // position of the block in the file in bytes
+		uint64_t			bytes = 0; // bytes to read or write
+		bool				write = false;
+		state_type			state = queued;
+		int_vector<t_width> data;
+	};
+
+	//! State of the asynchronous mode (see async_io).
+	struct async_state {
+		std::list<io_block>				 blocks; // processed by the I/O thread in this order
+		std::vector<int_vector<t_width>> spare;  // unused block buffers
+		std::mutex						 mtx;
+		std::condition_variable			 cv;
+		bool							 stop   = false;
+		bool							 failed = false; // a stream of the I/O thread failed
+		std::thread						 thread;
+	};
+
+	uint64_t					 m_async_depth = 0; // 0 = synchronous I/O
+	std::unique_ptr<async_state> m_async;
+
+	//! Read up to bytes bytes from position pos of the file into buf.
+	/*! Does not access m_buffer, as it is also called by the I/O thread.
+	 */
+	void read_from_file(uint64_t pos, uint64_t bytes, int_vector<t_width>& buf)
+	{
+		m_ifile.seekg(pos);
+		assert(m_ifile.good());
+		m_ifile.read((char*)buf.data(), bytes);
+		memory_monitor::record_io(m_ifile.gcount(), 0);
+		if ((uint64_t)m_ifile.gcount() < bytes) {
+			m_ifile.clear();
+		}
+		assert(m_ifile.good());
+	}
+
+	//! Write the first bytes bytes of buf to position pos of the file.
+	void write_to_file(uint64_t pos, uint64_t bytes, const int_vector<t_width>& buf)
+	{
+		m_ofile.seekp(pos);
+		assert(m_ofile.good());
+		m_ofile.write((const char*)buf.data(), bytes);
+		memory_monitor::record_io(0, bytes);
+		m_ofile.flush();
+		assert(m_ofile.good());
+	}
+
+	//! Loop of the I/O thread: processes the queued blocks in FIFO order.
+	void io_loop()
+	{
+		async_state&				 a = *m_async;
+		std::unique_lock<std::mutex> lock(a.mtx);
+		while (true) {
+			auto it = std::find_if(a.blocks.begin(), a.blocks.end(), [](const io_block& b) {
+				return b.state == io_block::queued;
+			});
+			if (it == a.blocks.end()) {
+				if (a.stop) return;
+				a.cv.wait(lock);
+				continue;
+			}
+			it->state = io_block::active;
+			lock.unlock();
+			bool ok;
+			if (it->write) {
+				write_to_file(it->pos, it->bytes, it->data);
+				ok = m_ofile.good();
+			} else {
+				read_from_file(it->pos, it->bytes, it->data);
+				ok = m_ifile.good();
+			}
+			lock.lock();
+			a.failed |= !ok;
+			it->state = io_block::done;
+			if (it->write) {
+				a.spare.push_back(std::move(it->data));
+				a.blocks.erase(it);
+			}
+			a.cv.notify_all();
+		}
+	}
+
+	//! Appends a block to the queue of the I/O thread; the caller holds the lock.
+	typename std::list<io_block>::iterator
+	queue_block(uint64_t begin, bool write, uint64_t bytes)
+	{
+		async_state& a = *m_async;
+		io_block	 b;
+		b.begin = begin;
+		b.pos   = m_offset + (begin * width()) / 8;
+		b.bytes = bytes;
+		b.write = write;
+		if (a.spare.empty()) {
+			b.data = int_vector<t_width>(m_buffersize, 0, width());
+		} else {
+			b.data = std::move(a.spare.back());
+			a.spare.pop_back();
+		}
+		return a.blocks.insert(a.blocks.end(), std::move(b));
+	}
+
+	//! Returns the read block starting at element begin; the caller holds the lock.
+	typename std::list<io_block>::iterator find_read(uint64_t begin)
+	{
+		return std::find_if(m_async->blocks.begin(), m_async->blocks.end(),
+							[begin](const io_block& b) { return !b.write and b.begin == begin; });
+	}
+
+	//! Moves the block at m_begin into m_buffer. Waits until it is read, if it was not read ahead.
+	void fetch_block()
+	{
+		async_state&				 a = *m_async;
+		std::unique_lock<std::mutex> lock(a.mtx);
+		auto						 it = find_read(m_begin);
+		if (it == a.blocks.end()) {
+			it = queue_block(m_begin, false, (m_buffersize * width()) / 8);
+			a.cv.notify_all();
+		}
+		a.cv.wait(lock, [&it]() { return it->state == io_block::done; });
+		m_buffer.swap(it->data);
+		a.spare.push_back(std::move(it->data));
+		a.blocks.erase(it);
+	}
+
+	//! Requests the m_async_depth blocks after m_begin and drops other read ahead blocks.
+	void read_ahead()
+	{
+		async_state&				a = *m_async;
+		std::lock_guard<std::mutex> lock(a.mtx);
+		uint64_t					first = m_begin + m_buffersize;
+		uint64_t					last  = m_begin + m_async_depth * m_buffersize;
+		for (auto it = a.blocks.begin(); it != a.blocks.end();) {
+			if (!it->write and it->state != io_block::active and
+				(it->begin < first or it->begin > last)) {
+				a.spare.push_back(std::move(it->data));
+				it = a.blocks.erase(it);
+			} else {
+				++it;
+			}
+		}
+		for (uint64_t b = first; b <= last and b < m_size; b += m_buffersize) {
+			if (find_read(b) == a.blocks.end()) {
+				queue_block(b, false, (m_buffersize * width()) / 8);
+			}
+		}
+		a.cv.notify_all();
+	}
+
+	//! Waits until the I/O thread has written all blocks and stops it.
+	void stop_async()
+	{
+		if (!m_async) return;
+		{
+			std::lock_guard<std::mutex> lock(m_async->mtx);
+			m_async->stop = true;
+			m_async->cv.notify_all();
+		}
+		m_async->thread.join();
+		m_async.reset();
+	}
+
+	//! Starts the I/O thread, if the asynchronous mode is enabled.
+	void start_async()
+	{
+		if (m_async_depth > 0 and !m_async and is_open()) {
+			m_async.reset(new async_state());
+			m_async->failed = !(m_ifile.good() and m_ofile.good());
+			m_async->thread = std::thread([this]() { io_loop(); });
+		}
+	}
+
 	//! Read block containing element at index idx.
 	void read_block(const uint64_t idx)
 	{
@@ -45,34 +227,43 @@ private:
 		if (m_begin >= m_size) {
 			util::set_to_value(m_buffer, 0);
 		} else {
-			m_ifile.seekg(m_offset + (m_begin * width()) / 8);
-			assert(m_ifile.good());
-			m_ifile.read((char*)m_buffer.data(), (m_buffersize * width()) / 8);
-			if ((uint64_t)m_ifile.gcount() < (m_buffersize * width()) / 8) {
-				m_ifile.clear();
+			if (m_async) {
+				fetch_block();
+			} else {
+				read_from_file(
+				m_offset + (m_begin * width()) / 8, (m_buffersize * width()) / 8, m_buffer);
 			}
-			assert(m_ifile.good());
 			for (uint64_t i = m_size - m_begin; i < m_buffersize; ++i) {
 				m_buffer[i] = 0;
 			}
 		}
+		if (m_async) read_ahead();
 	}
 
 	//! Write current block to file.
 	void write_block()
 	{
 		if (m_need_to_write) {
-			m_ofile.seekp(m_offset + (m_begin * width()) / 8);
-			assert(m_ofile.good());
+			uint64_t bytes = (m_buffersize * width()) / 8;
 			if (m_begin + m_buffersize >= m_size) {
 				//last block in file
-				uint64_t wb = ((m_size - m_begin) * width() + 7) / 8;
-				m_ofile.write((char*)m_buffer.data(), wb);
+				bytes = ((m_size - m_begin) * width() + 7) / 8;
+			}
+			if (m_async) {
+				// at most m_async_depth blocks are written behind
+				async_state&				 a = *m_async;
+				std::unique_lock<std::mutex> lock(a.mtx);
+				a.cv.wait(lock, [&a, this]() {
+					return (uint64_t)std::count_if(a.blocks.begin(), a.blocks.end(),
+												   [](const io_block& b) { return b.write; }) <
+						   m_async_depth;
+				});
+				auto it = queue_block(m_begin, true, bytes);
+				it->data.swap(m_buffer); // m_buffer is refilled by read_block
+				a.cv.notify_all();
 			} else {
-				m_ofile.write((char*)m_buffer.data(), (m_buffersize * width()) / 8);
+				write_to_file(m_offset + (m_begin * width()) / 8, bytes, m_buffer);
 			}
-			m_ofile.flush();
-			assert(m_ofile.good());
 			m_need_to_write = false;
 		}
 	}
@@ -160,30 +351,7 @@ public:
 	}
 
 	//! Move constructor.
-	int_vector_buffer(int_vector_buffer&& ivb)
-		: m_filename(std::move(ivb.m_filename))
-		, m_buffer(std::move(ivb.m_buffer))
-		, m_need_to_write(ivb.m_need_to_write)
-		, m_offset(ivb.m_offset)
-		, m_buffersize(ivb.m_buffersize)
-		, m_size(ivb.m_size)
-		, m_begin(ivb.m_begin)
-	{
-		ivb.m_ifile.close();
-		ivb.m_ofile.close();
-		m_ifile.open(m_filename, std::ios::in | std::ios::binary);
-		m_ofile.open(m_filename, std::ios::in | std::ios::out | std::ios::binary);
-		assert(m_ifile.good());
-		assert(m_ofile.good());
-		// set ivb to default-constructor state
-		ivb.m_filename		= "";
-		ivb.m_buffer		= int_vector<t_width>();
-		ivb.m_need_to_write = false;
-		ivb.m_offset		= 0;
-		ivb.m_buffersize	= 8;
-		ivb.m_size			= 0;
-		ivb.m_begin			= 0;
-	}
+	int_vector_buffer(int_vector_buffer&& ivb) : int_vector_buffer() { *this = std::move(ivb); }
 
 	//! Destructor.
 	~int_vector_buffer() { close(); }
@@ -192,6 +360,7 @@ public:
 	int_vector_buffer<t_width>& operator=(int_vector_buffer&& ivb)
 	{
 		close();
+		ivb.stop_async();
 		ivb.m_ifile.close();
 		ivb.m_ofile.close();
 		m_filename = ivb.m_filename;
@@ -206,6 +375,7 @@ public:
 		m_buffersize	= ivb.m_buffersize;
 		m_size			= ivb.m_size;
 		m_begin			= ivb.m_begin;
+		m_async_depth	= ivb.m_async_depth;
 		// set ivb to default-constructor state
 		ivb.m_filename		= "";
 		ivb.m_buffer		= int_vector<t_width>();
@@ -214,6 +384,8 @@ public:
 		ivb.m_buffersize	= 8;
 		ivb.m_size			= 0;
 		ivb.m_begin			= 0;
+		ivb.m_async_depth	= 0;
+		start_async();
 		return *this;
 	}
 
@@ -238,6 +410,7 @@ public:
 	{
 		if (0ULL == buffersize) buffersize = 8;
 		write_block();
+		stop_async(); // the blocks of the I/O thread have the old size
 		if (0 == (buffersize * 8) % width()) {
 			m_buffersize =
 			buffersize * 8 /
@@ -251,10 +424,47 @@ public:
 		}
 		m_buffer = int_vector<t_width>(m_buffersize, 0, width());
 		if (0 != m_buffersize) read_block(0);
+		start_async();
+	}
+
+	//! Returns the number of blocks which are read ahead and written behind; 0 if I/O is synchronous.
+	uint64_t async_io() const { return m_async_depth; }
+
+	//! Enables the asynchronous mode, in which a background thread performs the file I/O.
+	/*! \param depth Number of blocks which are read ahead and written behind;
+	 *               0 switches back to synchronous I/O.
+	 *
+	 *  After each block change the thread reads the next depth blocks into
+	 *  spare buffers, so a sequential scan finds its next block in memory.
+	 *  A modified block is handed to the thread instead of being written
+	 *  immediately; the caller only waits if depth blocks are pending.
+	 *  Blocks are processed in the order of the requests, so a block which
+	 *  is read again sees all earlier writes. The buffer size (see
+	 *  buffersize) is the size of each block; the mode needs up to
+	 *  2*depth+1 block buffers.
+	 *
+	 *  An int_vector_buffer with asynchronous I/O must not be used by
+	 *  several threads; the file is complete only after close.
+	 */
+	void async_io(uint64_t depth)
+	{
+		stop_async();
+		m_async_depth = depth;
+		start_async();
 	}
 
 	//! Returns whether state of underlying streams are good
-	bool good() { return m_ifile.good() and m_ofile.good(); }
+	/*! In the asynchronous mode the streams belong to the I/O thread, which
+	 *  records its failures; blocks which are still queued are not included.
+	 */
+	bool good()
+	{
+		if (m_async) {
+			std::lock_guard<std::mutex> lock(m_async->mtx);
+			return !m_async->failed;
+		}
+		return m_ifile.good() and m_ofile.good();
+	}
 
 	//! Returns whether underlying streams are currently associated to a file
 	bool is_open()
@@ -267,6 +477,7 @@ public:
 	void reset()
 	{
 		// reset file
+		stop_async();
 		assert(m_ifile.good());
 		assert(m_ofile.good());
 		m_ifile.close();
@@ -281,6 +492,7 @@ public:
 		m_size			= 0;
 		// reset buffer
 		read_block(0);
+		start_async();
 	}
 
 	// Forward declaration
@@ -304,18 +516,19 @@ public:
 		if (is_open()) {
 			if (!remove_file) {
 				write_block();
-				if (0 < m_offset) { // in case of int_vector, write header and trailing zeros
-					uint64_t size = m_size * width();
-					m_ofile.seekp(0, std::ios::beg);
-					int_vector<t_width>::write_header(size, width(), m_ofile);
+			}
+			stop_async();
+			if (!remove_file and 0 < m_offset) { // in case of int_vector, write header and trailing zeros
+				uint64_t size = m_size * width();
+				m_ofile.seekp(0, std::ios::beg);
+				int_vector<t_width>::write_header(size, width(), m_ofile);
+				assert(m_ofile.good());
+				uint64_t wb = (size + 7) / 8;
+				if (wb % 8) {
+					m_ofile.seekp(m_offset + wb);
+					assert(m_ofile.good());
+					m_ofile.write("\0\0\0\0\0\0\0\0", 8 - wb % 8);
 					assert(m_ofile.good());
-					uint64_t wb = (size + 7) / 8;
-					if (wb % 8) {
-						m_ofile.seekp(m_offset + wb);
-						assert(m_ofile.good());
-						m_ofile.write("\0\0\0\0\0\0\0\0", 8 - wb % 8);
-						assert(m_ofile.good());
-					}
 				}
 			}
 			m_ifile.close();
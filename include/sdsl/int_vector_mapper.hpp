@@ -46,6 +46,12 @@ public:
 	~int_vector_mapper()
 	{
 		if (m_mapped_data) {
+			// the mapped bytes count as read or, for a writable mapping, as written
+			if (t_mode & std::ios_base::out) {
+				memory_monitor::record_io(0, m_file_size_bytes);
+			} else {
+				memory_monitor::record_io(m_file_size_bytes, 0);
+			}
 			auto ret = memory_manager::mem_unmap(m_fd, m_mapped_data, m_file_size_bytes);
 			if (ret != 0) {
 				std::cerr << "int_vector_mapper: error unmapping file mapping'" << m_file_name
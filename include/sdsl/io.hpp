@@ -8,7 +8,9 @@
 #ifndef INCLUDED_SDSL_IO
 #define INCLUDED_SDSL_IO
 
+#include "aligned_format.hpp"
 #include "util.hpp"
+#include "memory_management.hpp"
 #include "platform.hpp"
 #include "sdsl_concepts.hpp"
 #include "structure_tree.hpp"
@@ -180,6 +182,22 @@ void load(std::vector<X>& x, std::istream& in)
 template <typename T>
 bool load_from_file(T& v, const std::string& file);
 
+//! Load sdsl-object v from a file without copying the int_vector payloads.
+/*!
+ * The file is mapped into memory (private and copy-on-write) and every
+ * int_vector of v whose payload is 8-byte aligned in the file points into
+ * the mapping. The mapping lives as long as one of these int_vectors.
+ * Loading is therefore almost free for large structures and the pages are
+ * shared between processes which load the same file. Writing to a mapped
+ * int_vector only modifies the private copy of the written page.
+ * Falls back to load_from_file for ram-files and if mapping fails.
+ * \param v    sdsl-object.
+ * \param file Name of the serialized file.
+ * \sa memory_manager::is_mapped
+ */
+template <typename T>
+bool load_mapped(T& v, const std::string& file);
+
 //! Load an int_vector from a plain array of `num_bytes`-byte integers with X in \{0, 1,2,4,8\} from disk.
 // TODO: Remove ENDIAN dependency.
 template <typename t_int_vec>
@@ -290,6 +308,24 @@ inline bool store_to_file(const char* v, const std::string& file)
 template <uint8_t t_width>
 bool store_to_file(const int_vector<t_width>& v, const std::string& file);
 
+//! Store a data structure to a file in the aligned format.
+/*! All int_vector payloads start at 64-byte boundaries and the file ends
+ *  with a table of contents of the payloads (see aligned_format).
+ *  load_from_file and load_mapped detect the format automatically.
+ *  \param v    The object to store.
+ *  \param file Name of the file.
+ *  \return True iff the object was stored.
+ */
+template <typename T>
+bool store_to_file_aligned(const T& v, const std::string& file);
+
+//! Reads the table of contents of a file in the aligned format.
+/*! \param file Name of the file.
+ *  \param toc  Receives one entry per int_vector payload.
+ *  \return False if the file could not be read or is not in the aligned format.
+ */
+inline bool read_toc(const std::string& file, std::vector<toc_entry>& toc);
+
 
 //! Store an int_vector as plain int_type array to disk
 template <typename int_type, typename t_int_vec>
@@ -802,6 +838,7 @@ bool store_to_file(const T& t, const std::string& file)
 		return false;
 	}
 	serialize(t, out);
+	memory_monitor::record_io(0, out.tellp());
 	out.close();
 	if (util::verbose) {
 		std::cerr << "INFO: store_to_file: `" << file << "`" << std::endl;
@@ -809,6 +846,39 @@ bool store_to_file(const T& t, const std::string& file)
 	return true;
 }
 
+template <typename T>
+bool store_to_file_aligned(const T& v, const std::string& file)
+{
+	osfstream out(file, std::ios::binary | std::ios::trunc | std::ios::out);
+	if (!out) {
+		if (util::verbose) {
+			std::cerr << "ERROR: store_to_file_aligned not successful for: `" << file << "`"
+					  << std::endl;
+		}
+		return false;
+	}
+	{
+		aligned_format::writer format(out);
+		serialize(v, format.stream());
+		format.finish();
+	}
+	memory_monitor::record_io(0, out.tellp());
+	out.close();
+	if (util::verbose) {
+		std::cerr << "INFO: store_to_file_aligned: `" << file << "`" << std::endl;
+	}
+	return true;
+}
+
+inline bool read_toc(const std::string& file, std::vector<toc_entry>& toc)
+{
+	isfstream in(file, std::ios::binary | std::ios::in);
+	if (!in) {
+		return false;
+	}
+	return read_toc(in, util::file_size(file), toc);
+}
+
 template <typename T>
 bool store_to_checked_file(const T& t, const std::string& file)
 {
@@ -871,6 +941,7 @@ bool store_to_file(const int_vector<t_width>& v, const std::string& file)
 		}
 	}
 	v.serialize(out, nullptr, "");
+	memory_monitor::record_io(0, out.tellp());
 	out.close();
 	return true;
 }
@@ -904,7 +975,11 @@ bool load_from_file(T& v, const std::string& file)
 		}
 		return false;
 	}
-	load(v, in);
+	{
+		aligned_format::reader format(in);
+		load(v, in);
+	}
+	memory_monitor::record_io(in.tellg(), 0);
 	in.close();
 	if (util::verbose) {
 		std::cerr << "Load file `" << file << "`" << std::endl;
@@ -912,6 +987,25 @@ bool load_from_file(T& v, const std::string& file)
 	return true;
 }
 
+template <typename T>
+bool load_mapped(T& v, const std::string& file)
+{
+	if (is_ram_file(file)) {
+		return load_from_file(v, file);
+	}
+	mapped_streambuf buf(file);
+	if (!buf.is_open()) {
+		return load_from_file(v, file);
+	}
+	std::istream		   in(&buf);
+	aligned_format::reader format(in);
+	load(v, in);
+	if (util::verbose) {
+		std::cerr << "Load mapped file `" << file << "`" << std::endl;
+	}
+	return true;
+}
+
 template <typename T>
 bool load_from_checked_file(T& v, const std::string& file)
 {
@@ -71,79 +71,163 @@ protected:
 		bit_vector k_t_(t_size, 0);
 		bit_vector k_l_(l_size, 0);
 
-		int n = 0;
+		size_type n = 0;
 		for (int j = 1; j < k_height; j++)
-			for (auto it = acc[j].begin(); it != acc[j].end(); it++)
-				for (unsigned i = 0; i < (*it).size(); i++) {
-					// TODO there should be a better way to do this
-					k_t_.set_int(n, (*it).get_int(i, 1), 1);
-					n++;
-				}
-		n = 0;
-		for (auto it = acc[k_height].begin(); it != acc[k_height].end(); it++)
-			for (unsigned i = 0; i < (*it).size(); i++) {
-				// TODO there should be a better way to do this
-				k_l_.set_int(n * 1, (*it).get_int(i, 1), 1);
-				n++;
+			for (auto it = acc[j].begin(); it != acc[j].end(); it++) {
+				k2_tree_ns::copy_bits(*it, k_t_, n);
+				n += (*it).size();
 			}
+		n = 0;
+		for (auto it = acc[k_height].begin(); it != acc[k_height].end(); it++) {
+			k2_tree_ns::copy_bits(*it, k_l_, n);
+			n += (*it).size();
+		}
 
 		k2_tree_ns::build_template_vector<t_bv>(k_t_, k_l_, k_t, k_l);
 	}
 
 
-	/*! Recursive function to retrieve list of neighbors.
-         *
-         *  \param n Size of the submatrix in the next recursive step.
-         *  \param row Row of interest in the current submatrix, this is the
-         *      row corresponding the node we are looking neighbors for.
-         *  \param col Column offset of the current submatrix in the global
-         *      matrix.
-         *  \param level Position in k_t:k_l (k_l appended to k_t) of the node
-         *      or leaf being processed at this step.
-         *  \param acc Accumulator to store the neighbors found.
-         */
-	void _neigh(
-	size_type n, idx_type row, idx_type col, size_type level, std::vector<idx_type>& acc) const
+	//! If k is a power of two the digits of a node are computed with shifts.
+	static constexpr bool	k_pow2 = (k & (k - 1)) == 0;
+	static constexpr uint8_t k_log  = k2_tree_ns::floor_log2(k);
+	static constexpr size_type k_2 = (size_type)k * k;
+	//! Maximal height of a tree: k^height has to be smaller than 2^64 (k >= 2).
+	static constexpr uint16_t max_height = 65;
+	//! Maximal number of pending nodes of the depth-first traversals below.
+	static constexpr size_type max_stack = (size_type)k * max_height;
+	//! Number of nodes of a batch query which are traversed together.
+	static constexpr size_type batch_group = 32;
+
+	//! A node of the traversal: position in k_t:k_l, offset and depth.
+	struct node {
+		idx_type pos;
+		idx_type offset;
+		uint16_t depth;
+	};
+
+	//! Stores the submatrix size k^(k_height-1-d) of a child at depth d in sizes[d].
+	void _sizes(size_type* sizes) const
 	{
-		if (level >= k_t.size()) { // Last level
-			if (k_l[level - k_t.size()] == 1) acc.push_back(col);
-			return;
+		sizes[k_height - 1] = 1;
+		for (int d = k_height - 2; d >= 0; --d)
+			sizes[d] = sizes[d + 1] * k;
+	}
+
+	//! Digit (x / sizes[d]) % k of x at depth d.
+	idx_type _digit(idx_type x, const size_type* sizes, uint16_t d) const
+	{
+		if (k_pow2) return (x >> (k_log * (k_height - 1 - d))) & (k - 1);
+		return (x / sizes[d]) % k;
+	}
+
+	/*! Calls f(j) for each neighbor (reverse = false) or reverse neighbor
+	 *  (reverse = true) j of node i in increasing order.
+	 *
+	 *  The traversal is iterative and allocation-free: the pending nodes are
+	 *  kept in a stack of fixed size. Each node of depth d covers one
+	 *  submatrix; its row (column for reverse) digit at depth d is the same
+	 *  for all nodes, so only the position and the column (row) offset of a
+	 *  node are stored.
+	 */
+	template <bool reverse, class t_f>
+	void _for_each_neighbor(idx_type i, t_f&& f) const
+	{
+		if (k_l.size() == 0 && k_t.size() == 0) return;
+		size_type sizes[max_height];
+		_sizes(sizes);
+		node	  stack[max_stack];
+		size_type top = 0;
+		// j-th child of the block starting at base, which lies in the strip of i
+		auto child = [&](idx_type base, idx_type digit, idx_type j) {
+			return reverse ? base + j * k + digit : base + digit * k + j;
+		};
+		idx_type digit = _digit(i, sizes, 0);
+		for (idx_type j = k; j-- > 0;)
+			stack[top++] = {child(0, digit, j), sizes[0] * j, 0};
+		while (top > 0) {
+			node v = stack[--top];
+			if (v.pos >= k_t.size()) {
+				if (k_l[v.pos - k_t.size()] == 1) f(v.offset);
+				continue;
+			}
+			if (k_t[v.pos] == 0) continue;
+			uint16_t d	= v.depth + 1;
+			idx_type base = k_t_rank(v.pos + 1) * k_2;
+			digit		  = _digit(i, sizes, d);
+			for (idx_type j = k; j-- > 0;)
+				stack[top++] = {child(base, digit, j), v.offset + sizes[d] * j, d};
 		}
+	}
 
-		if (k_t[level] == 1) {
-			idx_type y =
-			k_t_rank(level + 1) * std::pow(k_k, 2) + k_k * std::floor(row / static_cast<double>(n));
-			for (unsigned j = 0; j < k_k; j++)
-				_neigh(n / k_k, row % n, col + n * j, y + j, acc);
+	/*! Level-synchronous traversal for a batch of nodes; calls f(b, j) for
+	 *  each neighbor (reverse neighbor) j of nodes[b], grouped by b and in
+	 *  increasing order of j.
+	 *
+	 *  The nodes are traversed in groups of batch_group nodes; all nodes
+	 *  of a level of a group are processed before the next level. While
+	 *  the children of a level are collected, the rank data of the nodes
+	 *  ahead is prefetched, so the memory accesses overlap. The groups keep
+	 *  the frontier small for nodes with many neighbors.
+	 */
+	template <bool reverse, class t_f>
+	void _for_each_neighbor_batch(const std::vector<idx_type>& nodes, t_f&& f) const
+	{
+		if (k_l.size() == 0 && k_t.size() == 0) return;
+		size_type sizes[max_height];
+		_sizes(sizes);
+		// the nodes of the current level and the index in nodes they belong to
+		std::vector<node>	 cur, next;
+		std::vector<idx_type> batch_of, next_batch;
+		for (idx_type g = 0; g < nodes.size(); g += batch_group) {
+			idx_type g_end = std::min(g + batch_group, (idx_type)nodes.size());
+			_for_each_neighbor_group<reverse>(nodes, g, g_end, sizes, cur, next, batch_of,
+											  next_batch, f);
 		}
 	}
 
-	/*! Recursive function to retrieve list of reverse neighbors.
-         *
-         *  \param n Size of the submatrix in the next recursive step.
-         *  \param row Row offset of the current submatrix in the global matrix.
-         *  \param col Column of interest in the current submatrix, this is the
-         *      column corresponding the node we are looking reverse neighbors
-         *      for.
-         *  \param level Position in k_t:k_l (k_l appended to k_t) of the node
-         *      or leaf being processed at this step.
-         *  \param acc Accumulator to store the neighbors found.
-         */
-	void _reverse_neigh(
-	size_type n, idx_type row, idx_type col, size_type level, std::vector<idx_type>& acc) const
+	//! Traverses nodes[g..g_end) for _for_each_neighbor_batch, the vectors are reused buffers.
+	template <bool reverse, class t_f>
+	void _for_each_neighbor_group(const std::vector<idx_type>& nodes,
+								  idx_type					 g,
+								  idx_type					 g_end,
+								  const size_type*			 sizes,
+								  std::vector<node>&		   cur,
+								  std::vector<node>&		   next,
+								  std::vector<idx_type>&	   batch_of,
+								  std::vector<idx_type>&	   next_batch,
+								  t_f&&						f) const
 	{
-		if (level >= k_t.size()) { // Last level
-			if (k_l[level - k_t.size()] == 1) {
-				acc.push_back(row);
+		cur.clear();
+		batch_of.clear();
+		for (idx_type b = g; b < g_end; ++b) {
+			idx_type digit = _digit(nodes[b], sizes, 0);
+			for (idx_type j = 0; j < k; ++j) {
+				cur.push_back({reverse ? j * k + digit : digit * k + j, sizes[0] * j, 0});
+				batch_of.push_back(b);
 			}
-			return;
 		}
-
-		if (k_t[level] == 1) {
-			idx_type y =
-			k_t_rank(level + 1) * std::pow(k_k, 2) + std::floor(col / static_cast<double>(n));
-			for (unsigned j = 0; j < k_k; j++)
-				_reverse_neigh(n / k_k, row + n * j, col % n, y + j * k_k, acc);
+		for (uint16_t d = 0; !cur.empty(); ++d) {
+			if (d + 1 == k_height) { // leaves
+				for (idx_type x = 0; x < cur.size(); ++x)
+					if (k_l[cur[x].pos - k_t.size()] == 1) f(batch_of[x], cur[x].offset);
+				break;
+			}
+			next.clear();
+			next_batch.clear();
+			for (idx_type x = 0; x < cur.size(); ++x) {
+				if (x + 8 < cur.size()) prefetch_rank(k_t_rank, cur[x + 8].pos + 1);
+				const node& v = cur[x];
+				if (k_t[v.pos] == 0) continue;
+				idx_type base  = k_t_rank(v.pos + 1) * k_2;
+				idx_type digit = _digit(nodes[batch_of[x]], sizes, d + 1);
+				for (idx_type j = 0; j < k; ++j) {
+					idx_type pos = reverse ? base + j * k + digit : base + digit * k + j;
+					next.push_back({pos, v.offset + sizes[d + 1] * j, (uint16_t)(d + 1)});
+					next_batch.push_back(batch_of[x]);
+				}
+			}
+			cur.swap(next);
+			batch_of.swap(next_batch);
 		}
 	}
 
@@ -239,6 +323,77 @@ protected:
 		k_t_rank = t_rank(&k_t);
 	}
 
+	//! Build a tree from edges stored in two int_vector_buffers
+	/*! The edges are sorted by their Z-order code in bounded memory (see
+         *  k2_tree_ns::external_z_sort) and the levels are written in one
+         *  pass over the sorted codes. Duplicate edges are ignored.
+         *  If the Z-order codes do not fit into 64 bits (see
+         *  k2_tree_ns::z_order_fits), the edges are loaded into memory and
+         *  the tree is built by build_from_edges.
+         *  \param buf_x      Sources of the edges.
+         *  \param buf_y      Targets of the edges.
+         *  \param size       Size of the graph, all the nodes must be within
+         *                    0 and size ([0, size[).
+         *  \param tmp_dir_file The temporary files of sorted runs are stored in
+         *                    the directory of this file.
+         *  \param run_size   Number of edges which are sorted in memory at once.
+         */
+	void build_from_edge_buffers(int_vector_buffer<>& buf_x,
+								 int_vector_buffer<>& buf_y,
+								 const size_type	  size,
+								 const std::string&   tmp_dir_file,
+								 size_type			  run_size)
+	{
+		k_k		 = k;
+		k_height = std::ceil(std::log(size) / std::log(k_k));
+		k_height = k_height > 1 ? k_height : 1; // If size == 0
+		if (!k2_tree_ns::z_order_fits(k_k, k_height)) {
+			std::vector<std::tuple<idx_type, idx_type>> edges;
+			edges.reserve(buf_x.size());
+			for (uint64_t i = 0; i < buf_x.size(); i++)
+				edges.push_back(std::tuple<idx_type, idx_type>{buf_x[i], buf_y[i]});
+			build_from_edges(edges, size);
+			return;
+		}
+		size_type k_2 = std::pow(k_k, 2);
+		// weight[l] = (k^2)^(k_height-1-l) is the weight of the digit of level l
+		std::vector<uint64_t> weight(k_height, 1);
+		for (int l = k_height - 2; l >= 0; --l)
+			weight[l] = weight[l + 1] * k_2;
+
+		std::vector<k2_tree_ns::level_writer> levels(k_height, k2_tree_ns::level_writer(k_2));
+		bool								  first = true;
+		uint64_t							  last  = 0;
+		k2_tree_ns::external_z_sort(
+		buf_x, buf_y, k_k, k_height, run_size, tmp_dir_file, [&](uint64_t code) {
+			// the nodes of the levels below the first differing digit are new
+			uint16_t d = 0;
+			if (!first)
+				while (code / weight[d] == last / weight[d])
+					++d;
+			for (uint16_t l = d; l < k_height; ++l) {
+				if (first or l > d) levels[l].open_block();
+				levels[l].set((code / weight[l]) % k_2);
+			}
+			first = false;
+			last  = code;
+		});
+
+		size_type t_size = 0;
+		for (int l = 0; l + 1 < k_height; ++l)
+			t_size += levels[l].bits().size();
+		bit_vector k_t_(t_size, 0);
+		size_type n = 0;
+		for (int l = 0; l + 1 < k_height; ++l) {
+			k2_tree_ns::copy_bits(levels[l].bits(), k_t_, n);
+			n += levels[l].bits().size();
+		}
+		bit_vector k_l_ = std::move(levels[k_height - 1].bits());
+		k2_tree_ns::build_template_vector<t_bv>(k_t_, k_l_, k_t, k_l);
+
+		k_t_rank = t_rank(&k_t);
+	}
+
 public:
 	k2_tree() = default;
 
@@ -295,8 +450,11 @@ public:
          *				by the files must be within 0 and size ([0, size[). If
          *				size==0, the size will be taken as the max node
          *				in the edges.
+         *  \param run_size Number of edges which are sorted in main memory
+         *				at once (8 bytes each). Larger inputs are sorted in
+         *				runs, which are stored next to filename and merged.
          */
-	k2_tree(std::string filename, size_type size = 0)
+	k2_tree(std::string filename, size_type size = 0, size_type run_size = 1ULL << 25)
 	{
 		int_vector_buffer<> buf_x(filename + ".x", std::ios::in);
 		int_vector_buffer<> buf_y(filename + ".y", std::ios::in);
@@ -304,9 +462,6 @@ public:
 		assert(buf_x.size() == buf_y.size());
 		assert(buf_x.size() > 0);
 
-		std::vector<std::tuple<idx_type, idx_type>> edges;
-		edges.reserve(buf_x.size());
-
 		if (size == 0) {
 			size_type max = 0;
 			for (auto v : buf_x)
@@ -316,10 +471,7 @@ public:
 			size	= max + 1;
 		}
 
-		for (uint64_t i = 0; i < buf_x.size(); i++)
-			edges.push_back(std::tuple<idx_type, idx_type>{buf_x[i], buf_y[i]});
-
-		build_from_edges(edges, size);
+		build_from_edge_buffers(buf_x, buf_y, size, filename, run_size);
 	}
 
 
@@ -418,11 +570,7 @@ public:
 	std::vector<idx_type> neigh(idx_type i) const
 	{
 		std::vector<idx_type> acc{};
-		if (k_l.size() == 0 && k_t.size() == 0) return acc;
-		size_type n = static_cast<size_type>(std::pow(k_k, k_height)) / k_k;
-		idx_type  y = k_k * std::floor(i / static_cast<double>(n));
-		for (unsigned j = 0; j < k_k; j++)
-			_neigh(n / k_k, i % n, n * j, y + j, acc);
+		for_each_neigh(i, [&acc](idx_type j) { acc.push_back(j); });
 		return acc;
 	}
 
@@ -434,16 +582,101 @@ public:
 	std::vector<idx_type> reverse_neigh(idx_type i) const
 	{
 		std::vector<idx_type> acc{};
-		if (k_l.size() == 0 && k_t.size() == 0) return acc;
-		// Size of the first square division
-		size_type n = static_cast<size_type>(std::pow(k_k, k_height)) / k_k;
-		idx_type  y = std::floor(i / static_cast<double>(n));
-		for (unsigned j = 0; j < k_k; j++)
-			_reverse_neigh(n / k_k, n * j, i % n, y + j * k_k, acc);
+		for_each_reverse_neigh(i, [&acc](idx_type j) { acc.push_back(j); });
+		return acc;
+	}
+
+	//! Calls f(j) for each neighbor j of node i in increasing order; does not allocate memory.
+	template <class t_f>
+	void for_each_neigh(idx_type i, t_f&& f) const
+	{
+		_for_each_neighbor<false>(i, f);
+	}
 
+	//! Calls f(j) for each reverse neighbor j of node i in increasing order; does not allocate memory.
+	template <class t_f>
+	void for_each_reverse_neigh(idx_type i, t_f&& f) const
+	{
+		_for_each_neighbor<true>(i, f);
+	}
+
+	//! Returns the lists of neighbors of several nodes.
+	/*! The nodes are processed together level by level, which hides the
+         *  latency of the memory accesses for large batches.
+         *  \param nodes Nodes to get neighbors from.
+         *  \returns For each node the list of its neighbors.
+         */
+	std::vector<std::vector<idx_type>> neigh_batch(const std::vector<idx_type>& nodes) const
+	{
+		std::vector<std::vector<idx_type>> acc(nodes.size());
+		_for_each_neighbor_batch<false>(nodes,
+										[&acc](idx_type b, idx_type j) { acc[b].push_back(j); });
+		return acc;
+	}
+
+	//! Returns the lists of reverse neighbors of several nodes (see neigh_batch).
+	std::vector<std::vector<idx_type>> reverse_neigh_batch(const std::vector<idx_type>& nodes) const
+	{
+		std::vector<std::vector<idx_type>> acc(nodes.size());
+		_for_each_neighbor_batch<true>(nodes,
+									   [&acc](idx_type b, idx_type j) { acc[b].push_back(j); });
 		return acc;
 	}
 
+	//! Calls f(t, i, j) for each edge (i, j) of the graph, using num_threads threads.
+	/*! The subtrees below the first level with enough nodes are traversed
+         *  concurrently; t is the number of the calling thread in
+         *  [0, num_threads). The edges of one subtree are reported by one
+         *  thread in row-major Z-order, there is no global order. This is
+         *  the scan of BFS or PageRank-style iterations, which accumulate
+         *  per thread.
+         */
+	template <class t_f>
+	void edge_scan(t_f&& f, uint64_t num_threads = 1) const
+	{
+		if (k_l.size() == 0 && k_t.size() == 0) return;
+		size_type sizes[max_height];
+		_sizes(sizes);
+		struct task {
+			idx_type pos, row, col;
+			uint16_t depth;
+		};
+		// split the matrix into tasks, expand levels until there are enough of them
+		std::vector<task> tasks, next;
+		for (idx_type x = 0; x < k_2; ++x)
+			tasks.push_back({x, sizes[0] * (x / k), sizes[0] * (x % k), 0});
+		num_threads = std::max(num_threads, (uint64_t)1);
+		while (num_threads > 1 and tasks.size() < 16 * num_threads and
+			   tasks[0].depth + 1 < k_height) {
+			next.clear();
+			for (const auto& v : tasks) {
+				if (k_t[v.pos] == 0) continue;
+				uint16_t d	= v.depth + 1;
+				idx_type base = k_t_rank(v.pos + 1) * k_2;
+				for (idx_type x = 0; x < k_2; ++x)
+					next.push_back({base + x, v.row + sizes[d] * (x / k), v.col + sizes[d] * (x % k), d});
+			}
+			tasks.swap(next);
+			if (tasks.empty()) return;
+		}
+		parallel_for_each(tasks.size(), num_threads, [&](uint64_t t, uint64_t x) {
+			std::vector<task> stack{tasks[x]};
+			while (!stack.empty()) {
+				task v = stack.back();
+				stack.pop_back();
+				if (v.pos >= k_t.size()) {
+					if (k_l[v.pos - k_t.size()] == 1) f(t, v.row, v.col);
+					continue;
+				}
+				if (k_t[v.pos] == 0) continue;
+				uint16_t d	= v.depth + 1;
+				idx_type base = k_t_rank(v.pos + 1) * k_2;
+				for (idx_type y = k_2; y-- > 0;)
+					stack.push_back({base + y, v.row + sizes[d] * (y / k), v.col + sizes[d] * (y % k), d});
+			}
+		});
+	}
+
 
 	//! Serialize to a stream
 	/*! Serialize the k2_tree data structure
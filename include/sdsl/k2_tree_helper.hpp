@@ -8,10 +8,18 @@
 #ifndef INCLUDED_SDSL_K2_TREE_HELPER
 #define INCLUDED_SDSL_K2_TREE_HELPER
 
+#include <algorithm>
 #include <cmath>
+#include <functional>
 #include <iostream>
+#include <queue>
+#include <string>
+#include <vector>
 
 #include "sdsl/bit_vectors.hpp"
+#include "sdsl/construct_config.hpp"
+#include "sdsl/int_vector_buffer.hpp"
+#include "sdsl/parallel_helper.hpp"
 
 //! Namespace for the succinct data structure library.
 namespace sdsl {
@@ -77,6 +85,173 @@ get_chunk_idx(idx_type v, idx_type u, idx_type c_0, idx_type r_0, size_type l, u
 	return ((v - r_0) / l) * k + (u - c_0) / l;
 }
 
+//! Writes the bits of src to dst starting at bit position pos, 64 bits at a time.
+inline void copy_bits(const bit_vector& src, bit_vector& dst, size_type pos)
+{
+	size_type i = 0;
+	for (; i + 64 <= src.size(); i += 64)
+		dst.set_int(pos + i, src.get_int(i, 64), 64);
+	if (i < src.size()) dst.set_int(pos + i, src.get_int(i, src.size() - i), src.size() - i);
+}
+
+//! Floor of log2(x) for x > 0, usable in constant expressions.
+constexpr uint8_t floor_log2(uint64_t x) { return x <= 1 ? 0 : 1 + floor_log2(x >> 1); }
+
+/*! Z-order code of the cell (row, col) in a k^2-tree of the given height.
+ *
+ * The code has one base k^2 digit ((row / l) % k) * k + (col / l) % k per
+ * level, for l = k^(height-1), ..., k, 1 from the most to the least
+ * significant digit. Sorting the cells by their code lists the nodes of
+ * each level in the order of the tree.
+ *
+ * \pre (k^2)^height <= 2^64, see z_order_fits.
+ */
+inline uint64_t z_order(idx_type row, idx_type col, uint8_t k, uint16_t height)
+{
+	uint64_t code = 0, weight = 1;
+	for (uint16_t h = 0; h < height; ++h) {
+		code += ((row % k) * k + col % k) * weight;
+		row /= k;
+		col /= k;
+		weight *= k * k;
+	}
+	return code;
+}
+
+//! Returns true if the Z-order codes of a k^2-tree of the given height fit in 64 bits.
+inline bool z_order_fits(uint8_t k, uint16_t height)
+{
+	return 2 * height * std::log2(k) <= 64;
+}
+
+//! Collects the bits of one level of a k^2-tree, one block of k^2 bits per node.
+/*! Blocks of at most 64 bits are assembled in a word and written with one
+ *  set_int.
+ */
+class level_writer {
+	bit_vector m_bits;
+	size_type  m_size = 0;
+	size_type  m_block_size;
+	uint64_t   m_block = 0;
+	bool	   m_open  = false;
+
+public:
+	level_writer(size_type block_size) : m_block_size(block_size) {}
+
+	//! Starts the block of the next node; the bits of the previous one are written.
+	void open_block()
+	{
+		close_block();
+		if (m_size + m_block_size > m_bits.size()) {
+			m_bits.resize(std::max(m_size + m_block_size, 2 * m_bits.size()));
+		}
+		m_block = 0;
+		m_open  = true;
+	}
+
+	//! Sets the bit of child i in the current block.
+	void set(size_type i)
+	{
+		if (m_block_size <= 64)
+			m_block |= 1ULL << i;
+		else
+			m_bits[m_size + i] = 1;
+	}
+
+	void close_block()
+	{
+		if (!m_open) return;
+		if (m_block_size <= 64) m_bits.set_int(m_size, m_block, m_block_size);
+		m_size += m_block_size;
+		m_open = false;
+	}
+
+	//! Returns the bits of the level; the writer must not be used afterwards.
+	bit_vector& bits()
+	{
+		close_block();
+		m_bits.resize(m_size);
+		return m_bits;
+	}
+};
+
+/*! Calls f(code) for each distinct Z-order code of the edges (x[i], y[i]) in increasing order.
+ *
+ * The codes are sorted in runs of at most run_size codes with
+ * construct_config().num_threads threads. If there is more than one run,
+ * the runs are stored in temporary files in the directory of tmp_dir_file
+ * and merged. So the memory is bounded by about 8 * run_size bytes.
+ */
+template <class t_f>
+void external_z_sort(int_vector_buffer<>& x,
+					 int_vector_buffer<>& y,
+					 uint8_t			  k,
+					 uint16_t			  height,
+					 size_type			  run_size,
+					 const std::string&   tmp_dir_file,
+					 t_f&&				  f)
+{
+	const size_type		  n = x.size();
+	uint64_t			  num_threads = construct_config().num_threads;
+	std::vector<uint64_t> run;
+	run.reserve(std::min(n, run_size));
+	std::vector<std::string> run_files;
+
+	auto sort_run = [&]() {
+		parallel_sort(run.begin(), run.end(), std::less<uint64_t>(), num_threads);
+		run.erase(std::unique(run.begin(), run.end()), run.end());
+	};
+	x.async_io(construct_config().async_io_depth);
+	y.async_io(construct_config().async_io_depth);
+	for (size_type i = 0; i < n; ++i) {
+		run.push_back(z_order(x[i], y[i], k, height));
+		if (run.size() == run_size and i + 1 < n) {
+			sort_run();
+			run_files.push_back(tmp_file(tmp_dir_file, "_k2_run"));
+			int_vector_buffer<64> out(run_files.back(), std::ios::out);
+			for (auto code : run)
+				out.push_back(code);
+			run.clear();
+		}
+	}
+	sort_run();
+	if (run_files.empty()) {
+		for (auto code : run)
+			f(code);
+		return;
+	}
+
+	// merge the stored runs and the last run, which is still in memory
+	typedef std::pair<uint64_t, size_type> t_head;
+	size_type buffer_bytes = std::max((size_type)8 * 1024, 8 * run_size / (run_files.size() + 1));
+	std::vector<int_vector_buffer<64>> runs;
+	std::vector<size_type>			   pos(run_files.size() + 1, 0);
+	std::priority_queue<t_head, std::vector<t_head>, std::greater<t_head>> heads;
+	for (size_type r = 0; r < run_files.size(); ++r) {
+		runs.emplace_back(run_files[r], std::ios::in, buffer_bytes);
+		heads.emplace(runs[r][0], r);
+	}
+	if (!run.empty()) heads.emplace(run[0], run_files.size());
+	bool	 first = true;
+	uint64_t last  = 0;
+	while (!heads.empty()) {
+		uint64_t  code = heads.top().first;
+		size_type r	= heads.top().second;
+		heads.pop();
+		if (first or code != last) f(code);
+		first = false;
+		last  = code;
+		++pos[r];
+		if (r < runs.size()) {
+			if (pos[r] < runs[r].size()) heads.emplace(runs[r][pos[r]], r);
+		} else if (pos[r] < run.size()) {
+			heads.emplace(run[pos[r]], r);
+		}
+	}
+	for (auto& r : runs)
+		r.close(true);
+}
+
 template <typename t_bv = bit_vector>
 void build_template_vector(bit_vector& k_t_, bit_vector& k_l_, t_bv& k_t, t_bv& k_l)
 {
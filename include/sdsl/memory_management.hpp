@@ -15,6 +15,14 @@
 #include "ram_fs.hpp"
 #include <chrono>
 #include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <streambuf>
+#include <vector>
+#ifndef MSVC_COMPILER
+#include <fcntl.h>
+#include <sys/stat.h>
+#endif
 
 namespace sdsl {
 
@@ -183,6 +191,88 @@ inline void write_mem_log<HTML_FORMAT>(std::ostream& out,const tracker_storage&
     out << create_mem_js_body(json_data.str());
 }
 
+template<>
+inline void write_profile_log<JSON_FORMAT>(std::ostream& out,const tracker_storage& m)
+{
+    using namespace std::chrono;
+    auto events = m.completed_events;
+    std::sort(events.begin(),events.end(),[](const mm_event& a,const mm_event& b) {
+        return a.begin < b.begin or (a.begin == b.begin and a.depth < b.depth);
+    });
+
+    out << "[\n";
+    for (size_t i=0; i<events.size(); i++) {
+        const mm_event& ev = events[i];
+        out << "\t{\n";
+        out << "\t\t\"name\" : \"" << ev.name << "\",\n";
+        out << "\t\t\"depth\" : " << ev.depth << ",\n";
+        out << "\t\t\"start_ms\" : " << duration_cast<milliseconds>(ev.begin-m.start_log).count() << ",\n";
+        out << "\t\t\"wall_ms\" : " << duration_cast<milliseconds>(ev.end-ev.begin).count() << ",\n";
+        out << "\t\t\"cpu_ms\" : " << (uint64_t)ev.cpu_ms << ",\n";
+        out << "\t\t\"bytes_read\" : " << ev.bytes_read << ",\n";
+        out << "\t\t\"bytes_written\" : " << ev.bytes_written << ",\n";
+        out << "\t\t\"peak_bytes\" : " << ev.peak << ",\n";
+        out << "\t\t\"peak_rss_bytes\" : " << ev.peak_rss << "\n";
+        if (i<events.size()-1) {
+            out << "\t},\n";
+        } else {
+            out << "\t}\n";
+        }
+    }
+    out << "]\n";
+}
+
+template<>
+inline void write_profile_log<HTML_FORMAT>(std::ostream& out,const tracker_storage& m)
+{
+    std::stringstream json_data;
+    write_profile_log<JSON_FORMAT>(json_data,m);
+
+    out << "<html>\n<head>\n<meta charset=\"utf-8\">\n"
+        << "<style>\n"
+        << "    body { font: 11px sans-serif; }\n"
+        << "    .bar { position: absolute; height: 18px; overflow: hidden; white-space: nowrap;"
+           " border: 1px solid #555; box-sizing: border-box; padding-left: 2px; }\n"
+        << "    table { border-collapse: collapse; margin-top: 20px; }\n"
+        << "    td, th { border: 1px solid #ccc; padding: 2px 6px; text-align: right; }\n"
+        << "    td:first-child { text-align: left; }\n"
+        << "</style>\n"
+        << "<title>sdsl construction profile</title>\n</head>\n<body>\n"
+        << "<div id=\"timeline\" style=\"position: relative;\"></div>\n"
+        << "<table id=\"phases\"><tr><th>phase</th><th>start (s)</th><th>wall (s)</th>"
+           "<th>cpu (s)</th><th>cpu/wall</th><th>read (MiB)</th><th>written (MiB)</th>"
+           "<th>peak (MiB)</th><th>peak RSS (MiB)</th></tr></table>\n"
+        << "<script>\n"
+        << "var events = " << json_data.str() << ";\n"
+        << "var mib = function (b) { return (b / (1024 * 1024)).toFixed(1); };\n"
+        << "var sec = function (ms) { return (ms / 1000).toFixed(2); };\n"
+        << "var total = Math.max(1, Math.max.apply(null, events.map(function (e) { return e.start_ms + e.wall_ms; })));\n"
+        << "var depth = Math.max.apply(null, events.map(function (e) { return e.depth; }).concat([0]));\n"
+        << "var timeline = document.getElementById(\"timeline\");\n"
+        << "var width = Math.max(400, window.innerWidth - 40);\n"
+        << "timeline.style.height = (depth + 1) * 20 + \"px\";\n"
+        << "var table = document.getElementById(\"phases\");\n"
+        << "events.forEach(function (e, i) {\n"
+        << "  var load = e.wall_ms > 0 ? e.cpu_ms / e.wall_ms : 0;\n"
+        << "  var bar = document.createElement(\"div\");\n"
+        << "  bar.className = \"bar\";\n"
+        << "  bar.style.left = (e.start_ms / total * width) + \"px\";\n"
+        << "  bar.style.width = Math.max(1, e.wall_ms / total * width) + \"px\";\n"
+        << "  bar.style.top = (e.depth * 20) + \"px\";\n"
+        << "  bar.style.background = \"hsl(\" + (120 - 120 * Math.min(1, load)) + \",70%,75%)\";\n"
+        << "  bar.textContent = e.name;\n"
+        << "  bar.title = e.name + \"\\nwall \" + sec(e.wall_ms) + \" s, cpu \" + sec(e.cpu_ms) + \" s\\nread \" +\n"
+        << "    mib(e.bytes_read) + \" MiB, written \" + mib(e.bytes_written) + \" MiB\\npeak \" + mib(e.peak_bytes) + \" MiB\";\n"
+        << "  timeline.appendChild(bar);\n"
+        << "  var row = table.insertRow(-1);\n"
+        << "  [\"\\u00a0\".repeat(2 * e.depth) + e.name, sec(e.start_ms), sec(e.wall_ms), sec(e.cpu_ms), load.toFixed(2),\n"
+        << "   mib(e.bytes_read), mib(e.bytes_written), mib(e.peak_bytes), mib(e.peak_rss_bytes)].forEach(function (v) {\n"
+        << "    row.insertCell(-1).textContent = v;\n"
+        << "  });\n"
+        << "});\n"
+        << "</script>\n</body>\n</html>\n";
+}
+
 #pragma pack(push, 1)
 typedef struct mm_block {
 	size_t			 size;
@@ -699,6 +789,188 @@ public:
 };
 #endif
 
+//! Bookkeeping of the file mappings created by load_mapped.
+/*! Each region is reference counted: the mapped_streambuf which created
+ *  the region holds one reference and every int_vector whose data points
+ *  into the region holds another one. The region is unmapped when the
+ *  last reference is released. An int_vector marks mapped data with a
+ *  flag, so only mapped vectors take the lock of the registry.
+ */
+class mapped_regions {
+private:
+	struct region_type {
+		char*	base;
+		uint64_t len;
+		uint64_t refs;
+	};
+	std::mutex				 m_mtx;
+	std::vector<region_type> m_regions;
+	std::atomic<uint64_t>	m_num_regions{0};
+
+	static mapped_regions& the_regions()
+	{
+		static mapped_regions r;
+		return r;
+	}
+
+	region_type* find(const void* ptr)
+	{
+		for (auto& r : m_regions) {
+			if ((const char*)ptr >= r.base and (const char*)ptr < r.base + r.len) return &r;
+		}
+		return nullptr;
+	}
+
+public:
+	//! Registers the mapping [base, base+len) with one reference.
+	static void add(char* base, uint64_t len)
+	{
+		auto&						m = the_regions();
+		std::lock_guard<std::mutex> lock(m.m_mtx);
+		m.m_regions.push_back({base, len, 1});
+		++m.m_num_regions;
+	}
+
+	//! Number of registered mappings.
+	static uint64_t size() { return the_regions().m_num_regions; }
+
+	//! Returns true if ptr points into a registered mapping.
+	static bool contains(const void* ptr)
+	{
+		auto& m = the_regions();
+		if (ptr == nullptr or m.m_num_regions == 0) return false;
+		std::lock_guard<std::mutex> lock(m.m_mtx);
+		return m.find(ptr) != nullptr;
+	}
+
+	//! Adds a reference to the mapping which contains ptr.
+	static bool acquire(const void* ptr)
+	{
+		auto&						m = the_regions();
+		std::lock_guard<std::mutex> lock(m.m_mtx);
+		region_type*				r = m.find(ptr);
+		if (r == nullptr) return false;
+		++r->refs;
+		return true;
+	}
+
+	//! Removes a reference to the mapping which contains ptr.
+	/*! \returns false if ptr does not point into a registered mapping.
+	 */
+	static bool release(const void* ptr)
+	{
+		auto& m = the_regions();
+		if (ptr == nullptr or m.m_num_regions == 0) return false;
+		std::lock_guard<std::mutex> lock(m.m_mtx);
+		region_type*				r = m.find(ptr);
+		if (r == nullptr) return false;
+		if (--r->refs == 0) {
+#ifndef MSVC_COMPILER
+			munmap(r->base, r->len);
+#endif
+			*r = m.m_regions.back();
+			m.m_regions.pop_back();
+			--m.m_num_regions;
+		}
+		return true;
+	}
+};
+
+//! A stream buffer which reads from a private mapping of a file.
+/*! The file is mapped copy-on-write, i.e. the pages are shared with the
+ *  page cache (and other processes which map the same file) until they are
+ *  written, and the file itself is never modified. The mapping is followed
+ *  by a zero page, so that rank structures can read the word behind the
+ *  last int_vector of the file.
+ *
+ *  If an int_vector is loaded from an std::istream which uses this buffer,
+ *  and its payload starts at an 8-byte aligned position, the vector points
+ *  into the mapping instead of copying the payload (see
+ *  memory_manager::map_data). Other payloads are copied as usual.
+ */
+class mapped_streambuf : public std::streambuf {
+private:
+	char*	m_base = nullptr;
+	uint64_t m_size = 0;
+
+public:
+	explicit mapped_streambuf(const std::string& file)
+	{
+#ifndef MSVC_COMPILER
+		int fd = open(file.c_str(), O_RDONLY);
+		if (fd < 0) return;
+		struct stat st;
+		if (fstat(fd, &st) == 0) {
+			uint64_t page = sysconf(_SC_PAGESIZE);
+			uint64_t len  = ((st.st_size + page - 1) / page + 1) * page;
+			// reserve the address space (including the trailing zero page)
+			void* base = mmap(nullptr, len, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+			if (base != MAP_FAILED and st.st_size > 0) {
+				void* map = mmap(base,
+								 st.st_size,
+								 PROT_READ | PROT_WRITE,
+								 MAP_PRIVATE | MAP_FIXED,
+								 fd,
+								 0);
+				if (map == MAP_FAILED) {
+					munmap(base, len);
+					base = MAP_FAILED;
+				}
+			}
+			if (base != MAP_FAILED) {
+				m_base = (char*)base;
+				m_size = st.st_size;
+				mapped_regions::add(m_base, len);
+				setg(m_base, m_base, m_base + m_size);
+			}
+		}
+		close(fd);
+#else
+		(void)file;
+#endif
+	}
+
+	mapped_streambuf(const mapped_streambuf&) = delete;
+	mapped_streambuf& operator=(const mapped_streambuf&) = delete;
+
+	~mapped_streambuf()
+	{
+		if (m_base != nullptr) mapped_regions::release(m_base);
+	}
+
+	//! Returns true if the file could be mapped.
+	bool is_open() const { return m_base != nullptr; }
+
+	//! Pointer to the next unread byte.
+	const char* current() const { return gptr(); }
+
+	//! Number of unread bytes.
+	uint64_t remaining() const { return egptr() - gptr(); }
+
+	//! Skips the next n bytes.
+	void skip(uint64_t n) { setg(eback(), gptr() + n, egptr()); }
+
+protected:
+	pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which) override
+	{
+		if (!(which & std::ios_base::in)) return pos_type(off_type(-1));
+		off_type pos = off;
+		if (dir == std::ios_base::cur)
+			pos += gptr() - eback();
+		else if (dir == std::ios_base::end)
+			pos += m_size;
+		return seekpos(pos_type(pos), which);
+	}
+
+	pos_type seekpos(pos_type pos, std::ios_base::openmode which) override
+	{
+		if (!(which & std::ios_base::in) or off_type(pos) < 0 or (uint64_t)off_type(pos) > m_size)
+			return pos_type(off_type(-1));
+		setg(eback(), eback() + off_type(pos), egptr());
+		return pos;
+	}
+};
+
 class memory_manager {
 private:
 	bool hugepages = false;
@@ -762,7 +1034,19 @@ public:
 		bool	 do_realloc		   = old_capacity_in_bytes != new_capacity_in_bytes;
 		v.m_capacity      		   = ((capacity + 63) >> 6) << 6; // set new_capacity to a multiple of 64
 
-		if (do_realloc || v.m_data == nullptr) {
+		if (v.m_mapped) {
+			// the data points into a file mapping: copy it to the heap
+			uint64_t* mapped		  = v.m_data;
+			size_t	allocated_bytes = (size_t)(((v.m_capacity + 64) >> 6) << 3);
+			v.m_data				  = memory_manager::alloc_mem(allocated_bytes);
+			if (v.m_data == nullptr) {
+				throw std::bad_alloc();
+			}
+			memcpy(v.m_data, mapped, std::min(old_capacity_in_bytes, new_capacity_in_bytes));
+			mapped_regions::release(mapped);
+			v.m_mapped = false;
+			memory_monitor::record((int64_t)new_capacity_in_bytes);
+		} else if (do_realloc || v.m_data == nullptr) {
 			// Note that we allocate 8 additional bytes if m_capacity % 64 == 0.
 			// We need this padding since rank data structures do a memory
 			// access to this padding to answer rank(size()) if capacity()%64 ==0.
@@ -782,6 +1066,12 @@ public:
 	template <class t_vec>
 	static void clear(t_vec& v)
 	{
+		if (v.m_mapped) {
+			mapped_regions::release(v.m_data);
+			v.m_data   = nullptr;
+			v.m_mapped = false;
+			return;
+		}
 		int64_t size_in_bytes = ((v.m_size + 63) >> 6) << 3;
 		// remove mem
 		memory_manager::free_mem(v.m_data);
@@ -793,6 +1083,44 @@ public:
 		}
 	}
 
+	//! Lets the int_vector v point into the file mapping of in.
+	/*!
+	 * \param v        The int_vector which is loaded.
+	 * \param bit_size Size of the payload of v in bits.
+	 * \param in       Stream which is positioned at the start of the payload.
+	 * \returns true if v was mapped, i.e. in uses a mapped_streambuf and the
+	 *          payload is 8-byte aligned. In this case in is advanced to
+	 *          the end of the payload. Otherwise nothing is changed.
+	 */
+	template <class t_vec>
+	static bool map_data(t_vec& v, const typename t_vec::size_type bit_size, std::istream& in)
+	{
+		mapped_streambuf* buf = dynamic_cast<mapped_streambuf*>(in.rdbuf());
+		if (buf == nullptr) return false;
+		uint64_t bytes = ((bit_size + 63) >> 6) << 3;
+		if (((uintptr_t)buf->current()) % 8 != 0 or bytes > buf->remaining()) return false;
+		if (!mapped_regions::acquire(buf->current())) return false;
+		clear(v);
+		v.m_data	 = (uint64_t*)buf->current();
+		v.m_mapped   = true;
+		v.m_size	 = bit_size;
+		v.m_capacity = bytes << 3;
+		buf->skip(bytes);
+		return true;
+	}
+
+	//! Returns true if ptr points into a mapping created by load_mapped.
+	/*! Takes the lock of the mapping registry; prefer the int_vector overload.
+	 */
+	static bool is_mapped(const void* ptr) { return mapped_regions::contains(ptr); }
+
+	//! Returns true if the data of the int_vector v points into a mapping created by load_mapped.
+	template <class t_vec>
+	static auto is_mapped(const t_vec& v) -> decltype(v.m_mapped)
+	{
+		return v.m_mapped;
+	}
+
 	static int open_file_for_mmap(std::string& filename, std::ios_base::openmode mode)
 	{
 		if (is_ram_file(filename)) {
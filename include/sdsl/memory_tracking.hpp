@@ -18,12 +18,14 @@
 #include <cstdlib>
 #include <mutex>
 #include <chrono>
+#include <ctime>
 #include <cstring>
 #include <set>
 #include <cstddef>
 #include <stack>
 #include <vector>
 #include <atomic>
+#include <new>
 #include "config.hpp"
 #include <fcntl.h>
 #include <sstream>
@@ -36,6 +38,7 @@
 #include <io.h>
 #else
 #include <sys/mman.h>
+#include <sys/resource.h> // for getrusage
 #include <unistd.h> // for getpid, file_size, clock_gettime
 #endif
 
@@ -99,6 +102,10 @@ class spin_lock
                 /* spin */
             }
         };
+        bool try_lock()
+        {
+            return !m_slock.test_and_set(std::memory_order_acquire);
+        };
         void unlock()
         {
             m_slock.clear(std::memory_order_release);
@@ -133,13 +140,44 @@ struct mm_alloc {
     mm_alloc(timer::time_point t, int64_t u) : timestamp(t), usage(u) {};
 };
 
+//! Peak resident set size of the process in bytes; 0 if unknown.
+inline int64_t mm_peak_rss()
+{
+#ifdef MSVC_COMPILER
+    return 0;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+#ifdef __APPLE__
+    return usage.ru_maxrss; // bytes
+#else
+    return usage.ru_maxrss * 1024LL; // kilobytes
+#endif
+#endif
+}
+
 struct mm_event {
     using timer = std::chrono::high_resolution_clock;
     std::string name;
     std::vector<mm_alloc> allocations;
-    mm_event(std::string n, int64_t usage) : name(n)
+    // profile of the event, including its sub-events (see write_profile)
+    timer::time_point begin;   // the timestamps of allocations are moved by record()
+    timer::time_point end;
+    size_t depth = 0;          // number of enclosing events
+    int64_t peak = 0;          // peak of the tracked heap usage
+    int64_t peak_rss = 0;      // peak resident set size of the process at the end
+    std::clock_t cpu_start = 0;
+    double cpu_ms = 0;         // CPU time of all threads of the process
+    uint64_t read_start = 0;
+    uint64_t written_start = 0;
+    uint64_t bytes_read = 0;   // bytes read by int_vector_buffer, int_vector_mapper, load_from_file
+    uint64_t bytes_written = 0;
+    mm_event(std::string n, int64_t usage)
+        : name(n), begin(timer::now()), end(begin), peak(usage), cpu_start(std::clock())
     {
-        allocations.emplace_back(timer::now(), usage);
+        allocations.emplace_back(begin, usage);
     };
     bool operator< (const mm_event& a) const
     {
@@ -154,25 +192,165 @@ struct mm_event {
     }
 };
 
+//! True while the memory_monitor runs.
+/*! A constant-initialized flag, so that it can be tested by the global
+ *  allocator of SDSL_TRACK_ALL_ALLOCATIONS before the monitor exists.
+ */
+inline std::atomic<bool>& mm_tracking()
+{
+    static std::atomic<bool> on{false};
+    return on;
+}
+
+//! True while the calling thread is inside the global allocator of SDSL_TRACK_ALL_ALLOCATIONS
+//! or inside the bookkeeping of the memory_monitor.
+inline bool& mm_in_global_alloc()
+{
+    static thread_local bool in = false;
+    return in;
+}
+
+//! Excludes the allocations of the calling thread from the count while the object lives.
+/*! Used by the memory_monitor, so that its own event stack, timelines
+ *  and logs are not part of the profile.
+ */
+class mm_untracked_scope
+{
+    private:
+        bool m_prev;
+    public:
+        mm_untracked_scope() : m_prev(mm_in_global_alloc())
+        {
+            mm_in_global_alloc() = true;
+        }
+        ~mm_untracked_scope()
+        {
+            mm_in_global_alloc() = m_prev;
+        }
+        mm_untracked_scope(const mm_untracked_scope&) = delete;
+        mm_untracked_scope& operator=(const mm_untracked_scope&) = delete;
+};
+
+//! Index of the counter stripe of the calling thread.
+inline size_t mm_thread_stripe()
+{
+    static std::atomic<size_t> next{0};
+    static thread_local size_t stripe = next.fetch_add(1, std::memory_order_relaxed);
+    return stripe;
+}
+
+//! Bytes allocated by the threads of one stripe but not yet added to the usage.
+struct mm_counter {
+    std::atomic<int64_t> pending{0};
+    char padding[64 - sizeof(std::atomic<int64_t>)]; // one cache line per stripe
+};
+
 struct tracker_storage {
         using timer = std::chrono::high_resolution_clock;
+        static constexpr size_t stripes = 64;
         std::chrono::milliseconds log_granularity = std::chrono::milliseconds(20ULL);
-        int64_t current_usage = 0;
-        bool track_usage = false;
         std::vector<mm_event> completed_events;
         std::stack<mm_event> event_stack;
         timer::time_point start_log;
         timer::time_point last_event;
         spin_lock spinlock;
+        std::atomic<uint64_t> bytes_read{0};
+        std::atomic<uint64_t> bytes_written{0};
+        // Allocations are counted per thread in counters and only moved to
+        // usage when a counter exceeds flush_bytes or at an event boundary.
+        // So the usage seen between boundaries lags behind by less than
+        // stripes * flush_bytes bytes.
+        mm_counter counters[stripes];
+        std::atomic<int64_t> usage{0};
+        std::atomic<int64_t> event_peak{0}; // peak of usage since the last event boundary
+        std::atomic<int64_t> flush_bytes{64 * 1024};
 
         tracker_storage(){ }
 
+        //! Adds delta to the usage, updates event_peak and returns the new usage.
+        int64_t add_usage(int64_t delta)
+        {
+            int64_t cur = usage.fetch_add(delta, std::memory_order_relaxed) + delta;
+            int64_t peak = event_peak.load(std::memory_order_relaxed);
+            while (peak < cur and !event_peak.compare_exchange_weak(peak, cur, std::memory_order_relaxed)) {
+            }
+            return cur;
+        }
+
+        //! Moves the pending bytes of all threads to the usage and returns the exact usage.
+        int64_t aggregate()
+        {
+            int64_t delta = 0;
+            for (auto& c : counters) {
+                delta += c.pending.exchange(0, std::memory_order_relaxed);
+            }
+            return add_usage(delta);
+        }
+
+        //! Adds the usage to the timeline of the top event; call with spinlock held.
+        void sample(int64_t cur_usage)
+        {
+            mm_untracked_scope untracked;
+            auto cur = timer::now();
+            auto& allocations = event_stack.top().allocations;
+            if (last_event + log_granularity < cur) {
+                allocations.emplace_back(cur, allocations.back().usage);
+                allocations.emplace_back(cur, cur_usage);
+                last_event = cur;
+            } else {
+                allocations.back().usage = cur_usage;
+                allocations.back().timestamp = cur;
+            }
+        }
+
+        //! Pushes a new event and takes the start values of its profile.
+        void open_event(const std::string& name)
+        {
+            mm_untracked_scope untracked;
+            int64_t cur_usage = aggregate();
+            if (!event_stack.empty() and event_stack.top().peak < event_peak.load()) {
+                event_stack.top().peak = event_peak.load();
+            }
+            event_stack.emplace(name, cur_usage);
+            event_peak.store(cur_usage);
+            auto& ev = event_stack.top();
+            ev.depth = event_stack.size() - 1;
+            ev.read_start = bytes_read.load();
+            ev.written_start = bytes_written.load();
+        }
+
+        //! Completes the profile of the top event, moves it to completed_events and pops it.
+        void close_event()
+        {
+            mm_untracked_scope untracked;
+            int64_t cur_usage = aggregate();
+            auto& ev = event_stack.top();
+            if (ev.peak < event_peak.load()) {
+                ev.peak = event_peak.load();
+            }
+            ev.end = timer::now();
+            ev.cpu_ms = 1000.0 * (std::clock() - ev.cpu_start) / CLOCKS_PER_SEC;
+            ev.bytes_read = bytes_read.load() - ev.read_start;
+            ev.bytes_written = bytes_written.load() - ev.written_start;
+            ev.peak_rss = mm_peak_rss();
+            int64_t peak = ev.peak;
+            completed_events.emplace_back(std::move(ev));
+            event_stack.pop();
+            if (!event_stack.empty() and event_stack.top().peak < peak) {
+                event_stack.top().peak = peak;
+            }
+            event_peak.store(cur_usage);
+        }
+
         ~tracker_storage(){ }
 };
 
 template<format_type F>
 void write_mem_log(std::ostream& out, const tracker_storage& m);
 
+template<format_type F>
+void write_profile_log(std::ostream& out, const tracker_storage& m);
+
 
 
 class memory_monitor
@@ -183,24 +361,24 @@ class memory_monitor
         struct mm_event_proxy {
             bool add;
             timer::time_point created;
-            mm_event_proxy(const std::string& name, int64_t usage, bool a) : add(a)
+            mm_event_proxy(const std::string& name, bool a) : add(a)
             {
                 if (add) {
                     auto& m = *(the_monitor().m_tracker);
                     std::lock_guard<spin_lock> lock(m.spinlock);
-                    m.event_stack.emplace(name, usage);
+                    m.open_event(name);
                 }
             }
             ~mm_event_proxy()
             {
                 if (add) {
+                    mm_untracked_scope untracked;
                     auto& m = *(the_monitor().m_tracker);
                     std::lock_guard<spin_lock> lock(m.spinlock);
                     auto& cur = m.event_stack.top();
                     auto cur_time = timer::now();
-                    cur.allocations.emplace_back(cur_time, m.current_usage);
-                    m.completed_events.emplace_back(std::move(cur));
-                    m.event_stack.pop();
+                    cur.allocations.emplace_back(cur_time, m.aggregate());
+                    m.close_event();
                     // add a point to the new "top" with the same memory
                     // as before but just ahead in time
                     if (!m.event_stack.empty()) {
@@ -227,7 +405,7 @@ class memory_monitor
 
         ~memory_monitor()
         {
-            if (m_tracker->track_usage) {
+            if (mm_tracking().load()) {
                 stop();
             }
             delete m_ram_fs;
@@ -248,15 +426,22 @@ class memory_monitor
             auto& m = *(the_monitor().m_tracker);
             m.log_granularity = ms;
         }
+        //! Sets the number of bytes a thread may allocate before they are added to the usage.
+        /*! Larger values reduce the contention between threads, 0 makes the
+         *  timeline exact.
+         */
+        static void flush_threshold(int64_t bytes)
+        {
+            auto& m = *(the_monitor().m_tracker);
+            m.flush_bytes = bytes;
+        }
         static int64_t peak()
         {
             auto& m = *(the_monitor().m_tracker);
             int64_t max = 0;
-            for (auto events : m.completed_events) {
-                for (auto alloc : events.allocations) {
-                    if (max < alloc.usage) {
-                        max = alloc.usage;
-                    }
+            for (const auto& event : m.completed_events) {
+                if (max < event.peak) {
+                    max = event.peak;
                 }
             }
             return max;
@@ -268,70 +453,186 @@ class memory_monitor
 
         static void start()
         {
+            mm_untracked_scope untracked;
             auto& m = *(the_monitor().m_tracker);
-            m.track_usage = true;
-            // clear if there is something there
-            if (m.completed_events.size()) {
-                m.completed_events.clear();
-            }
-            while (m.event_stack.size()) {
-                m.event_stack.pop();
+            {
+                std::lock_guard<spin_lock> lock(m.spinlock);
+                // clear if there is something there
+                if (m.completed_events.size()) {
+                    m.completed_events.clear();
+                }
+                while (m.event_stack.size()) {
+                    m.event_stack.pop();
+                }
+                m.start_log = timer::now();
+                for (auto& c : m.counters) {
+                    c.pending = 0;
+                }
+                m.usage = 0;
+                m.event_peak = 0;
+                m.last_event = m.start_log;
+                m.open_event("unknown");
             }
-            m.start_log = timer::now();
-            m.current_usage = 0;
-            m.last_event = m.start_log;
-            m.event_stack.emplace("unknown", 0);
+            mm_tracking() = true;
         }
         static void stop()
         {
             auto& m = *(the_monitor().m_tracker);
+            std::lock_guard<spin_lock> lock(m.spinlock);
             while (!m.event_stack.empty()) {
-                m.completed_events.emplace_back(std::move(m.event_stack.top()));
-                m.event_stack.pop();
+                m.close_event();
             }
-            m.track_usage = false;
+            mm_tracking() = false;
         }
+        //! Counts delta bytes for the calling thread.
+        /*! Takes no lock; the timeline is only sampled when the pending
+         *  bytes of the thread exceed the flush threshold and no other
+         *  thread holds the lock.
+         */
         static void record(int64_t delta)
         {
+            if (!mm_tracking().load(std::memory_order_relaxed)) {
+                return;
+            }
             auto& m = *(the_monitor().m_tracker);
-            if (m.track_usage) {
-                std::lock_guard<spin_lock> lock(m.spinlock);
-                auto cur = timer::now();
-                if (m.last_event + m.log_granularity < cur) {
-                    m.event_stack.top().allocations.emplace_back(cur, m.current_usage);
-                    m.current_usage = m.current_usage + delta;
-                    m.event_stack.top().allocations.emplace_back(cur, m.current_usage);
-                    m.last_event = cur;
-                } else {
-                    if (m.event_stack.top().allocations.size()) {
-                        m.current_usage = m.current_usage + delta;
-                        m.event_stack.top().allocations.back().usage = m.current_usage;
-                        m.event_stack.top().allocations.back().timestamp = cur;
+            auto& c = m.counters[mm_thread_stripe() % tracker_storage::stripes];
+            int64_t pending = c.pending.fetch_add(delta, std::memory_order_relaxed) + delta;
+            int64_t flush = m.flush_bytes.load(std::memory_order_relaxed);
+            if (pending >= flush or pending <= -flush) {
+                int64_t cur_usage = m.add_usage(c.pending.exchange(0, std::memory_order_relaxed));
+                if (m.spinlock.try_lock()) {
+                    if (!m.event_stack.empty()) {
+                        m.sample(cur_usage);
                     }
+                    m.spinlock.unlock();
                 }
             }
         }
 
-        static mm_event_proxy event(const std::string& name)
+        //! Counts bytes which are read from or written to files while the monitor runs.
+        /*! Negative values (e.g. a failed tellg) are ignored.
+         */
+        static void record_io(int64_t read, int64_t written)
         {
             auto& m = *(the_monitor().m_tracker);
-            if (m.track_usage) {
-                return mm_event_proxy(name, m.current_usage, true);
+            if (mm_tracking().load(std::memory_order_relaxed)) {
+                if (read > 0) m.bytes_read.fetch_add(read, std::memory_order_relaxed);
+                if (written > 0) m.bytes_written.fetch_add(written, std::memory_order_relaxed);
             }
-            return mm_event_proxy(name, m.current_usage, false);
+        }
+
+        static mm_event_proxy event(const std::string& name)
+        {
+            return mm_event_proxy(name, mm_tracking().load());
         }
 
         template<format_type F>
         static void write_memory_log(std::ostream& out)
         {
+            mm_untracked_scope untracked;
             write_mem_log<F>(out, *(the_monitor().m_tracker));
         }
+
+        //! Writes wall time, CPU time, bytes of I/O and peak memory of each event.
+        /*! JSON_FORMAT writes one object per event, HTML_FORMAT a timeline
+         *  of the events. Values of an event include its sub-events.
+         */
+        template<format_type F>
+        static void write_profile(std::ostream& out)
+        {
+            mm_untracked_scope untracked;
+            write_profile_log<F>(out, *(the_monitor().m_tracker));
+        }
 };
 
 inline void memory_monitor_record(int64_t delta) {
     memory_monitor::record(delta);
 }
 
+//! Header in front of each block of the global allocator; 16 bytes keep the alignment of malloc.
+struct mm_block_header {
+    uint64_t size;
+    uint64_t tracked; // the block was counted by the memory_monitor
+};
+
+//! Allocates n bytes and counts them for the current event if the monitor runs.
+/*! Allocations made by the monitor itself, for its events, timelines
+ *  and logs (see mm_untracked_scope), are not counted.
+ */
+inline void* mm_global_alloc(std::size_t n) noexcept
+{
+    void* p = std::malloc(n + sizeof(mm_block_header));
+    if (p == nullptr) {
+        return nullptr;
+    }
+    auto header = static_cast<mm_block_header*>(p);
+    header->size = n;
+    header->tracked = false;
+    if (mm_tracking().load(std::memory_order_relaxed) and !mm_in_global_alloc()) {
+        mm_in_global_alloc() = true;
+        memory_monitor::record((int64_t)n);
+        mm_in_global_alloc() = false;
+        header->tracked = true;
+    }
+    return header + 1;
+}
+
+inline void mm_global_free(void* p) noexcept
+{
+    if (p == nullptr) {
+        return;
+    }
+    auto header = static_cast<mm_block_header*>(p) - 1;
+    if (header->tracked and mm_tracking().load(std::memory_order_relaxed) and !mm_in_global_alloc()) {
+        mm_in_global_alloc() = true;
+        memory_monitor::record(-(int64_t)header->size);
+        mm_in_global_alloc() = false;
+    }
+    std::free(header);
+}
+
+inline void* mm_global_new(std::size_t n)
+{
+    void* p = mm_global_alloc(n);
+    while (p == nullptr) {
+        std::new_handler handler = std::get_new_handler();
+        if (handler == nullptr) {
+            throw std::bad_alloc();
+        }
+        handler();
+        p = mm_global_alloc(n);
+    }
+    return p;
+}
+
 } // end namespace
 
+//! Replaces the global operator new and delete, so that the memory_monitor counts all heap usage.
+/*! By default only int_vectors and containers with a track_allocator are
+ *  counted. Expand the macro once, at namespace scope of one translation
+ *  unit of the program:
+ *  \code
+ *  SDSL_TRACK_ALL_ALLOCATIONS()
+ *  int main() { sdsl::memory_monitor::start(); ... }
+ *  \endcode
+ *  Memory of malloc is not seen, so int_vectors are not counted twice.
+ */
+#define SDSL_TRACK_ALL_ALLOCATIONS()                                                                   \
+    void* operator new(std::size_t n) { return sdsl::mm_global_new(n); }                             \
+    void* operator new[](std::size_t n) { return sdsl::mm_global_new(n); }                           \
+    void* operator new(std::size_t n, const std::nothrow_t&) noexcept                                \
+    {                                                                                                 \
+        return sdsl::mm_global_alloc(n);                                                              \
+    }                                                                                                 \
+    void* operator new[](std::size_t n, const std::nothrow_t&) noexcept                              \
+    {                                                                                                 \
+        return sdsl::mm_global_alloc(n);                                                              \
+    }                                                                                                 \
+    void operator delete(void* p) noexcept { sdsl::mm_global_free(p); }                              \
+    void operator delete[](void* p) noexcept { sdsl::mm_global_free(p); }                            \
+    void operator delete(void* p, std::size_t) noexcept { sdsl::mm_global_free(p); }                 \
+    void operator delete[](void* p, std::size_t) noexcept { sdsl::mm_global_free(p); }               \
+    void operator delete(void* p, const std::nothrow_t&) noexcept { sdsl::mm_global_free(p); }       \
+    void operator delete[](void* p, const std::nothrow_t&) noexcept { sdsl::mm_global_free(p); }
+
 #endif
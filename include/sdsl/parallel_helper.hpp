@@ -0,0 +1,153 @@
+// Copyright (c) 2016, the SDSL Project Authors.  All rights reserved.
+// Please see the AUTHORS file for details.  Use of this source code is governed
+// by a BSD license that can be found in the LICENSE file.
+/*! \file parallel_helper.hpp
+    \brief parallel_helper.hpp contains small building blocks to distribute
+           work of construction algorithms over several threads.
+*/
+#ifndef INCLUDED_SDSL_PARALLEL_HELPER
+#define INCLUDED_SDSL_PARALLEL_HELPER
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+namespace sdsl {
+
+//! Number of threads which should be used for a task of size n.
+/*! Small tasks are not worth the overhead of spawning threads.
+ * \param n           Number of elements which will be processed.
+ * \param num_threads Number of threads requested by the caller.
+ * \param min_block   Minimal number of elements per thread.
+ */
+inline uint64_t parallel_threads(uint64_t n, uint64_t num_threads, uint64_t min_block = 1 << 16)
+{
+	if (num_threads == 0) num_threads = 1;
+	return std::max((uint64_t)1, std::min(num_threads, n / std::max((uint64_t)1, min_block)));
+}
+
+//! ORs the len lowest bits of x into a bit array at bit position pos.
+/*! This is used if several threads fill disjoint bit ranges of the same
+ *  zero-initialized array. Words at the border of the range of the calling
+ *  thread may also contain bits of other threads and are updated atomically.
+ * \param data      Pointer to the words of the array.
+ * \param pos       Bit position of the lowest bit of x.
+ * \param x         Value; only the len lowest bits may be set.
+ * \param len       Number of bits of x, at most 64.
+ * \param shared_lo Index of the word which contains the first bit of the range.
+ * \param shared_hi Index of the word which contains the last bit of the range.
+ */
+inline void parallel_or_bits(
+uint64_t* data, uint64_t pos, uint64_t x, uint8_t len, uint64_t shared_lo, uint64_t shared_hi)
+{
+	auto or_word = [&](uint64_t w, uint64_t bits) {
+		if (bits == 0) return;
+		if (w == shared_lo or w == shared_hi) {
+			__atomic_fetch_or(data + w, bits, __ATOMIC_RELAXED);
+		} else {
+			data[w] |= bits;
+		}
+	};
+	uint64_t w   = pos >> 6;
+	uint8_t  off = pos & 0x3F;
+	or_word(w, x << off);
+	if (off + len > 64) {
+		or_word(w + 1, x >> (64 - off));
+	}
+}
+
+//! Splits [0,n) into num_threads consecutive blocks and processes them concurrently.
+/*!
+ * \param n           Size of the range.
+ * \param num_threads Number of threads (and blocks).
+ * \param f           Functor called as f(thread_id, begin, end).
+ * \param align       All block borders (except n) are multiples of align.
+ *                    This is useful if neighbouring elements share a word of
+ *                    a bit-compressed int_vector.
+ */
+template <class t_f>
+void parallel_for_blocks(uint64_t n, uint64_t num_threads, t_f&& f, uint64_t align = 1)
+{
+	if (num_threads <= 1 or n <= align) {
+		f((uint64_t)0, (uint64_t)0, n);
+		return;
+	}
+	uint64_t block = (n + num_threads - 1) / num_threads;
+	block		   = ((block + align - 1) / align) * align;
+	std::vector<std::thread> threads;
+	for (uint64_t t = 1; t < num_threads and t * block < n; ++t) {
+		threads.emplace_back(
+		[&f, t, block, n]() { f(t, t * block, std::min(n, (t + 1) * block)); });
+	}
+	f((uint64_t)0, (uint64_t)0, std::min(n, block));
+	for (auto& th : threads)
+		th.join();
+}
+
+//! Processes the tasks 0,...,n-1 concurrently with dynamic load balancing.
+/*!
+ * \param n           Number of tasks.
+ * \param num_threads Number of threads.
+ * \param f           Functor called as f(thread_id, task) for each task.
+ */
+template <class t_f>
+void parallel_for_each(uint64_t n, uint64_t num_threads, t_f&& f)
+{
+	if (num_threads <= 1 or n <= 1) {
+		for (uint64_t i = 0; i < n; ++i)
+			f((uint64_t)0, i);
+		return;
+	}
+	std::atomic<uint64_t> next(0);
+	auto worker = [&f, &next, n](uint64_t t) {
+		for (uint64_t i = next++; i < n; i = next++) {
+			f(t, i);
+		}
+	};
+	std::vector<std::thread> threads;
+	for (uint64_t t = 1; t < std::min(num_threads, n); ++t) {
+		threads.emplace_back(worker, t);
+	}
+	worker(0);
+	for (auto& th : threads)
+		th.join();
+}
+
+//! Sorts [begin,end) with num_threads threads.
+/*! The range is split into blocks which are sorted concurrently and
+ *  afterwards merged pairwise. The sort is not stable.
+ */
+template <class t_it, class t_cmp>
+void parallel_sort(t_it begin, t_it end, t_cmp cmp, uint64_t num_threads)
+{
+	uint64_t n	= end - begin;
+	num_threads = parallel_threads(n, num_threads, 1 << 14);
+	if (num_threads <= 1) {
+		std::sort(begin, end, cmp);
+		return;
+	}
+	std::vector<uint64_t> borders(num_threads + 1);
+	for (uint64_t t = 0; t <= num_threads; ++t) {
+		borders[t] = (n * t) / num_threads;
+	}
+	parallel_for_each(num_threads, num_threads, [&](uint64_t, uint64_t t) {
+		std::sort(begin + borders[t], begin + borders[t + 1], cmp);
+	});
+	for (uint64_t step = 1; step < num_threads; step *= 2) {
+		uint64_t merges = (num_threads + 2 * step - 1) / (2 * step);
+		parallel_for_each(merges, num_threads, [&](uint64_t, uint64_t m) {
+			uint64_t l = 2 * step * m;
+			if (l + step < num_threads) {
+				uint64_t r = std::min(num_threads, l + 2 * step);
+				std::inplace_merge(
+				begin + borders[l], begin + borders[l + step], begin + borders[r], cmp);
+			}
+		});
+	}
+}
+
+} // end namespace sdsl
+
+#endif
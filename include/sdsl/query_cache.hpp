@@ -0,0 +1,351 @@
+// Copyright (c) 2016, the SDSL Project Authors.  All rights reserved.
+// Please see the AUTHORS file for details.  Use of this source code is governed
+// by a BSD license that can be found in the LICENSE file.
+/*! \file query_cache.hpp
+    \brief query_cache.hpp contains a cache for answers of expensive queries,
+           which is safe under concurrent const access.
+*/
+#ifndef INCLUDED_SDSL_QUERY_CACHE
+#define INCLUDED_SDSL_QUERY_CACHE
+
+#include "bits.hpp"
+#include <atomic>
+#include <cstdint>
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace sdsl {
+
+//! Hit and miss counters of a query_cache.
+struct query_cache_stats {
+	uint64_t hits   = 0;
+	uint64_t misses = 0;
+};
+
+//! A direct-mapped cache which maps 64-bit keys to 64-bit answers.
+/*!
+ * Data structures like bp_support_sada and csa_wt hold a mutable
+ * query_cache and answer repeated queries from it. The policy and the
+ * capacity are chosen at runtime with configure():
+ *  - disabled:   lookup() always misses and store() does nothing. This is
+ *                the default, so a structure costs only a few words.
+ *  - per_thread: each thread uses a private table, which is allocated at
+ *                its first access. Threads never share entries. The tables
+ *                of all threads are owned by the cache and freed by
+ *                configure() and the destructor; the table of a thread is
+ *                also freed when the thread exits.
+ *  - shared:     one table for all threads. Each slot is protected by a
+ *                sequence counter (a seqlock): a writer increments it to an
+ *                odd value, writes key and answer and increments it again.
+ *                A reader only accepts an entry if it read the same even
+ *                counter before and after the entry. Writers do not wait
+ *                for each other; a writer which finds a slot locked drops
+ *                its entry.
+ *
+ * All policies are safe under concurrent const queries. configure() and
+ * reset_stats() must not be called concurrently with queries.
+ *
+ * Hits and misses are counted in 16 cache line sized stripes, one per
+ * group of threads, so counting does not serialize the threads.
+ *
+ * A copy has the same policy and capacity as the original but starts
+ * empty and with zero counters.
+ */
+class query_cache {
+public:
+	typedef uint64_t size_type;
+	enum policy_type { disabled = 0, per_thread = 1, shared = 2 };
+
+private:
+	struct entry_type {
+		uint64_t key   = (uint64_t)-1;
+		uint64_t value = 0;
+	};
+
+	struct slot_type {
+		std::atomic<uint64_t> seq{0};
+		std::atomic<uint64_t> key{(uint64_t)-1};
+		std::atomic<uint64_t> value{0};
+		uint64_t			  padding; // 4 slots per cache line
+	};
+
+	struct counter_type {
+		std::atomic<uint64_t> hits{0};
+		std::atomic<uint64_t> misses{0};
+		uint64_t			  padding[6]; // one counter per cache line
+	};
+
+	enum { stripes = 16 };
+
+	//! A table of the per_thread policy; counts its bytes in table_bytes().
+	struct table_type {
+		std::unique_ptr<entry_type[]> entries;
+		size_type					  bytes;
+
+		explicit table_type(size_type size)
+			: entries(new entry_type[size]), bytes(size * sizeof(entry_type))
+		{
+			table_bytes().fetch_add(bytes, std::memory_order_relaxed);
+		}
+		~table_type() { table_bytes().fetch_sub(bytes, std::memory_order_relaxed); }
+	};
+
+	//! The tables of the per_thread policy of one cache, owned by the cache.
+	struct registry_type {
+		std::mutex								 mtx;
+		std::vector<std::unique_ptr<table_type>> tables;
+
+		//! Frees table, if it was not freed yet.
+		void release(entry_type* table)
+		{
+			std::lock_guard<std::mutex> lock(mtx);
+			auto it = std::find_if(
+			tables.begin(), tables.end(), [table](const std::unique_ptr<table_type>& t) {
+				return t->entries.get() == table;
+			});
+			if (it != tables.end()) {
+				*it = std::move(tables.back());
+				tables.pop_back();
+			}
+		}
+	};
+
+	//! A table of the calling thread and the registry of the cache which owns it.
+	struct thread_table_type {
+		std::weak_ptr<registry_type> owner;
+		entry_type*					 table;
+	};
+
+	//! The tables of the calling thread. Entries of freed caches are removed at the next
+	//! allocation; the tables of live caches are freed at the exit of the thread.
+	struct thread_tables_type {
+		std::unordered_map<uint64_t, thread_table_type> tables;
+		uint64_t										memo_id[4]	= {0, 0, 0, 0};
+		entry_type*										memo_table[4] = {nullptr, nullptr, nullptr, nullptr};
+
+		~thread_tables_type()
+		{
+			for (auto& t : tables) {
+				if (auto owner = t.second.owner.lock()) owner->release(t.second.table);
+			}
+		}
+	};
+
+	policy_type					  m_policy   = disabled;
+	uint8_t						  m_log_size = 0;
+	uint64_t					  m_id		 = 0; // identifies the tables of the per_thread policy
+	std::shared_ptr<registry_type>  m_registry;
+	std::unique_ptr<slot_type[]>	m_slots;
+	std::unique_ptr<counter_type[]> m_counters;
+
+	static thread_tables_type& thread_tables()
+	{
+		static thread_local thread_tables_type t;
+		return t;
+	}
+
+	static std::atomic<size_type>& table_bytes()
+	{
+		static std::atomic<size_type> bytes{0};
+		return bytes;
+	}
+
+	static uint64_t new_id()
+	{
+		static std::atomic<uint64_t> next{1};
+		return next.fetch_add(1);
+	}
+
+	static size_type stripe()
+	{
+		static std::atomic<uint64_t> next{0};
+		static thread_local size_type s = next.fetch_add(1) % stripes;
+		return s;
+	}
+
+	size_type index(uint64_t key) const
+	{
+		return (key * 0x9E3779B97F4A7C15ULL) >> (64 - m_log_size);
+	}
+
+	//! Returns the table of the calling thread.
+	entry_type* thread_table() const
+	{
+		thread_tables_type& t = thread_tables();
+		size_type			m = m_id & 3;
+		if (t.memo_id[m] != m_id) {
+			auto it = t.tables.find(m_id);
+			if (it == t.tables.end()) {
+				// drop the entries of freed caches, whose ids are never used again
+				for (auto j = t.tables.begin(); j != t.tables.end();) {
+					if (j->second.owner.expired())
+						j = t.tables.erase(j);
+					else
+						++j;
+				}
+				std::unique_ptr<table_type> table(new table_type(1ULL << m_log_size));
+				it = t.tables.emplace(m_id, thread_table_type{m_registry, table->entries.get()}).first;
+				std::lock_guard<std::mutex> lock(m_registry->mtx);
+				m_registry->tables.push_back(std::move(table));
+			}
+			t.memo_id[m]	= m_id;
+			t.memo_table[m] = it->second.table;
+		}
+		return t.memo_table[m];
+	}
+
+	void count(bool hit) const
+	{
+		counter_type& c = m_counters[stripe()];
+		if (hit)
+			c.hits.fetch_add(1, std::memory_order_relaxed);
+		else
+			c.misses.fetch_add(1, std::memory_order_relaxed);
+	}
+
+public:
+	query_cache() = default;
+
+	//! Creates a cache with the given policy and at least capacity entries.
+	query_cache(policy_type policy, size_type capacity) { configure(policy, capacity); }
+
+	query_cache(const query_cache& c) { configure(c.policy(), c.capacity()); }
+
+	query_cache(query_cache&& c) { *this = std::move(c); }
+
+	query_cache& operator=(const query_cache& c)
+	{
+		if (this != &c) configure(c.policy(), c.capacity());
+		return *this;
+	}
+
+	query_cache& operator=(query_cache&& c)
+	{
+		if (this != &c) {
+			m_policy   = c.m_policy;
+			m_log_size = c.m_log_size;
+			m_id	   = c.m_id;
+			m_registry = std::move(c.m_registry);
+			m_slots	= std::move(c.m_slots);
+			m_counters = std::move(c.m_counters);
+			c.m_policy = disabled;
+			c.m_id	 = 0;
+		}
+		return *this;
+	}
+
+	//! Sets the policy and the capacity; the capacity is rounded up to a power of two.
+	/*! All cached entries and the counters are dropped, the tables of all
+	 *  threads are freed. A capacity of 0 disables the cache.
+	 */
+	void configure(policy_type policy, size_type capacity)
+	{
+		m_registry.reset();
+		m_slots.reset();
+		m_counters.reset();
+		m_policy   = (capacity == 0) ? disabled : policy;
+		m_log_size = 0;
+		m_id	   = 0;
+		if (m_policy == disabled) return;
+		m_log_size = capacity > 1 ? bits::hi(capacity - 1) + 1 : 1;
+		m_counters.reset(new counter_type[stripes]);
+		if (m_policy == shared) {
+			m_slots.reset(new slot_type[1ULL << m_log_size]);
+		} else {
+			m_id	   = new_id();
+			m_registry = std::make_shared<registry_type>();
+		}
+	}
+
+	policy_type policy() const { return m_policy; }
+
+	//! Number of entries of the table (per thread for the per_thread policy).
+	size_type capacity() const { return m_policy == disabled ? 0 : 1ULL << m_log_size; }
+
+	bool enabled() const { return m_policy != disabled; }
+
+	//! Bytes of the per_thread tables of all caches, which are currently allocated.
+	static size_type thread_table_bytes() { return table_bytes().load(std::memory_order_relaxed); }
+
+	//! Looks up the answer for key.
+	/*! \param key   The key; (uint64_t)-1 is reserved.
+	 *  \param value Receives the answer if the key is cached.
+	 *  \returns true if the key is cached.
+	 */
+	bool lookup(uint64_t key, uint64_t& value) const
+	{
+		if (m_policy == disabled) return false;
+		bool hit = false;
+		if (m_policy == per_thread) {
+			const entry_type& e = thread_table()[index(key)];
+			if (e.key == key) {
+				value = e.value;
+				hit   = true;
+			}
+		} else {
+			const slot_type& s  = m_slots[index(key)];
+			uint64_t		 s1 = s.seq.load(std::memory_order_acquire);
+			if (!(s1 & 1)) {
+				uint64_t k = s.key.load(std::memory_order_relaxed);
+				uint64_t v = s.value.load(std::memory_order_relaxed);
+				std::atomic_thread_fence(std::memory_order_acquire);
+				if (k == key and s.seq.load(std::memory_order_relaxed) == s1) {
+					value = v;
+					hit   = true;
+				}
+			}
+		}
+		count(hit);
+		return hit;
+	}
+
+	//! Stores the answer for key.
+	void store(uint64_t key, uint64_t value) const
+	{
+		if (m_policy == disabled) return;
+		if (m_policy == per_thread) {
+			entry_type& e = thread_table()[index(key)];
+			e.key		  = key;
+			e.value		  = value;
+		} else {
+			slot_type& s  = m_slots[index(key)];
+			uint64_t   s1 = s.seq.load(std::memory_order_relaxed);
+			if ((s1 & 1) or
+				!s.seq.compare_exchange_strong(s1, s1 + 1, std::memory_order_acquire)) {
+				return; // another thread writes this slot
+			}
+			std::atomic_thread_fence(std::memory_order_release);
+			s.key.store(key, std::memory_order_relaxed);
+			s.value.store(value, std::memory_order_relaxed);
+			s.seq.store(s1 + 2, std::memory_order_release);
+		}
+	}
+
+	//! Returns the sum of the hit and miss counters of all threads.
+	query_cache_stats stats() const
+	{
+		query_cache_stats res;
+		if (!m_counters) return res;
+		for (size_type i = 0; i < stripes; ++i) {
+			res.hits += m_counters[i].hits.load(std::memory_order_relaxed);
+			res.misses += m_counters[i].misses.load(std::memory_order_relaxed);
+		}
+		return res;
+	}
+
+	void reset_stats()
+	{
+		if (!m_counters) return;
+		for (size_type i = 0; i < stripes; ++i) {
+			m_counters[i].hits.store(0, std::memory_order_relaxed);
+			m_counters[i].misses.store(0, std::memory_order_relaxed);
+		}
+	}
+};
+
+} // end namespace sdsl
+
+#endif
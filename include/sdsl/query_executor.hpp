@@ -0,0 +1,164 @@
+// Copyright (c) 2016, the SDSL Project Authors.  All rights reserved.
+// Please see the AUTHORS file for details.  Use of this source code is governed
+// by a BSD license that can be found in the LICENSE file.
+/*! \file query_executor.hpp
+    \brief query_executor.hpp contains a class which answers batches of
+           count, locate and extract queries on a shared CSA or CST with
+           several threads.
+*/
+#ifndef INCLUDED_SDSL_QUERY_EXECUTOR
+#define INCLUDED_SDSL_QUERY_EXECUTOR
+
+#include "int_vector.hpp"
+#include "sdsl_concepts.hpp"
+#include "suffix_arrays.hpp"
+#include "work_stealing_pool.hpp"
+#include <array>
+#include <type_traits>
+#include <vector>
+
+namespace sdsl {
+
+template <class t_csx>
+const t_csx& _query_csa(const t_csx& csx, csa_tag)
+{
+	return csx;
+}
+
+template <class t_csx>
+const typename t_csx::csa_type& _query_csa(const t_csx& csx, cst_tag)
+{
+	return csx.csa;
+}
+
+//! Answers batches of queries on a read-only CSA or CST with several threads.
+/*!
+ * The executor owns a work_stealing_pool and shares one index between all
+ * threads. Each query of a batch is an independent task; the results are
+ * returned in the order of the input.
+ *
+ * \tparam t_csx A CSA or CST type.
+ *
+ * \par Thread safety
+ * The queries only call const methods of the index. This is safe for all
+ * CSA types of the library (csa_bitcompressed, csa_sada, csa_wt), i.e.
+ * the const methods of these classes do not modify shared state:
+ * csa_sada decodes \f$\Psi\f$ values into a thread local buffer and the
+ * wavelet trees, rank/select supports and sampling classes of csa_wt
+ * are immutable after construction. For a CST the queries are answered
+ * by its CSA (cst.csa), so they are safe as well. The query_cache of
+ * csa_wt and bp_support_sada is safe under concurrent queries with all
+ * of its policies, but must be configured before the batch starts. Note
+ * that iterators (e.g. the cst_dfs_const_forward_iterator) hold mutable
+ * state and must not be shared between threads.
+ *
+ * The index must not be modified (loaded, swapped, ...) while a batch is
+ * processed.
+ *
+ * \par Example
+ * \code
+ * csa_wt<> csa;
+ * construct(csa, "file.txt", 1);
+ * query_executor<csa_wt<>> exec(csa, 8);
+ * std::vector<std::string> patterns = {"abra", "cad"};
+ * auto counts = exec.count(patterns);
+ * \endcode
+ */
+template <class t_csx>
+class query_executor {
+public:
+	typedef typename t_csx::size_type	size_type;
+	typedef typename t_csx::string_type string_type;
+	typedef int_vector<64>				 occ_type;
+
+private:
+	const t_csx&	   m_csx;
+	work_stealing_pool m_pool;
+	size_type		   m_grain;
+
+	auto csa() const -> decltype(_query_csa(m_csx, typename t_csx::index_category()))
+	{
+		return _query_csa(m_csx, typename t_csx::index_category());
+	}
+
+public:
+	//! Constructor
+	/*!
+	 * \param csx         The index. It has to outlive the executor.
+	 * \param num_threads Number of threads. 0 means std::thread::hardware_concurrency().
+	 * \param grain       Number of consecutive queries which are scheduled as one
+	 *                    chunk. Larger values reduce scheduling overhead for
+	 *                    cheap queries like count.
+	 */
+	query_executor(const t_csx& csx, size_type num_threads = 0, size_type grain = 16)
+		: m_csx(csx), m_pool(num_threads), m_grain(grain)
+	{
+	}
+
+	//! Number of threads used.
+	size_type threads() const { return m_pool.size(); }
+
+	//! Counts the occurrences of each pattern.
+	/*!
+	 * \param patterns Random access container of patterns (e.g. std::vector<std::string>).
+	 * \return res[k] = count(csx, patterns[k]).
+	 */
+	template <class t_pat_vec>
+	std::vector<size_type> count(const t_pat_vec& patterns)
+	{
+		std::vector<size_type> res(patterns.size());
+		m_pool.parallel_for(patterns.size(),
+							[&](size_type, size_type k) {
+								res[k] = sdsl::count(csa(), patterns[k].begin(), patterns[k].end());
+							},
+							m_grain);
+		return res;
+	}
+
+	//! Calculates the occurrences of each pattern.
+	/*!
+	 * \param patterns Random access container of patterns.
+	 * \return res[k] contains the text positions of patterns[k] (in SA order).
+	 */
+	template <class t_pat_vec>
+	std::vector<occ_type> locate(const t_pat_vec& patterns)
+	{
+		std::vector<occ_type> res(patterns.size());
+		m_pool.parallel_for(patterns.size(),
+							[&](size_type, size_type k) {
+								res[k] = sdsl::locate(csa(), patterns[k].begin(), patterns[k].end());
+							},
+							m_grain);
+		return res;
+	}
+
+	//! Extracts text substrings.
+	/*!
+	 * \param ranges ranges[k] = {begin, end} specifies T[begin..end] (inclusive).
+	 * \return res[k] contains T[ranges[k][0]..ranges[k][1]].
+	 * \pre \f$ begin \leq end < size \f$ for all ranges.
+	 */
+	std::vector<string_type> extract(const std::vector<std::array<size_type, 2>>& ranges)
+	{
+		std::vector<string_type> res(ranges.size());
+		m_pool.parallel_for(
+		ranges.size(),
+		[&](size_type, size_type k) { res[k] = sdsl::extract(csa(), ranges[k][0], ranges[k][1]); },
+		m_grain);
+		return res;
+	}
+
+	//! Calls f(thread_id, csx, k) for k in [0,n) with all threads.
+	/*! This allows to run other read-only queries, e.g. with per-thread
+	 *  buffers addressed by thread_id in [0, threads()).
+	 */
+	template <class t_f>
+	void for_each(size_type n, t_f&& f)
+	{
+		m_pool.parallel_for(n, [&](size_type t, size_type k) { f(t, m_csx, k); }, m_grain);
+	}
+};
+
+} // end namespace sdsl
+
+#endif
@@ -13,6 +13,7 @@
  */
 
 #include "int_vector.hpp"
+#include "simd_popcount.hpp"
 
 //! Namespace for the succinct data structure library.
 namespace sdsl {
@@ -67,8 +68,39 @@ public:
 
 inline rank_support::rank_support(const bit_vector* v) { m_v = v; }
 
+template <class t_rank>
+auto _prefetch_rank(const t_rank& rs, uint64_t idx, int) -> decltype(rs.prefetch(idx), void())
+{
+	rs.prefetch(idx);
+}
+
+template <class t_rank>
+void _prefetch_rank(const t_rank&, uint64_t, long)
+{
+}
+
+//! Prefetches the memory needed by rs.rank(idx).
+/*! Only rank supports which provide a `prefetch(idx)` method issue
+ *  prefetches, for all others this is a no-op.
+ */
+template <class t_rank>
+void prefetch_rank(const t_rank& rs, uint64_t idx)
+{
+	_prefetch_rank(rs, idx, 0);
+}
+
 //----------------------------------------------------------------------
 
+// sums t_trait::full_word_rank over words data[0..words-1], for patterns without a SIMD kernel
+template <class t_trait>
+typename t_trait::size_type _full_words_rank(const uint64_t* data, typename t_trait::size_type words)
+{
+	typename t_trait::size_type res = 0;
+	for (typename t_trait::size_type i = 0; i < words; ++i)
+		res += t_trait::full_word_rank(data, i << 6);
+	return res;
+}
+
 template <uint8_t bit_pattern, uint8_t pattern_len>
 struct rank_support_trait {
 	typedef rank_support::size_type size_type;
@@ -79,6 +111,8 @@ struct rank_support_trait {
 
 	static uint32_t full_word_rank(const uint64_t*, size_type) { return 0; }
 
+	static size_type full_words_rank(const uint64_t*, size_type) { return 0; }
+
 	static uint64_t init_carry() { return 0; }
 };
 
@@ -98,6 +132,11 @@ struct rank_support_trait<0, 1> {
 		return bits::cnt((~*(data + (idx >> 6))));
 	}
 
+	static size_type full_words_rank(const uint64_t* data, size_type words)
+	{
+		return simd_popcount::zero_words(data, words);
+	}
+
 	static uint64_t init_carry() { return 0; }
 };
 
@@ -117,6 +156,11 @@ struct rank_support_trait<1, 1> {
 		return bits::cnt(*(data + (idx >> 6)));
 	}
 
+	static size_type full_words_rank(const uint64_t* data, size_type words)
+	{
+		return simd_popcount::words(data, words);
+	}
+
 	static uint64_t init_carry() { return 0; }
 };
 
@@ -140,6 +184,11 @@ struct rank_support_trait<10, 2> {
 		return bits::cnt(bits::map10(*data, carry));
 	}
 
+	static size_type full_words_rank(const uint64_t* data, size_type words)
+	{
+		return _full_words_rank<rank_support_trait>(data, words);
+	}
+
 	static uint64_t init_carry() { return 0; }
 };
 
@@ -163,6 +212,11 @@ struct rank_support_trait<01, 2> {
 		return bits::cnt(bits::map01(*data, carry));
 	}
 
+	static size_type full_words_rank(const uint64_t* data, size_type words)
+	{
+		return _full_words_rank<rank_support_trait>(data, words);
+	}
+
 	static uint64_t init_carry() { return 1; }
 };
 
@@ -191,6 +245,11 @@ struct rank_support_trait<00, 2> {
 		return bits::cnt(~(*data | ((*data) << 1 | carry)));
 	}
 
+	static size_type full_words_rank(const uint64_t* data, size_type words)
+	{
+		return _full_words_rank<rank_support_trait>(data, words);
+	}
+
 	static uint64_t init_carry() { return 1; }
 };
 
@@ -219,6 +278,11 @@ struct rank_support_trait<11, 2> {
 		return bits::cnt(*data & ((*data) << 1 | carry));
 	}
 
+	static size_type full_words_rank(const uint64_t* data, size_type words)
+	{
+		return _full_words_rank<rank_support_trait>(data, words);
+	}
+
 	static uint64_t init_carry() { return 0; }
 };
 
@@ -60,14 +60,10 @@ rank_support_scan<t_b, t_pat_len>::rank(size_type idx) const
 {
 	assert(m_v != nullptr);
 	assert(idx <= m_v->size());
-	const uint64_t* p	  = m_v->data();
-	size_type		i	  = 0;
-	size_type		result = 0;
-	while (i + 64 <= idx) {
-		result += rank_support_trait<t_b, t_pat_len>::full_word_rank(p, i);
-		i += 64;
-	}
-	return result + rank_support_trait<t_b, t_pat_len>::word_rank(p, idx);
+	const uint64_t* p = m_v->data();
+	// full words are counted blockwise, for single bit patterns with simd_popcount
+	return rank_support_trait<t_b, t_pat_len>::full_words_rank(p, idx >> 6) +
+		   rank_support_trait<t_b, t_pat_len>::word_rank(p, idx);
 }
 
 } // end namespace sds
@@ -116,6 +116,13 @@ public:
 
 	inline size_type operator()(size_type idx) const { return rank(idx); }
 
+	//! Prefetches the counters and the bit vector word needed by rank(idx).
+	void prefetch(size_type idx) const
+	{
+		SDSL_PREFETCH(m_basic_block.data() + ((idx >> 8) & 0xFFFFFFFFFFFFFFFEULL));
+		SDSL_PREFETCH(m_v->data() + (idx >> 6));
+	}
+
 	size_type size() const { return m_v->size(); }
 
 	size_type
@@ -51,6 +51,35 @@ private:
 	//      basic block for interleaved storage of superblockrank and blockrank
 	int_vector<64> m_basic_block;
 
+	//! Fills m_basic_block by counting each 6x64bit block with trait_type::full_words_rank.
+	/*! Only valid for patterns of length 1, since blocks are counted
+	 *  independently of the carry of the preceding block.
+	 */
+	void init_blockwise()
+	{
+		const uint64_t* data  = m_v->data();
+		size_type		words = (m_v->bit_size() + 63) >> 6;
+		uint64_t		cum   = 0;
+		size_type		j	 = 0;
+		for (size_type sb = 0; sb < words; sb += 32, j += 2) {
+			size_type m		 = std::min((size_type)32, words - sb); // words in the superblock
+			uint64_t  second_level_cnt = 0, sum = 0;
+			size_type b		 = 1;
+			for (; 6 * b <= m; ++b) {
+				sum += trait_type::full_words_rank(data + sb + 6 * (b - 1), 6);
+				second_level_cnt |= sum << (60 - 12 * b); //  48, 36, 24, 12, 0
+			}
+			sum += trait_type::full_words_rank(data + sb + 6 * (b - 1), m - 6 * (b - 1));
+			m_basic_block[j]	 = cum;
+			m_basic_block[j + 1] = second_level_cnt;
+			cum += sum;
+		}
+		if (words % 32 == 0) {
+			m_basic_block[j]	 = cum;
+			m_basic_block[j + 1] = 0;
+		}
+	}
+
 public:
 	explicit rank_support_v5(const bit_vector* v = nullptr)
 	{
@@ -64,6 +93,10 @@ public:
 		size_type basic_block_size = (((v->bit_size() + 63) >> 11) + 1) << 1;
 		m_basic_block.resize(basic_block_size); // resize structure for basic_blocks
 		if (m_basic_block.empty()) return;
+		if (t_pat_len == 1) {
+			init_blockwise();
+			return;
+		}
 		const uint64_t* data = m_v->data();
 		size_type		i, j = 0;
 		m_basic_block[0] = m_basic_block[1] = 0;
@@ -124,6 +157,13 @@ public:
 	}
 
 	inline size_type operator()(size_type idx) const { return rank(idx); }
+
+	//! Prefetches the counters and the bit vector word needed by rank(idx).
+	void prefetch(size_type idx) const
+	{
+		SDSL_PREFETCH(m_basic_block.data() + ((idx >> 10) & 0xFFFFFFFFFFFFFFFEULL));
+		SDSL_PREFETCH(m_v->data() + (idx >> 6));
+	}
 	size_type							  size() const { return m_v->size(); }
 
 	size_type
@@ -41,5 +41,6 @@ struct min_max_trait<RandomAccessContainer, false> {
 #include "rmq_support_sparse_table.hpp"
 #include "rmq_succinct_sct.hpp"
 #include "rmq_succinct_sada.hpp"
+#include "rmq_support_block.hpp"
 
 #endif
@@ -0,0 +1,475 @@
+// Copyright (c) 2016, the SDSL Project Authors.  All rights reserved.
+// Please see the AUTHORS file for details.  Use of this source code is governed
+// by a BSD license that can be found in the LICENSE file.
+/*! \file rmq_support_block.hpp
+    \brief rmq_support_block.hpp contains the class rmq_support_block, a
+           cache-friendly two-level range minimum support.
+*/
+#ifndef INCLUDED_SDSL_RMQ_SUPPORT_BLOCK
+#define INCLUDED_SDSL_RMQ_SUPPORT_BLOCK
+
+#include "rmq_support.hpp"
+#include "int_vector.hpp"
+#include "cpu_features.hpp"
+#include <algorithm>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#ifdef SDSL_CPU_DISPATCH
+#include <immintrin.h>
+#endif
+
+//! Namespace for the succinct data structure library.
+namespace sdsl {
+
+template <class t_rac = int_vector<>, bool t_min = true, uint32_t t_bs = 64>
+class rmq_support_block;
+
+template <class t_rac = int_vector<>, uint32_t t_bs = 64>
+using range_maximum_support_block = rmq_support_block<t_rac, false, t_bs>;
+
+//! A range minimum/maximum support which scans blocks of a private copy of the values.
+/*!
+ * The values are copied into an array of 8, 16, 32 or 64-bit integers (the
+ * smallest width which fits the maximum), which starts at a 64-byte aligned
+ * address. For range maximum queries the complement of each value is stored,
+ * so both variants search the leftmost minimum. The array is divided into
+ * blocks of t_bs values. A sparse table over the blocks stores for each
+ * range of 2^k blocks the minimum and its position, so queries which span
+ * whole blocks read two independent pairs of entries.
+ *
+ * A query [l..r] inside one block is a scan of r-l+1 consecutive values. A
+ * query which spans several blocks scans the suffix of the block of l and
+ * the prefix of the block of r, and reads two sparse table entries for the
+ * blocks in between. The scans use AVX2 (vpminu + vpcmpeq) if the CPU
+ * supports it, so a query usually touches the two or three cache lines
+ * around l and r plus a few words of the block tables, while the queries of
+ * rmq_succinct_sct and rmq_succinct_sada are a chain of dependent
+ * bp_support operations. rmq_batch() prefetches these lines for a group of
+ * queries before it answers them.
+ *
+ * Unlike the other RMQ classes, the structure does not need the supported
+ * container after the construction.
+ *
+ * \tparam t_rac Type of random access container for which the structure should be build.
+ * \tparam t_min Specifies whether the data structure should answer range min/max queries (mimumum=true)
+ * \tparam t_bs  Number of values per block, a power of two in [16..256].
+ *
+ * \par Time complexity
+ *      \f$ \Order{t_{bs}} \f$ for the range minimum/maximum queries.
+ * \par Space complexity:
+ *      \f$ nw + \frac{n}{t_{bs}}\log\frac{n}{t_{bs}}(w+\log t_{bs}+\frac{1}{2}\log\frac{n}{t_{bs}}) \f$
+ *      bits, where \f$ w \in \{8,16,32,64\} \f$ is the width of the copied values.
+ */
+template <class t_rac, bool t_min, uint32_t t_bs>
+class rmq_support_block {
+	static_assert(t_bs >= 16 and t_bs <= 256 and (t_bs & (t_bs - 1)) == 0,
+				  "rmq_support_block: t_bs has to be a power of two in [16..256].");
+
+public:
+	typedef typename t_rac::size_type size_type;
+	typedef typename t_rac::size_type value_type;
+
+	enum { block_size = t_bs };
+
+private:
+	enum { prefetch_distance = 8 }; // queries between the prefetch and the evaluation in rmq_batch
+
+	size_type				  m_size   = 0; //!< Number of values
+	uint8_t					  m_width  = 8; //!< Width of the copied values in bits
+	size_type				  m_offset = 0; //!< Position of the first value in m_data (in words)
+	int_vector<64>			  m_data;	   //!< Copied values plus padding for the alignment
+	std::vector<int_vector<>> m_min; //!< m_min[k][j]: Minimum of the blocks [j..j+2^k-1]
+	std::vector<int_vector<>> m_arg; //!< m_arg[k][j]: Position of m_min[k][j] relative to block j
+
+	template <class T>
+	const T* values() const
+	{
+		return (const T*)(m_data.data() + m_offset);
+	}
+
+	size_type data_words() const { return (m_size * m_width + 63) / 64; }
+
+	//! Moves the values to the first 64-byte aligned position of m_data.
+	void align()
+	{
+		if (m_data.empty()) return;
+		size_type offset = ((64 - ((uintptr_t)m_data.data() & 63)) & 63) / 8;
+		if (offset != m_offset) {
+			if (memory_manager::is_mapped(m_data)) { // mappings are read-only
+				int_vector<64> tmp(m_data);
+				m_data = std::move(tmp);
+				align();
+				return;
+			}
+			memmove(m_data.data() + offset, m_data.data() + m_offset, data_words() * sizeof(uint64_t));
+			m_offset = offset;
+		}
+	}
+
+	//! Position of the leftmost minimum in p[0..n-1].
+	template <class T>
+	static size_type argmin(const T* p, size_type n)
+	{
+#ifdef SDSL_CPU_DISPATCH
+		if (sizeof(T) < 8 and n >= 32 / sizeof(T) and cpu_features::avx2) return argmin_avx2(p, n);
+#endif
+		return argmin_scalar(p, n);
+	}
+
+	template <class T>
+	static size_type argmin_scalar(const T* p, size_type n)
+	{
+		size_type res = 0;
+		T		  m   = p[0];
+		for (size_type i = 1; i < n; ++i) { // written to compile to cmov
+			bool less = p[i] < m;
+			m		  = less ? p[i] : m;
+			res		  = less ? i : res;
+		}
+		return res;
+	}
+
+#ifdef SDSL_CPU_DISPATCH
+	__attribute__((target("avx2"))) static __m256i vmin(__m256i a, __m256i b, uint8_t)
+	{
+		return _mm256_min_epu8(a, b);
+	}
+	__attribute__((target("avx2"))) static __m256i vmin(__m256i a, __m256i b, uint16_t)
+	{
+		return _mm256_min_epu16(a, b);
+	}
+	__attribute__((target("avx2"))) static __m256i vmin(__m256i a, __m256i b, uint32_t)
+	{
+		return _mm256_min_epu32(a, b);
+	}
+	__attribute__((target("avx2"))) static __m256i vmin(__m256i a, __m256i, uint64_t)
+	{
+		return a; // never called, argmin() uses the scalar loop for 64-bit values
+	}
+	__attribute__((target("avx2"))) static __m256i vset(uint8_t x) { return _mm256_set1_epi8(x); }
+	__attribute__((target("avx2"))) static __m256i vset(uint16_t x) { return _mm256_set1_epi16(x); }
+	__attribute__((target("avx2"))) static __m256i vset(uint32_t x) { return _mm256_set1_epi32(x); }
+	__attribute__((target("avx2"))) static __m256i vset(uint64_t x) { return _mm256_set1_epi64x(x); }
+	__attribute__((target("avx2"))) static __m256i vcmpeq(__m256i a, __m256i b, uint8_t)
+	{
+		return _mm256_cmpeq_epi8(a, b);
+	}
+	__attribute__((target("avx2"))) static __m256i vcmpeq(__m256i a, __m256i b, uint16_t)
+	{
+		return _mm256_cmpeq_epi16(a, b);
+	}
+	__attribute__((target("avx2"))) static __m256i vcmpeq(__m256i a, __m256i b, uint32_t)
+	{
+		return _mm256_cmpeq_epi32(a, b);
+	}
+	__attribute__((target("avx2"))) static __m256i vcmpeq(__m256i a, __m256i b, uint64_t)
+	{
+		return _mm256_cmpeq_epi64(a, b);
+	}
+
+	__attribute__((target("avx2"))) static __m256i vadd(__m256i a, __m256i b, uint8_t)
+	{
+		return _mm256_add_epi8(a, b);
+	}
+	__attribute__((target("avx2"))) static __m256i vadd(__m256i a, __m256i b, uint16_t)
+	{
+		return _mm256_add_epi16(a, b);
+	}
+	__attribute__((target("avx2"))) static __m256i vadd(__m256i a, __m256i b, uint32_t)
+	{
+		return _mm256_add_epi32(a, b);
+	}
+	__attribute__((target("avx2"))) static __m256i vadd(__m256i a, __m256i b, uint64_t)
+	{
+		return _mm256_add_epi64(a, b);
+	}
+
+	//! Minimum of the lanes of m.
+	template <class T>
+	__attribute__((target("avx2"))) static T hmin(__m256i m)
+	{
+		m = vmin(m, _mm256_permute2x128_si256(m, m, 1), T());
+		m = vmin(m, _mm256_srli_si256(m, 8), T());
+		m = vmin(m, _mm256_srli_si256(m, 4), T());
+		if (sizeof(T) <= 2) m = vmin(m, _mm256_srli_si256(m, 2), T());
+		if (sizeof(T) == 1) m = vmin(m, _mm256_srli_si256(m, 1), T());
+		return (T)_mm256_cvtsi256_si32(m);
+	}
+
+	//! Leftmost minimum of p[0..n-1] with vpminu.
+	/*! Each lane keeps its minimum and the position of the minimum, so the
+	 *  scan has no data dependent branch. The positions are stored in
+	 *  lanes of type T, which is possible since n <= t_bs <= 256.
+	 *  \pre n >= 32/sizeof(T). The last vector overlaps the previous one
+	 *        instead of reading behind p[n-1].
+	 */
+	template <class T>
+	__attribute__((target("avx2"))) static size_type argmin_avx2(const T* p, size_type n)
+	{
+		const size_type lanes = 32 / sizeof(T);
+		T				first[32 / sizeof(T)];
+		for (size_type i = 0; i < lanes; ++i)
+			first[i] = i;
+		const __m256i iota = _mm256_loadu_si256((const __m256i*)first);
+		const __m256i step = vset((T)lanes);
+		__m256i		  m	= _mm256_loadu_si256((const __m256i*)p);
+		__m256i		  arg  = iota, pos = iota;
+		size_type	 i	= lanes;
+		for (; i + lanes <= n; i += lanes) {
+			pos		  = vadd(pos, step, T());
+			__m256i x = vmin(m, _mm256_loadu_si256((const __m256i*)(p + i)), T());
+			arg		  = _mm256_blendv_epi8(pos, arg, vcmpeq(x, m, T())); // keep arg unless x < m
+			m		  = x;
+		}
+		if (i < n) {
+			pos		  = vadd(vset((T)(n - lanes)), iota, T());
+			__m256i x = vmin(m, _mm256_loadu_si256((const __m256i*)(p + n - lanes)), T());
+			arg		  = _mm256_blendv_epi8(pos, arg, vcmpeq(x, m, T()));
+			m		  = x;
+		}
+		// smallest position of the lanes which hold the minimum
+		__m256i is_min = vcmpeq(m, vset(hmin<T>(m)), T());
+		return hmin<T>(_mm256_blendv_epi8(vset((T)~0ULL), arg, is_min));
+	}
+#endif
+
+	//! Position of the leftmost minimum in the blocks [x..y].
+	/*! The four table entries do not depend on each other, so their
+	 *  cache misses overlap.
+	 */
+	size_type min_blocks(size_type x, size_type y, uint64_t& min_val) const
+	{
+		uint8_t			k = bits::hi(y - x + 1);
+		size_type		b = y + 1 - (1ULL << k);
+		const uint64_t  a_min = m_min[k][x], b_min = m_min[k][b];
+		const size_type a_pos = x * t_bs + m_arg[k][x], b_pos = b * t_bs + m_arg[k][b];
+		min_val				  = std::min(a_min, b_min);
+		return a_min <= b_min ? a_pos : b_pos;
+	}
+
+	template <class T>
+	size_type query(const T* p, size_type l, size_type r) const
+	{
+		size_type bl = l / t_bs, br = r / t_bs;
+		if (bl == br) return l + argmin(p + l, r - l + 1);
+		size_type res  = l + argmin(p + l, (bl + 1) * t_bs - l);
+		size_type r_res = br * t_bs + argmin(p + br * t_bs, r - br * t_bs + 1);
+		if (bl + 1 < br) {
+			uint64_t  min_val;
+			size_type pos = min_blocks(bl + 1, br - 1, min_val);
+			if (min_val < p[res]) res = pos;
+		}
+		return p[r_res] < p[res] ? r_res : res;
+	}
+
+	template <class T>
+	static void prefetch_lines(const T* b, const T* e)
+	{
+		for (uintptr_t a = (uintptr_t)b & ~(uintptr_t)63; a <= (uintptr_t)e; a += 64)
+			SDSL_PREFETCH(a);
+	}
+
+	//! Prefetches the values scanned by query(p, l, r) and the table entries it reads.
+	template <class T>
+	void prefetch_query(const T* p, size_type l, size_type r) const
+	{
+		size_type bl = l / t_bs, br = r / t_bs;
+		if (bl == br) {
+			prefetch_lines(p + l, p + r);
+			return;
+		}
+		prefetch_lines(p + l, p + (bl + 1) * t_bs - 1);
+		prefetch_lines(p + br * t_bs, p + r);
+		if (bl + 1 < br) {
+			size_type   x = bl + 1, y = br - 1;
+			uint8_t		k = bits::hi(y - x + 1);
+			size_type   b = y + 1 - (1ULL << k);
+			const auto &mins = m_min[k], &args = m_arg[k];
+			SDSL_PREFETCH(mins.data() + ((x * mins.width()) >> 6));
+			SDSL_PREFETCH(mins.data() + ((b * mins.width()) >> 6));
+			SDSL_PREFETCH(args.data() + ((x * args.width()) >> 6));
+			SDSL_PREFETCH(args.data() + ((b * args.width()) >> 6));
+		}
+	}
+
+	template <class T>
+	void batch_query(const T* p, const std::pair<size_type, size_type>* q, size_type n,
+					 size_type* out) const
+	{
+		for (size_type k = 0; k < std::min(n, (size_type)prefetch_distance); ++k)
+			prefetch_query(p, q[k].first, q[k].second);
+		for (size_type k = 0; k < n; ++k) {
+			if (k + prefetch_distance < n)
+				prefetch_query(p, q[k + prefetch_distance].first, q[k + prefetch_distance].second);
+			out[k] = query(p, q[k].first, q[k].second);
+		}
+	}
+
+	template <class T>
+	void build(const t_rac* v, uint64_t max_val)
+	{
+		T* p = (T*)(m_data.data() + m_offset);
+		for (size_type i = 0; i < m_size; ++i)
+			p[i] = t_min ? (*v)[i] : max_val - (*v)[i];
+		size_type blocks = (m_size + t_bs - 1) / t_bs;
+		m_min.assign(1, int_vector<>(blocks, 0, m_width));
+		m_arg.assign(1, int_vector<>(blocks, 0, bits::hi(t_bs)));
+		for (size_type b = 0; b < blocks; ++b) {
+			size_type j = argmin_scalar(p + b * t_bs, std::min((size_type)t_bs, m_size - b * t_bs));
+			m_min[0][b] = p[b * t_bs + j];
+			m_arg[0][b] = j;
+		}
+		for (size_type k = 1; (1ULL << k) <= blocks; ++k) {
+			size_type h = 1ULL << (k - 1);
+			m_min.emplace_back(blocks - 2 * h + 1, 0, m_width);
+			m_arg.emplace_back(blocks - 2 * h + 1, 0, k + bits::hi(t_bs));
+			for (size_type j = 0; j < m_min[k].size(); ++j) {
+				bool left	= m_min[k - 1][j] <= m_min[k - 1][j + h];
+				m_min[k][j] = left ? m_min[k - 1][j] : m_min[k - 1][j + h];
+				m_arg[k][j] = left ? m_arg[k - 1][j] : h * t_bs + m_arg[k - 1][j + h];
+			}
+		}
+	}
+
+public:
+	rmq_support_block(const t_rac* v = nullptr)
+	{
+		if (v == nullptr or v->size() == 0) return;
+		m_size			= v->size();
+		uint64_t max_val = 0;
+		for (size_type i = 0; i < m_size; ++i)
+			max_val = std::max(max_val, (uint64_t)(*v)[i]);
+		uint8_t w = bits::hi(max_val) + 1;
+		m_width   = w <= 8 ? 8 : w <= 16 ? 16 : w <= 32 ? 32 : 64;
+		m_data	= int_vector<64>(data_words() + 7, 0);
+		m_offset  = ((64 - ((uintptr_t)m_data.data() & 63)) & 63) / 8;
+		max_val	= bits::lo_set[m_width];
+		switch (m_width) {
+			case 8: build<uint8_t>(v, max_val); break;
+			case 16: build<uint16_t>(v, max_val); break;
+			case 32: build<uint32_t>(v, max_val); break;
+			default: build<uint64_t>(v, max_val);
+		}
+	}
+
+	rmq_support_block(const rmq_support_block& rm)
+		: m_size(rm.m_size)
+		, m_width(rm.m_width)
+		, m_offset(rm.m_offset)
+		, m_data(rm.m_data)
+		, m_min(rm.m_min)
+		, m_arg(rm.m_arg)
+	{
+		align();
+	}
+
+	rmq_support_block(rmq_support_block&& rm) = default;
+
+	rmq_support_block& operator=(const rmq_support_block& rm)
+	{
+		if (this != &rm) {
+			rmq_support_block tmp(rm);
+			*this = std::move(tmp);
+		}
+		return *this;
+	}
+
+	rmq_support_block& operator=(rmq_support_block&& rm) = default;
+
+	//! The values are copied during the construction, so the container is not needed.
+	void set_vector(const t_rac*) {}
+
+	//! Range minimum/maximum query for the supported random access container v.
+	/*!
+         * \param l Leftmost position of the interval \f$[\ell..r]\f$.
+         * \param r Rightmost position of the interval \f$[\ell..r]\f$.
+         * \return The minimal index i with \f$\ell \leq i \leq r\f$ for which \f$ v[i] \f$ is minimal/maximal.
+         * \pre
+         *   - r < size()
+         *   - \f$ \ell \leq r \f$
+         * \par Time complexity
+         *      \f$ \Order{t_{bs}} \f$
+         */
+	size_type operator()(const size_type l, const size_type r) const
+	{
+		assert(l <= r);
+		assert(r < size());
+		switch (m_width) {
+			case 8: return query(values<uint8_t>(), l, r);
+			case 16: return query(values<uint16_t>(), l, r);
+			case 32: return query(values<uint32_t>(), l, r);
+			default: return query(values<uint64_t>(), l, r);
+		}
+	}
+
+	//! Answers n range minimum/maximum queries.
+	/*!
+         * \param q   Array of n intervals \f$[\ell..r]\f$.
+         * \param n   Number of queries.
+         * \param out Array of size n, out[k] is set to the result of (*this)(q[k].first, q[k].second).
+         *
+         * The lines which are read by a group of queries are prefetched
+         * before the group is answered, so the cache misses of independent
+         * queries overlap.
+         */
+	void rmq_batch(const std::pair<size_type, size_type>* q, size_type n, size_type* out) const
+	{
+		switch (m_width) {
+			case 8: batch_query(values<uint8_t>(), q, n, out); break;
+			case 16: batch_query(values<uint16_t>(), q, n, out); break;
+			case 32: batch_query(values<uint32_t>(), q, n, out); break;
+			default: batch_query(values<uint64_t>(), q, n, out);
+		}
+	}
+
+	size_type size() const { return m_size; }
+
+	size_type
+	serialize(std::ostream& out, structure_tree_node* v = nullptr, std::string name = "") const
+	{
+		structure_tree_node* child = structure_tree::add_child(v, name, util::class_name(*this));
+		size_type			 written_bytes = 0;
+		written_bytes += write_member(m_size, out, child, "size");
+		written_bytes += write_member(m_width, out, child, "width");
+		written_bytes += write_member((size_type)0, out, child, "offset");
+		if (0 == m_offset) {
+			written_bytes += m_data.serialize(out, child, "data");
+		} else {
+			int_vector<64> data(m_data.size(), 0);
+			std::copy(m_data.begin() + m_offset, m_data.begin() + m_offset + data_words(),
+					  data.begin());
+			written_bytes += data.serialize(out, child, "data");
+		}
+		size_type levels = m_min.size();
+		written_bytes += write_member(levels, out, child, "levels");
+		for (size_type k = 0; k < levels; ++k) {
+			written_bytes += m_min[k].serialize(out, child, "min");
+			written_bytes += m_arg[k].serialize(out, child, "arg");
+		}
+		structure_tree::add_size(child, written_bytes);
+		return written_bytes;
+	}
+
+	void load(std::istream& in, const t_rac* v = nullptr)
+	{
+		set_vector(v);
+		read_member(m_size, in);
+		read_member(m_width, in);
+		read_member(m_offset, in);
+		m_data.load(in);
+		size_type levels = 0;
+		read_member(levels, in);
+		m_min.resize(levels);
+		m_arg.resize(levels);
+		for (size_type k = 0; k < levels; ++k) {
+			m_min[k].load(in);
+			m_arg[k].load(in);
+		}
+		align();
+	}
+};
+
+} // end namespace sdsl
+#endif
@@ -146,7 +146,30 @@ public:
         return *this;
     }
 
-	std::streampos tellp();
+	std::streampos tellp()
+    {
+        ios_base::iostate err = std::ios_base::iostate(ios_base::goodbit);
+        pos_type		  p   = pos_type(off_type(-1));
+        try {
+            if (!this->fail()) {
+                if (is_ram_file(m_file)) {
+                    p = ((ram_filebuf*)m_streambuf)
+                        ->pubseekoff(0, std::ios_base::cur, std::ios_base::out);
+                } else {
+                    p = ((std::filebuf*)m_streambuf)
+                        ->pubseekoff(0, std::ios_base::cur, std::ios_base::out);
+                }
+                if (p == pos_type(off_type(-1))) {
+                    err |= ios_base::failbit;
+                }
+            }
+        } catch (...) {
+            if (err) {
+                this->setstate(err);
+            }
+        }
+        return p;
+    }
 };
 
 
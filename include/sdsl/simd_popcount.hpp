@@ -0,0 +1,196 @@
+// Copyright (c) 2016, the SDSL Project Authors.  All rights reserved.
+// Please see the AUTHORS file for details.  Use of this source code is governed
+// by a BSD license that can be found in the LICENSE file.
+/*! \file simd_popcount.hpp
+    \brief simd_popcount.hpp contains vectorized kernels which count the
+           1-bits in a block of 64-bit words.
+*/
+#ifndef INCLUDED_SDSL_SIMD_POPCOUNT
+#define INCLUDED_SDSL_SIMD_POPCOUNT
+
+#include "bits.hpp"
+#include "cpu_features.hpp"
+#include <cstdint>
+
+#ifdef SDSL_CPU_DISPATCH
+#include <immintrin.h>
+#endif
+
+namespace sdsl {
+
+//! Counts the 1-bits of a block of 64-bit words with the fastest kernel of the CPU.
+/*!
+ * Three kernels are available:
+ *  - scalar: one bits::cnt per word.
+ *  - avx2:   Harley-Seal carry-save adder over 16 256-bit vectors, where
+ *            each vector is counted with a nibble lookup (vpshufb).
+ *  - avx512: vpopcntq on 512-bit vectors with masked loads for the tail.
+ *
+ * The kernel is selected at runtime with the flags of cpu_features, so
+ * the SIMD kernels are used even if the library is compiled for a
+ * baseline x86-64 target. words() uses the scalar loop for blocks which
+ * are too small for the selected kernel (see min_words()): a masked
+ * vpopcntq is already faster for a 6-word block, while the Harley-Seal
+ * kernel needs about 16 words to amortize its setup.
+ */
+class simd_popcount {
+public:
+	enum kernel_type { scalar = 0, avx2 = 1, avx512 = 2 };
+
+	simd_popcount() = delete;
+
+	//! Counts the 1-bits in p[0..n-1].
+	static uint64_t words(const uint64_t* p, uint64_t n)
+	{
+		if (n < min_words()) return words_scalar(p, n);
+		return function(best_kernel())(p, n);
+	}
+
+	//! Counts the 1-bits in p[0..n-1] with the given kernel.
+	/*! \pre supported(kernel)
+	 */
+	static uint64_t words(kernel_type kernel, const uint64_t* p, uint64_t n)
+	{
+		return function(kernel)(p, n);
+	}
+
+	//! Counts the 0-bits in p[0..n-1].
+	static uint64_t zero_words(const uint64_t* p, uint64_t n) { return 64 * n - words(p, n); }
+
+	//! Returns true if the CPU supports the kernel.
+	static bool supported(kernel_type kernel)
+	{
+		if (kernel == avx2) return cpu_features::avx2;
+		if (kernel == avx512) return cpu_features::avx512_vpopcntdq;
+		return true;
+	}
+
+	//! The kernel used by words(p, n).
+	static kernel_type best_kernel()
+	{
+		return supported(avx512) ? avx512 : supported(avx2) ? avx2 : scalar;
+	}
+
+	//! Smallest block size in words for which words(p, n) uses the selected kernel.
+	static uint64_t min_words()
+	{
+		return supported(avx512) ? 4 : supported(avx2) ? 16 : 0;
+	}
+
+	//! Name of a kernel.
+	static const char* name(kernel_type kernel)
+	{
+		return kernel == avx512 ? "avx512" : kernel == avx2 ? "avx2" : "scalar";
+	}
+
+private:
+	typedef uint64_t (*function_type)(const uint64_t*, uint64_t);
+
+	static function_type function(kernel_type kernel)
+	{
+#ifdef SDSL_CPU_DISPATCH
+		if (kernel == avx512) return &words_avx512;
+		if (kernel == avx2) return &words_avx2;
+#endif
+		(void)kernel;
+		return &words_scalar;
+	}
+
+	static uint64_t words_scalar(const uint64_t* p, uint64_t n)
+	{
+		uint64_t res = 0;
+		for (uint64_t i = 0; i < n; ++i)
+			res += bits::cnt(p[i]);
+		return res;
+	}
+
+#ifdef SDSL_CPU_DISPATCH
+	__attribute__((target("avx2,popcnt"))) static __m256i popcount256(__m256i v)
+	{
+		const __m256i lookup =
+		_mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4, 0, 1, 1, 2, 1, 2, 2, 3, 1, 2,
+						 2, 3, 2, 3, 3, 4);
+		const __m256i low_mask = _mm256_set1_epi8(0x0f);
+		__m256i		  lo	   = _mm256_and_si256(v, low_mask);
+		__m256i		  hi	   = _mm256_and_si256(_mm256_srli_epi16(v, 4), low_mask);
+		__m256i cnt = _mm256_add_epi8(_mm256_shuffle_epi8(lookup, lo), _mm256_shuffle_epi8(lookup, hi));
+		return _mm256_sad_epu8(cnt, _mm256_setzero_si256());
+	}
+
+	//! Carry-save adder: (h,l) = a + b + c.
+	__attribute__((target("avx2,popcnt"))) static void csa(__m256i& h, __m256i& l, __m256i a, __m256i b,
+												   __m256i c)
+	{
+		__m256i u = _mm256_xor_si256(a, b);
+		h		  = _mm256_or_si256(_mm256_and_si256(a, b), _mm256_and_si256(u, c));
+		l		  = _mm256_xor_si256(u, c);
+	}
+
+	__attribute__((target("avx2,popcnt"))) static uint64_t words_avx2(const uint64_t* p, uint64_t n)
+	{
+		const __m256i* d	  = (const __m256i*)p;
+		uint64_t	   blocks = n / 4; // 256-bit vectors
+		__m256i		   total  = _mm256_setzero_si256();
+		__m256i		   ones = _mm256_setzero_si256(), twos = _mm256_setzero_si256();
+		__m256i		   fours = _mm256_setzero_si256(), eights = _mm256_setzero_si256();
+		__m256i		   sixteens, twos_a, twos_b, fours_a, fours_b, eights_a, eights_b;
+		uint64_t	   i = 0;
+		for (; i + 16 <= blocks; i += 16) {
+			csa(twos_a, ones, ones, _mm256_loadu_si256(d + i), _mm256_loadu_si256(d + i + 1));
+			csa(twos_b, ones, ones, _mm256_loadu_si256(d + i + 2), _mm256_loadu_si256(d + i + 3));
+			csa(fours_a, twos, twos, twos_a, twos_b);
+			csa(twos_a, ones, ones, _mm256_loadu_si256(d + i + 4), _mm256_loadu_si256(d + i + 5));
+			csa(twos_b, ones, ones, _mm256_loadu_si256(d + i + 6), _mm256_loadu_si256(d + i + 7));
+			csa(fours_b, twos, twos, twos_a, twos_b);
+			csa(eights_a, fours, fours, fours_a, fours_b);
+			csa(twos_a, ones, ones, _mm256_loadu_si256(d + i + 8), _mm256_loadu_si256(d + i + 9));
+			csa(twos_b, ones, ones, _mm256_loadu_si256(d + i + 10), _mm256_loadu_si256(d + i + 11));
+			csa(fours_a, twos, twos, twos_a, twos_b);
+			csa(twos_a, ones, ones, _mm256_loadu_si256(d + i + 12), _mm256_loadu_si256(d + i + 13));
+			csa(twos_b, ones, ones, _mm256_loadu_si256(d + i + 14), _mm256_loadu_si256(d + i + 15));
+			csa(fours_b, twos, twos, twos_a, twos_b);
+			csa(eights_b, fours, fours, fours_a, fours_b);
+			csa(sixteens, eights, eights, eights_a, eights_b);
+			total = _mm256_add_epi64(total, popcount256(sixteens));
+		}
+		total = _mm256_slli_epi64(total, 4);
+		total = _mm256_add_epi64(total, _mm256_slli_epi64(popcount256(eights), 3));
+		total = _mm256_add_epi64(total, _mm256_slli_epi64(popcount256(fours), 2));
+		total = _mm256_add_epi64(total, _mm256_slli_epi64(popcount256(twos), 1));
+		total = _mm256_add_epi64(total, popcount256(ones));
+		for (; i < blocks; ++i) {
+			total = _mm256_add_epi64(total, popcount256(_mm256_loadu_si256(d + i)));
+		}
+		uint64_t res = (uint64_t)_mm256_extract_epi64(total, 0) +
+					   (uint64_t)_mm256_extract_epi64(total, 1) +
+					   (uint64_t)_mm256_extract_epi64(total, 2) +
+					   (uint64_t)_mm256_extract_epi64(total, 3);
+		for (i = blocks * 4; i < n; ++i) {
+			res += __builtin_popcountll(p[i]);
+		}
+		return res;
+	}
+
+	__attribute__((target("avx512f,avx512vpopcntdq"))) static uint64_t
+	words_avx512(const uint64_t* p, uint64_t n)
+	{
+		__m512i	total0 = _mm512_setzero_si512(), total1 = _mm512_setzero_si512();
+		uint64_t i		= 0;
+		for (; i + 16 <= n; i += 16) {
+			total0 = _mm512_add_epi64(total0, _mm512_popcnt_epi64(_mm512_loadu_si512(p + i)));
+			total1 = _mm512_add_epi64(total1, _mm512_popcnt_epi64(_mm512_loadu_si512(p + i + 8)));
+		}
+		for (; i < n; i += 8) {
+			__mmask8 mask = (n - i >= 8) ? (__mmask8)0xFF : (__mmask8)((1u << (n - i)) - 1);
+			total0 = _mm512_add_epi64(total0, _mm512_popcnt_epi64(_mm512_maskz_loadu_epi64(mask, p + i)));
+		}
+		uint64_t lanes[8];
+		_mm512_storeu_si512(lanes, _mm512_add_epi64(total0, total1));
+		return lanes[0] + lanes[1] + lanes[2] + lanes[3] + lanes[4] + lanes[5] + lanes[6] + lanes[7];
+	}
+#endif
+};
+
+} // end namespace sdsl
+
+#endif
@@ -8,8 +8,12 @@
 #ifndef INCLUDED_SDSL_SUFFIX_ARRAY_ALGORITHM
 #define INCLUDED_SDSL_SUFFIX_ARRAY_ALGORITHM
 
+#include <array>
 #include <iterator>
+#include <vector>
 #include "suffix_array_helper.hpp"
+#include "csa_sampling_strategy.hpp"
+#include "parallel_helper.hpp"
 
 namespace sdsl {
 
@@ -224,6 +228,199 @@ SDSL_UNUSED typename std::enable_if<std::is_same<csa_tag, typename t_csa::index_
 	return r + 1 - l;
 }
 
+//! Backward search which also reports the suffix array value of the right border.
+/*!
+ * \tparam t_csa      A CSA type whose SA sampling contains the first and last
+ *                    position of each BWT run (see has_phi_support).
+ * \tparam t_pat_iter Pattern iterator type.
+ *
+ * \param csa   The CSA object.
+ * \param begin Iterator to the begin of the pattern (inclusive).
+ * \param end   Iterator to the end of the pattern (exclusive).
+ * \param l_res New left border.
+ * \param r_res New right border.
+ * \param sa_r  \f$ SA[r_{res}] \f$ if the pattern occurs.
+ * \return The size of the new interval [\ell_{new}..r_{new}].
+ *         Equals zero, if no match is found.
+ *
+ * \par Time complexity
+ *       \f$ \Order{ len \cdot (t_{rank\_bwt} + t_{select\_bwt}) } \f$
+ * \par Reference
+ *         Travis Gagie, Gonzalo Navarro, Nicola Prezza:
+ *         Optimal-Time Text Indexing in BWT-runs Bounded Space.
+ *         SODA 2018: 1459-1477
+ */
+template <class t_csa, class t_pat_iter>
+typename t_csa::size_type backward_search_toehold(const t_csa&				 csa,
+												  t_pat_iter				 begin,
+												  t_pat_iter				 end,
+												  typename t_csa::size_type& l_res,
+												  typename t_csa::size_type& r_res,
+												  typename t_csa::size_type& sa_r)
+{
+	static_assert(has_phi_support<typename t_csa::sa_sample_type>::value,
+				  "backward_search_toehold: the SA sampling has to sample the BWT runs");
+	typedef typename t_csa::size_type size_type;
+	size_type						  n = csa.size();
+	size_type						  l = 0, r = n - 1;
+	sa_r								= csa.sa_sample[r]; // last position of the last run
+	for (t_pat_iter it = end; begin < it;) {
+		--it;
+		typename t_csa::char_type c  = *it;
+		size_type				  cc = csa.char2comp[c];
+		size_type				  rl = 0, rr = 0;
+		if (cc > 0 or c == 0) {
+			rl = csa.bwt.rank(l, c);
+			rr = csa.bwt.rank(r + 1, c);
+		}
+		if (rl == rr) {
+			l_res = 1;
+			r_res = 0;
+			return 0;
+		}
+		if (csa.bwt[r] == c) {
+			sa_r = (sa_r == 0 ? n : sa_r) - 1;
+		} else {
+			// the last c in bwt[l..r] ends a run and is therefore sampled
+			sa_r = csa.sa_sample[csa.bwt.select(rr, c)];
+			sa_r = (sa_r == 0 ? n : sa_r) - 1;
+		}
+		l = csa.C[cc] + rl;
+		r = csa.C[cc] + rr - 1;
+	}
+	l_res = l;
+	r_res = r;
+	return r + 1 - l;
+}
+
+template <class t_csa>
+auto _rank_bwt_batch(const t_csa&						 csa,
+					 const typename t_csa::size_type* i,
+					 const typename t_csa::char_type* c,
+					 typename t_csa::size_type		  n,
+					 typename t_csa::size_type*		  res,
+					 int)
+-> decltype(csa.wavelet_tree.rank_batch(i, c, n, res), void())
+{
+	csa.wavelet_tree.rank_batch(i, c, n, res);
+}
+
+template <class t_csa>
+void _rank_bwt_batch(const t_csa&					  csa,
+					 const typename t_csa::size_type* i,
+					 const typename t_csa::char_type* c,
+					 typename t_csa::size_type		  n,
+					 typename t_csa::size_type*		  res,
+					 long)
+{
+	for (typename t_csa::size_type k = 0; k < n; ++k) {
+		res[k] = csa.bwt.rank(i[k], c[k]);
+	}
+}
+
+//! Backward search for a batch of patterns.
+/*!
+ * The patterns are processed in an interleaved fashion: up to t_batch
+ * searches are active at the same time and each of them advances by one
+ * character per round. The rank queries of a round are answered together
+ * by `rank_batch` of the wavelet tree (if available), which prefetches
+ * the rank data of the next level, so the cache misses of independent
+ * searches overlap.
+ *
+ * \tparam t_csa      A CSA type.
+ * \tparam t_pat_vec  Random access container of patterns, e.g.
+ *                    std::vector<std::string>.
+ * \tparam t_batch    Number of concurrently active searches.
+ *
+ * \param csa         The CSA object.
+ * \param patterns    The patterns.
+ * \param out_ranges  out_ranges[k] is set to the interval \f$[\ell..r]\f$
+ *                    of patterns[k], i.e. the result of
+ *                    backward_search(csa, 0, csa.size()-1, ...).
+ *                    If the pattern does not occur, \f$ r+1 = \ell \f$.
+ *
+ * \par Time complexity
+ *       \f$ \Order{ \sum_k |patterns[k]| \cdot t_{rank\_bwt} } \f$
+ */
+template <class t_csa, class t_pat_vec, uint32_t t_batch = 32>
+void backward_search_batch(
+const t_csa&										   csa,
+const t_pat_vec&									   patterns,
+std::vector<std::array<typename t_csa::size_type, 2>>& out_ranges,
+SDSL_UNUSED typename std::enable_if<std::is_same<csa_tag, typename t_csa::index_category>::value,
+									csa_tag>::type x = csa_tag())
+{
+	typedef typename t_csa::size_type					   size_type;
+	typedef typename t_csa::char_type					   char_type;
+	typedef typename t_pat_vec::value_type::const_iterator pat_iter;
+	struct state_type {
+		size_type k;
+		pat_iter  begin, it;
+		size_type l, r;
+	};
+
+	out_ranges.resize(patterns.size());
+	size_type next = 0;
+	// starts the search of the next non-empty pattern in s
+	auto start = [&](state_type& s) -> bool {
+		while (next < patterns.size()) {
+			size_type k = next++;
+			s			= {k, patterns[k].begin(), patterns[k].end(), 0, csa.size() - 1};
+			if (s.begin != s.it) return true;
+			out_ranges[k] = {{s.l, s.r}};
+		}
+		return false;
+	};
+	std::array<state_type, t_batch>		active;
+	std::array<size_type, 2 * t_batch>  q_i, q_res;
+	std::array<char_type, 2 * t_batch>  q_c;
+	std::array<uint32_t, t_batch>		q_pos;
+	uint32_t							n_active = 0;
+	while (n_active < t_batch and start(active[n_active]))
+		++n_active;
+	while (n_active > 0) {
+		// (1) collect the rank queries of all active searches
+		size_type q = 0;
+		for (uint32_t j = 0; j < n_active; ++j) {
+			state_type& s = active[j];
+			char_type	c = (char_type) * (s.it - 1);
+			q_pos[j]	  = q;
+			if ((csa.char2comp[c] > 0 or c == 0) and !(s.l == 0 and s.r + 1 == csa.size())) {
+				q_i[q]	 = s.l;
+				q_c[q++] = c;
+				q_i[q]	 = s.r + 1;
+				q_c[q++] = c;
+			}
+		}
+		_rank_bwt_batch(csa, q_i.data(), q_c.data(), q, q_res.data(), 0);
+		// (2) finish the step like backward_search(csa, l, r, c, l, r)
+		for (uint32_t j = 0; j < n_active;) {
+			state_type& s  = active[j];
+			char_type	c  = (char_type) * (--s.it);
+			size_type	cc = csa.char2comp[c];
+			if (cc == 0 and c > 0) {
+				s.l = 1;
+				s.r = 0;
+			} else if (s.l == 0 and s.r + 1 == csa.size()) {
+				s.l = csa.C[cc];
+				s.r = csa.C[cc + 1] - 1;
+			} else {
+				s.l = csa.C[cc] + q_res[q_pos[j]];
+				s.r = csa.C[cc] + q_res[q_pos[j] + 1] - 1;
+			}
+			if (s.it == s.begin or s.r + 1 - s.l == 0) {
+				out_ranges[s.k] = {{s.l, s.r}};
+				if (!start(s)) {
+					s		 = active[--n_active];
+					q_pos[j] = q_pos[n_active];
+					continue;
+				}
+			}
+			++j;
+		}
+	}
+}
+
 //! Bidirectional search for a character c on an interval \f$[l_fwd..r_fwd]\f$ of the suffix array.
 /*!
  * \param csa_fwd   The CSA object of the forward text in which the backward_search should be done.
@@ -501,6 +698,221 @@ auto lex_interval(const t_csx& csx, t_pat_iter begin, t_pat_iter end)
 }
 
 
+template <class t_csa>
+auto _lf_batch(const t_csa&						csa,
+			   const typename t_csa::size_type* i,
+			   typename t_csa::size_type		n,
+			   typename t_csa::size_type*		res,
+			   int)
+-> decltype(csa.wavelet_tree.inverse_select_batch(
+			i,
+			n,
+			(std::pair<typename t_csa::size_type, typename t_csa::wavelet_tree_type::value_type>*)
+			nullptr),
+			void())
+{
+	std::pair<typename t_csa::size_type, typename t_csa::wavelet_tree_type::value_type> rc[64];
+	for (typename t_csa::size_type b = 0; b < n; b += 64) {
+		typename t_csa::size_type m = std::min((typename t_csa::size_type)64, n - b);
+		csa.wavelet_tree.inverse_select_batch(i + b, m, rc);
+		for (typename t_csa::size_type k = 0; k < m; ++k) {
+			res[b + k] = csa.C[csa.char2comp[rc[k].second]] + rc[k].first;
+		}
+	}
+}
+
+template <class t_csa>
+void _lf_batch(const t_csa&						csa,
+			   const typename t_csa::size_type* i,
+			   typename t_csa::size_type		n,
+			   typename t_csa::size_type*		res,
+			   long)
+{
+	for (typename t_csa::size_type k = 0; k < n; ++k) {
+		res[k] = csa.lf[i[k]];
+	}
+}
+
+// LF (lf_tag) or PSI (psi_tag) steps for n positions; SA[res[k]] = SA[i[k]] -/+ 1
+template <class t_csa>
+void _sa_step_batch(const t_csa&					 csa,
+					const typename t_csa::size_type* i,
+					typename t_csa::size_type		 n,
+					typename t_csa::size_type*		 res,
+					lf_tag)
+{
+	_lf_batch(csa, i, n, res, 0);
+}
+
+template <class t_csa>
+void _sa_step_batch(const t_csa&					 csa,
+					const typename t_csa::size_type* i,
+					typename t_csa::size_type		 n,
+					typename t_csa::size_type*		 res,
+					psi_tag)
+{
+	for (typename t_csa::size_type k = 0; k < n; ++k) {
+		res[k] = csa.psi[i[k]];
+	}
+}
+
+// SA value of a sampled position i which was reached after off LF (or PSI) steps
+template <class t_csa>
+typename t_csa::size_type
+_sa_from_sample(const t_csa& csa, typename t_csa::size_type i, typename t_csa::size_type off, lf_tag)
+{
+	typename t_csa::size_type res = csa.sa_sample[i] + off;
+	return res >= csa.size() ? res - csa.size() : res;
+}
+
+template <class t_csa>
+typename t_csa::size_type
+_sa_from_sample(const t_csa& csa, typename t_csa::size_type i, typename t_csa::size_type off, psi_tag)
+{
+	typename t_csa::size_type res = csa.sa_sample[i];
+	return res < off ? csa.size() - (off - res) : res - off;
+}
+
+// writes SA[l+k] to out[k] for k in [b,e)
+template <class t_csa, class t_rac, uint32_t t_batch = 64>
+void _sa_range_batch(const t_csa&			   csa,
+					 typename t_csa::size_type l,
+					 typename t_csa::size_type b,
+					 typename t_csa::size_type e,
+					 t_rac&					   out)
+{
+	typedef typename t_csa::size_type		   size_type;
+	typedef typename t_csa::extract_category extract_category;
+	std::array<size_type, t_batch>			   pos, off, idx, next;
+	size_type								   n_active = 0;
+	while (b < e or n_active > 0) {
+		while (n_active < t_batch and b < e) {
+			pos[n_active]   = l + b;
+			off[n_active]   = 0;
+			idx[n_active++] = b++;
+		}
+		// resolve the positions which reached a sample
+		for (size_type j = 0; j < n_active;) {
+			if (csa.sa_sample.is_sampled(pos[j])) {
+				out[idx[j]] = _sa_from_sample(csa, pos[j], off[j], extract_category());
+				--n_active;
+				pos[j] = pos[n_active];
+				off[j] = off[n_active];
+				idx[j] = idx[n_active];
+			} else {
+				++j;
+			}
+		}
+		// advance all the others by one step
+		_sa_step_batch(csa, pos.data(), n_active, next.data(), extract_category());
+		for (size_type j = 0; j < n_active; ++j) {
+			pos[j] = next[j];
+			++off[j];
+		}
+	}
+}
+
+//! Calculates the suffix array values SA[l..r].
+/*!
+ * Instead of calling csa[i] for each i, up to 64 positions walk to their
+ * next SA sample at the same time. In each round, all of them take one
+ * LF step (PSI step for CSAs with psi_tag). For csa_wt these steps are
+ * answered by inverse_select_batch of the wavelet tree, which prefetches the
+ * rank data of the next level, so the cache misses of the positions
+ * overlap. A position is resolved as soon as it reaches a sample, and its
+ * place in the batch is refilled with the next position of the interval.
+ *
+ * \tparam t_csa CSA type.
+ * \tparam t_rac Resizeable random access container, e.g. int_vector<64> or
+ *               std::vector<uint64_t>. It is only reallocated if it grows,
+ *               so the same buffer can be reused for several calls.
+ *
+ * \param csa     The CSA object.
+ * \param l       Left border of the interval.
+ * \param r       Right border of the interval. The interval is empty if r+1 = l.
+ * \param out     out[k] is set to SA[l+k] for \f$ 0 \leq k \leq r-l \f$.
+ * \param threads Number of threads. Each thread processes a chunk of the
+ *                interval; the chunk borders are multiples of 64, so
+ *                threads do not write to the same word of a bit-compressed
+ *                int_vector.
+ *
+ * \par Time complexity
+ *        \f$ \Order{ (r-l+1) \cdot s \cdot t_{LF} } \f$ for SA sample density \f$ s \f$.
+ */
+template <class t_csa, class t_rac>
+void sa_range_batch(const t_csa&			   csa,
+					typename t_csa::size_type l,
+					typename t_csa::size_type r,
+					t_rac&					   out,
+					typename t_csa::size_type threads = 1)
+{
+	typedef typename t_csa::size_type size_type;
+	size_type						  n = r + 1 - l;
+	out.resize(n);
+	parallel_for_blocks(
+	n, parallel_threads(n, threads, 1024),
+	[&](uint64_t, uint64_t b, uint64_t e) { _sa_range_batch(csa, l, b, e, out); }, 64);
+}
+
+// true if the answers of csa[i] are cached (see csa_wt::cache())
+template <class t_csa>
+auto _sa_cache_enabled(const t_csa& csa, int) -> decltype(csa.cache().enabled())
+{
+	return csa.cache().enabled();
+}
+
+template <class t_csa>
+bool _sa_cache_enabled(const t_csa&, long)
+{
+	return false;
+}
+
+// batch: get the occurrences with sa_range_batch instead of csa[i]
+template <class t_csa, class t_pat_iter, class t_rac>
+typename t_csa::size_type _locate(const t_csa&			   csa,
+								  t_pat_iter				begin,
+								  t_pat_iter				end,
+								  t_rac&					occ,
+								  typename t_csa::size_type threads,
+								  bool						batch,
+								  std::false_type)
+{
+	typename t_csa::size_type occ_begin, occ_end, occs;
+	occs = backward_search(csa, 0, csa.size() - 1, begin, end, occ_begin, occ_end);
+	if (batch and !_sa_cache_enabled(csa, 0)) {
+		sa_range_batch(csa, occ_begin, occ_end, occ, threads);
+	} else {
+		occ.resize(occs);
+		for (typename t_csa::size_type i = 0; i < occs; ++i) {
+			occ[i] = csa[occ_begin + i];
+		}
+	}
+	return occs;
+}
+
+// r-index locate: the toehold SA[r] followed by SA[i-1] = phi(SA[i])
+template <class t_csa, class t_pat_iter, class t_rac>
+typename t_csa::size_type _locate(const t_csa& csa,
+								  t_pat_iter   begin,
+								  t_pat_iter   end,
+								  t_rac&	   occ,
+								  typename t_csa::size_type,
+								  bool,
+								  std::true_type)
+{
+	typename t_csa::size_type occ_begin, occ_end, occs, sa_r = 0;
+	occs = backward_search_toehold(csa, begin, end, occ_begin, occ_end, sa_r);
+	occ.resize(occs);
+	if (occs > 0) {
+		occ[occs - 1] = sa_r;
+		for (typename t_csa::size_type i = occs - 1; i > 0; --i) {
+			sa_r	   = csa.sa_sample.phi(sa_r);
+			occ[i - 1] = sa_r;
+		}
+	}
+	return occs;
+}
+
 //! Calculates all occurrences of a pattern pat in a CSA.
 /*!
  * \tparam t_csa      CSA type.
@@ -514,7 +926,10 @@ auto lex_interval(const t_csx& csx, t_pat_iter begin, t_pat_iter end)
  *
  * \par Time complexity
  *        \f$ \Order{ t_{backward\_search} + z \cdot t_{SA} } \f$, where \f$z\f$ is the number of
- *         occurrences of pattern in the CSA.
+ *         occurrences of pattern in the CSA. The SA values are calculated by csa[i], which
+ *         uses the query_cache of the CSA, if it is enabled. If the SA sampling supports phi (run_sa_sampling) the occurrences are reported with
+ *         backward_search_toehold and phi in
+ *         \f$ \Order{ len \cdot t_{select\_bwt} + z \cdot t_{\phi} } \f$.
  */
 template <class t_csa, class t_pat_iter, class t_rac = int_vector<64>>
 t_rac locate(const t_csa& csa,
@@ -524,15 +939,49 @@ t_rac locate(const t_csa& csa,
 			 typename std::enable_if<std::is_same<csa_tag, typename t_csa::index_category>::value,
 									 csa_tag>::type x = csa_tag())
 {
-	typename t_csa::size_type occ_begin, occ_end, occs;
-	occs = backward_search(csa, 0, csa.size() - 1, begin, end, occ_begin, occ_end);
-	t_rac occ(occs);
-	for (typename t_csa::size_type i = 0; i < occs; ++i) {
-		occ[i] = csa[occ_begin + i];
-	}
+	t_rac occ;
+	_locate(
+	csa, begin, end, occ, 1, false, typename has_phi_support<typename t_csa::sa_sample_type>::type());
 	return occ;
 }
 
+//! Calculates all occurrences of a pattern pat in a CSA and writes them to a given buffer.
+/*!
+ * \tparam t_csa      CSA type.
+ * \tparam t_pat_iter Pattern iterator type.
+ * \tparam t_rac      Resizeable random access container (see sa_range_batch).
+ *
+ * \param csa     The CSA object.
+ * \param begin   Iterator to the begin of the pattern (inclusive).
+ * \param end     Iterator to the end of the pattern (exclusive).
+ * \param occ     Buffer for the occurrences, which is resized to their number.
+ * \param threads Number of threads used by sa_range_batch.
+ * \return The number of occurrences.
+ *
+ * The SA values are calculated by sa_range_batch, which overlaps the cache
+ * misses of the occurrences and pays off for indexes which do not fit in
+ * the cache. If the query_cache of the CSA is enabled, csa[i] is used
+ * instead, so the cached answers are not bypassed.
+ */
+template <class t_csa, class t_pat_iter, class t_rac>
+typename t_csa::size_type
+locate(const t_csa&				 csa,
+	   t_pat_iter				 begin,
+	   t_pat_iter				 end,
+	   t_rac&					 occ,
+	   typename t_csa::size_type threads = 1,
+	   SDSL_UNUSED typename std::enable_if<std::is_same<csa_tag, typename t_csa::index_category>::value,
+										   csa_tag>::type x = csa_tag())
+{
+	return _locate(csa,
+				   begin,
+				   end,
+				   occ,
+				   threads,
+				   true,
+				   typename has_phi_support<typename t_csa::sa_sample_type>::type());
+}
+
 //! Calculates all occurrences of a pattern pat in a CSA/CST.
 /*!
  * \tparam t_csa      CSA/CST type.
@@ -553,6 +1002,127 @@ t_rac locate(const t_csx& csx, const typename t_csx::string_type& pat)
 	return locate<t_csx, decltype(pat.begin()), t_rac>(csx, pat.begin(), pat.end(), tag);
 }
 
+//! A lazy view of the occurrences of a pattern in a CSA.
+/*!
+ * Only the SA interval of the pattern is computed at construction. The
+ * occurrences are resolved on demand:
+ *  - operator[] and the iterators compute one SA value per access,
+ *  - page() computes a block of consecutive occurrences with sa_range_batch.
+ * The view needs constant memory, independent of the number of occurrences,
+ * so it is suited for paginated results of frequent patterns. The
+ * occurrences are in SA order, i.e. in lexicographic order of the suffixes
+ * and not in text order. The CSA must outlive the view.
+ *
+ * \tparam t_csa CSA type, e.g. csa_wt or csa_sada.
+ */
+template <class t_csa>
+class locate_range {
+public:
+	typedef typename t_csa::size_type				   size_type;
+	typedef typename t_csa::value_type				   value_type;
+	typedef typename t_csa::difference_type			   difference_type;
+	typedef random_access_const_iterator<locate_range> const_iterator;
+
+private:
+	const t_csa* m_csa  = nullptr;
+	size_type	m_l	 = 0;
+	size_type	m_size = 0;
+
+public:
+	//! Default constructor, an empty range
+	locate_range() = default;
+
+	//! Constructor for the occurrences of the pattern [begin..end).
+	template <class t_pat_iter>
+	locate_range(const t_csa& csa, t_pat_iter begin, t_pat_iter end) : m_csa(&csa)
+	{
+		size_type r = 0;
+		m_size		= backward_search(csa, 0, csa.size() - 1, begin, end, m_l, r);
+	}
+
+	//! Constructor for the SA interval [interval[0]..interval[1]], e.g. the result of lex_interval.
+	locate_range(const t_csa& csa, const std::array<size_type, 2>& interval)
+		: m_csa(&csa), m_l(interval[0]), m_size(interval[1] + 1 - interval[0])
+	{
+	}
+
+	//! Number of occurrences.
+	size_type size() const { return m_size; }
+
+	//! Returns if there is no occurrence.
+	bool empty() const { return m_size == 0; }
+
+	//! The SA interval of the occurrences.
+	std::array<size_type, 2> sa_interval() const { return {{m_l, m_l + m_size - 1}}; }
+
+	//! Returns the k-th occurrence.
+	/*! \par Time complexity
+	 *       \f$ \Order{ t_{SA} } \f$
+	 */
+	value_type operator[](size_type k) const
+	{
+		assert(k < m_size);
+		return (*m_csa)[m_l + k];
+	}
+
+	//! Writes the occurrences k..k+m-1 to out; the page is clipped at size().
+	/*!
+	 * \param k       Index of the first occurrence of the page.
+	 * \param m       Size of the page.
+	 * \param out     Resizeable random access container, which is resized to the
+	 *                size of the page (see sa_range_batch).
+	 * \param threads Number of threads used by sa_range_batch.
+	 * \return The size of the page.
+	 */
+	template <class t_rac>
+	size_type page(size_type k, size_type m, t_rac& out, size_type threads = 1) const
+	{
+		k = std::min(k, m_size);
+		m = std::min(m, m_size - k);
+		sa_range_batch(*m_csa, m_l + k, m_l + k + m - 1, out, threads);
+		return m;
+	}
+
+	//! Returns a const_iterator to the first occurrence.
+	const_iterator begin() const { return const_iterator(this, 0); }
+
+	//! Returns a const_iterator to the element after the last occurrence.
+	const_iterator end() const { return const_iterator(this, m_size); }
+};
+
+//! Calculates the first k occurrences of a pattern in a CSA.
+/*!
+ * Only the first k occurrences in SA order are resolved, so time and memory
+ * are bounded by k and not by the number of occurrences.
+ *
+ * \tparam t_csa      CSA type.
+ * \tparam t_pat_iter Pattern iterator type.
+ * \tparam t_rac      Resizeable random access container (see sa_range_batch).
+ *
+ * \param csa     The CSA object.
+ * \param begin   Iterator to the begin of the pattern (inclusive).
+ * \param end     Iterator to the end of the pattern (exclusive).
+ * \param k       Maximal number of reported occurrences.
+ * \param occ     Buffer for the occurrences, which is resized to min(k, number of occurrences).
+ * \param threads Number of threads used by sa_range_batch.
+ * \return The number of all occurrences of the pattern.
+ *
+ * \par Time complexity
+ *        \f$ \Order{ t_{backward\_search} + \min(k,z) \cdot t_{SA} } \f$
+ */
+template <class t_csa, class t_pat_iter, class t_rac>
+typename t_csa::size_type locate_first_k(const t_csa&			   csa,
+										 t_pat_iter				   begin,
+										 t_pat_iter				   end,
+										 typename t_csa::size_type k,
+										 t_rac&					   occ,
+										 typename t_csa::size_type threads = 1)
+{
+	locate_range<t_csa> occs(csa, begin, end);
+	occs.page(0, k, occ, threads);
+	return occs.size();
+}
+
 
 //! Writes the substring T[begin..end] of the original text T to text[0..end-begin+1].
 /*!
@@ -381,7 +381,7 @@ public:
          *  \par Time complexity
          *        \f$ \Order{t_{\Psi}} \f$
          */
-	size_type select(size_type i, const char_type c) const { return m_csa.select(i, c); }
+	size_type select(size_type i, const char_type c) const { return m_csa.select_bwt(i, c); }
 
 
 	//! Returns if the BWT function is empty.
@@ -18,6 +18,7 @@
 #include "wavelet_trees.hpp"
 #include "construct.hpp"
 #include "suffix_array_algorithm.hpp"
+#include "csa_qgram.hpp"
 
 namespace sdsl {
 
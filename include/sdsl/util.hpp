@@ -9,6 +9,7 @@
 #define INCLUDED_SDSL_UTIL
 
 #include "bits.hpp"
+#include "simd_popcount.hpp"
 #include "sfstream.hpp"
 #include "ram_fs.hpp"
 #include "config.hpp" // for constants
@@ -636,12 +637,10 @@ typename t_int_vec::size_type util::cnt_one_bits(const t_int_vec& v)
 {
 	const uint64_t* data = v.data();
 	if (v.empty()) return 0;
-	typename t_int_vec::size_type result = bits::cnt(*data);
-	for (typename t_int_vec::size_type i = 1; i < ((v.bit_size() + 63) >> 6); ++i) {
-		result += bits::cnt(*(++data));
-	}
+	typename t_int_vec::size_type words  = (v.bit_size() + 63) >> 6;
+	typename t_int_vec::size_type result = simd_popcount::words(data, words);
 	if (v.bit_size() & 0x3F) {
-		result -= bits::cnt((*data) & (~bits::lo_set[v.bit_size() & 0x3F]));
+		result -= bits::cnt(data[words - 1] & (~bits::lo_set[v.bit_size() & 0x3F]));
 	}
 	return result;
 }
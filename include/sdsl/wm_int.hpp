@@ -14,6 +14,8 @@
 #include "rank_support_v.hpp"
 #include "select_support_mcl.hpp"
 #include "wt_helper.hpp"
+#include "construct_config.hpp"
+#include "construct_wt_parallel.hpp"
 #include "util.hpp"
 #include <set>		 // for calculating the alphabet size
 #include <map>		 // for mapping a symbol to its lexicographical index
@@ -97,6 +99,11 @@ public:
          *    \par Time complexity
          *        \f$ \Order{n\log|\Sigma|}\f$, where \f$n=size\f$
          *        I.e. we need \Order{n\log n} if rac is a permutation of 0..n-1.
+         *
+         * If construct_config().num_threads is larger than one, the levels
+         * are filled in memory by several threads (see
+         * _construct_wt_levels_parallel) and no temporary files are used.
+         * The result does not depend on the number of threads.
          */
 	template <typename t_it>
 	wm_int(t_it begin, t_it end, std::string tmp_dir = ram_file_name(""))
@@ -111,6 +118,22 @@ public:
 			if (value > max_elem) max_elem = value;
 		}
 		m_max_level = bits::hi(max_elem) + 1;
+		if (parallel_threads(m_size, construct_config().num_threads) > 1) {
+			int_vector<> rac(m_size, 0, m_max_level);
+			std::copy(begin, end, rac.begin());
+			bit_vector tree;
+			m_sigma = _construct_wt_levels_parallel(
+			rac, tree, true, construct_config().num_threads, &m_zero_cnt);
+			m_tree = bit_vector_type(std::move(tree));
+			util::init_support(m_tree_rank, &m_tree);
+			util::init_support(m_tree_select0, &m_tree);
+			util::init_support(m_tree_select1, &m_tree);
+			m_rank_level = int_vector<64>(m_max_level, 0);
+			for (uint32_t k = 0; k < m_rank_level.size(); ++k) {
+				m_rank_level[k] = m_tree_rank(k * m_size);
+			}
+			return;
+		}
 		std::string tree_out_buf_file_name = tmp_file(tmp_dir, "_m_tree");
 		{
 			int_vector<> rac(m_size, 0, m_max_level);
@@ -281,6 +304,58 @@ public:
 		return res;
 	};
 
+	//! Recovers the symbols at the positions i[0..n-1].
+	/*! \param i   Array of n indexes in the original vector.
+	 *  \param n   Number of queries.
+	 *  \param res Array of size n; res[k] = (*this)[i[k]].
+	 *
+	 *  The queries advance level by level. Before a query descends, the
+	 *  rank data of its position on the next level is prefetched, so the
+	 *  cache misses of independent queries overlap.
+	 */
+	void access_batch(const size_type* i, size_type n, value_type* res) const
+	{
+		const size_type batch = 64;
+		struct state_type {
+			size_type  i, k;
+			uint32_t   level;
+			value_type c;
+		};
+		state_type active[batch];
+		for (size_type b = 0; b < n; b += batch) {
+			size_type n_active = 0;
+			for (size_type k = b; k < std::min(n, b + batch); ++k) {
+				assert(i[k] < size());
+				if (m_max_level == 0) {
+					res[k] = 0;
+				} else {
+					active[n_active++] = {i[k], k, 0, 0};
+					sdsl::prefetch_rank(m_tree_rank, i[k]);
+				}
+			}
+			while (n_active > 0) {
+				for (size_type j = 0; j < n_active;) {
+					state_type& s		  = active[j];
+					size_type	rank_ones = m_tree_rank(s.i) - m_rank_level[s.level];
+					s.c <<= 1;
+					if (m_tree[s.i]) { // one at position i => follow right child
+						s.i = (s.level + 1) * m_size + m_zero_cnt[s.level] + rank_ones;
+						s.c |= 1;
+					} else { // zero at position i => follow left child
+						s.i = (s.level + 1) * m_size + (s.i - s.level * m_size) - rank_ones;
+					}
+					if (++s.level == m_max_level) {
+						res[s.k] = s.c;
+						s		 = active[--n_active];
+					} else {
+						sdsl::prefetch_rank(m_tree_rank, s.i);
+						++j;
+					}
+				}
+			}
+		}
+	}
+
 	//! Calculates how many symbols c are in the prefix [0..i-1] of the supported vector.
 	/*!
          *  \param i The exclusive index of the prefix range [0..i-1], so \f$i\in[0..size()]\f$.
@@ -315,6 +390,61 @@ public:
 		return i;
 	};
 
+	//! Calculates rank(i[k], c[k]) for a batch of queries.
+	/*! \param i   Array of n prefix lengths.
+	 *  \param c   Array of n symbols.
+	 *  \param n   Number of queries.
+	 *  \param res Array of size n; res[k] = rank(i[k], c[k]).
+	 *
+	 *  The queries advance level by level as in access_batch.
+	 */
+	void rank_batch(const size_type* i, const value_type* c, size_type n, size_type* res) const
+	{
+		const size_type batch = 64;
+		struct state_type {
+			size_type  b, i, k;
+			uint32_t   level;
+			value_type c;
+		};
+		state_type active[batch];
+		for (size_type bb = 0; bb < n; bb += batch) {
+			size_type n_active = 0;
+			for (size_type k = bb; k < std::min(n, bb + batch); ++k) {
+				if (((1ULL) << (m_max_level)) <= c[k]) {
+					res[k] = 0;
+				} else if (m_max_level == 0 or i[k] == 0) {
+					res[k] = i[k];
+				} else {
+					active[n_active++] = {0, i[k], k, 0, c[k]};
+					sdsl::prefetch_rank(m_tree_rank, i[k]);
+				}
+			}
+			while (n_active > 0) {
+				for (size_type j = 0; j < n_active;) {
+					state_type& s	  = active[j];
+					size_type	rank_b = m_tree_rank(s.b);
+					size_type	ones   = m_tree_rank(s.b + s.i) - rank_b; // ones in [b..i)
+					size_type	ones_p = rank_b - m_rank_level[s.level];  // ones in [level_b..b)
+					if ((s.c >> (m_max_level - 1 - s.level)) & 1) { // search for a one at this level
+						s.i = ones;
+						s.b = (s.level + 1) * m_size + m_zero_cnt[s.level] + ones_p;
+					} else { // search for a zero at this level
+						s.i = s.i - ones;
+						s.b = (s.level + 1) * m_size + (s.b - s.level * m_size - ones_p);
+					}
+					if (++s.level == m_max_level or s.i == 0) {
+						res[s.k] = s.i;
+						s		 = active[--n_active];
+					} else {
+						sdsl::prefetch_rank(m_tree_rank, s.b);
+						sdsl::prefetch_rank(m_tree_rank, s.b + s.i);
+						++j;
+					}
+				}
+			}
+		}
+	}
+
 	//! Calculates how many occurrences of symbol wt[i] are in the prefix [0..i-1] of the original sequence.
 	/*!
          *  \param i The index of the symbol.
@@ -346,6 +476,61 @@ public:
 		return std::make_pair(i, c);
 	}
 
+	//! Calculates inverse_select(i[k]) for a batch of queries.
+	/*! \param i   Array of n indexes in the original vector.
+	 *  \param n   Number of queries.
+	 *  \param res Array of size n; res[k] = inverse_select(i[k]).
+	 *
+	 *  The queries advance level by level as in access_batch.
+	 */
+	void inverse_select_batch(const size_type* i, size_type n, std::pair<size_type, value_type>* res) const
+	{
+		const size_type batch = 64;
+		struct state_type {
+			size_type  b, i, k;
+			uint32_t   level;
+			value_type c;
+		};
+		state_type active[batch];
+		for (size_type bb = 0; bb < n; bb += batch) {
+			size_type n_active = 0;
+			for (size_type k = bb; k < std::min(n, bb + batch); ++k) {
+				assert(i[k] < size());
+				if (m_max_level == 0) {
+					res[k] = std::make_pair(i[k], (value_type)0);
+				} else {
+					active[n_active++] = {0, i[k], k, 0, 0};
+					sdsl::prefetch_rank(m_tree_rank, i[k]);
+				}
+			}
+			while (n_active > 0) {
+				for (size_type j = 0; j < n_active;) {
+					state_type& s	  = active[j];
+					size_type	rank_b = m_tree_rank(s.b);
+					size_type	ones   = m_tree_rank(s.b + s.i) - rank_b; // ones in [b..i)
+					size_type	ones_p = rank_b - m_rank_level[s.level];  // ones in [level_b..b)
+					s.c <<= 1;
+					if (m_tree[s.b + s.i]) { // go to the right child
+						s.i = ones;
+						s.b = (s.level + 1) * m_size + m_zero_cnt[s.level] + ones_p;
+						s.c |= 1;
+					} else { // go to the left child
+						s.i = s.i - ones;
+						s.b = (s.level + 1) * m_size + (s.b - s.level * m_size - ones_p);
+					}
+					if (++s.level == m_max_level) {
+						res[s.k] = std::make_pair(s.i, s.c);
+						s		 = active[--n_active];
+					} else {
+						sdsl::prefetch_rank(m_tree_rank, s.b);
+						sdsl::prefetch_rank(m_tree_rank, s.b + s.i);
+						++j;
+					}
+				}
+			}
+		}
+	}
+
 	//! Calculates the i-th occurrence of the symbol c in the supported vector.
 	/*!
          *  \param i The i-th occurrence.
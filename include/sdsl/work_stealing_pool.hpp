@@ -0,0 +1,205 @@
+// Copyright (c) 2016, the SDSL Project Authors.  All rights reserved.
+// Please see the AUTHORS file for details.  Use of this source code is governed
+// by a BSD license that can be found in the LICENSE file.
+/*! \file work_stealing_pool.hpp
+    \brief work_stealing_pool.hpp contains a persistent thread pool which
+           balances independent tasks by work stealing.
+*/
+#ifndef INCLUDED_SDSL_WORK_STEALING_POOL
+#define INCLUDED_SDSL_WORK_STEALING_POOL
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace sdsl {
+
+//! A pool of threads which processes batches of independent tasks.
+/*!
+ * The threads are started once in the constructor and wait for work
+ * between two calls of parallel_for. The tasks of a call are split into
+ * chunks and distributed evenly over the deques of the threads. A thread
+ * takes chunks from the front of its own deque and, when it runs out of
+ * work, steals chunks from the back of the deques of the other threads.
+ * This keeps all threads busy even if the cost of the tasks varies a lot,
+ * e.g. locate queries with very different numbers of occurrences.
+ *
+ * The calling thread takes part in the computation as thread 0, so a pool
+ * of size p starts p-1 additional threads.
+ */
+class work_stealing_pool {
+public:
+	typedef uint64_t size_type;
+
+private:
+	typedef std::pair<size_type, size_type> range_type; // tasks [first, second)
+
+	struct worker_queue {
+		std::mutex			   mtx;
+		std::deque<range_type> ranges;
+	};
+
+	size_type									  m_size;
+	std::vector<std::unique_ptr<worker_queue>>	m_queues;
+	std::vector<std::thread>					  m_threads;
+	std::function<void(size_type, size_type)>	 m_job;
+	std::mutex									  m_mtx;
+	std::condition_variable						  m_work_cv;
+	std::condition_variable						  m_done_cv;
+	size_type									  m_generation = 0;
+	size_type									  m_active	 = 0;
+	bool										  m_stop	   = false;
+	std::exception_ptr							  m_exception;
+
+	bool take(size_type id, range_type& r)
+	{
+		{ // own deque first
+			worker_queue&				q = *m_queues[id];
+			std::lock_guard<std::mutex> lock(q.mtx);
+			if (!q.ranges.empty()) {
+				r = q.ranges.front();
+				q.ranges.pop_front();
+				return true;
+			}
+		}
+		for (size_type k = 1; k < m_size; ++k) { // steal from the others
+			worker_queue&				q = *m_queues[(id + k) % m_size];
+			std::lock_guard<std::mutex> lock(q.mtx);
+			if (!q.ranges.empty()) {
+				r = q.ranges.back();
+				q.ranges.pop_back();
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void work(size_type id)
+	{
+		range_type r;
+		while (take(id, r)) {
+			for (size_type i = r.first; i < r.second; ++i) {
+				try {
+					m_job(id, i);
+				} catch (...) {
+					std::lock_guard<std::mutex> lock(m_mtx);
+					if (!m_exception) m_exception = std::current_exception();
+				}
+			}
+		}
+	}
+
+	void worker_loop(size_type id)
+	{
+		size_type seen = 0;
+		while (true) {
+			{
+				std::unique_lock<std::mutex> lock(m_mtx);
+				m_work_cv.wait(lock, [&]() { return m_stop or m_generation != seen; });
+				if (m_stop) return;
+				seen = m_generation;
+			}
+			work(id);
+			{
+				std::lock_guard<std::mutex> lock(m_mtx);
+				if (--m_active == 0) m_done_cv.notify_all();
+			}
+		}
+	}
+
+public:
+	//! Constructor
+	/*!
+	 * \param num_threads Number of threads including the calling thread.
+	 *                    0 means std::thread::hardware_concurrency().
+	 */
+	explicit work_stealing_pool(size_type num_threads = 0)
+	{
+		if (num_threads == 0) num_threads = std::thread::hardware_concurrency();
+		m_size = std::max((size_type)1, num_threads);
+		for (size_type t = 0; t < m_size; ++t) {
+			m_queues.emplace_back(new worker_queue());
+		}
+		for (size_type t = 1; t < m_size; ++t) {
+			m_threads.emplace_back(&work_stealing_pool::worker_loop, this, t);
+		}
+	}
+
+	work_stealing_pool(const work_stealing_pool&) = delete;
+	work_stealing_pool& operator=(const work_stealing_pool&) = delete;
+
+	~work_stealing_pool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mtx);
+			m_stop = true;
+		}
+		m_work_cv.notify_all();
+		for (auto& th : m_threads)
+			th.join();
+	}
+
+	//! Number of threads of the pool (including the calling thread).
+	size_type size() const { return m_size; }
+
+	//! Calls f(thread_id, i) for all i in [0,n) and returns when all calls are done.
+	/*!
+	 * \param n     Number of tasks.
+	 * \param f     Functor called as f(thread_id, task). thread_id lies in
+	 *              [0,size()) and can be used to address per-thread state.
+	 * \param grain Number of consecutive tasks which form a chunk. A thread
+	 *              takes or steals a whole chunk at once.
+	 *
+	 * If a task throws, the remaining tasks are still processed and the
+	 * first exception is rethrown in the calling thread.
+	 * parallel_for must not be called concurrently on the same pool.
+	 */
+	template <class t_f>
+	void parallel_for(size_type n, t_f&& f, size_type grain = 1)
+	{
+		if (n == 0) return;
+		grain = std::max((size_type)1, grain);
+		if (m_size == 1 or n <= grain) {
+			for (size_type i = 0; i < n; ++i)
+				f((size_type)0, i);
+			return;
+		}
+		size_type chunks = (n + grain - 1) / grain;
+		{
+			std::lock_guard<std::mutex> lock(m_mtx);
+			m_job = [&f](size_type t, size_type i) { f(t, i); };
+			// thread t gets the t-th block of consecutive chunks
+			for (size_type t = 0; t < m_size; ++t) {
+				size_type c_beg = (chunks * t) / m_size, c_end = (chunks * (t + 1)) / m_size;
+				for (size_type c = c_beg; c < c_end; ++c) {
+					m_queues[t]->ranges.emplace_back(c * grain, std::min(n, (c + 1) * grain));
+				}
+			}
+			m_exception = nullptr;
+			m_active	= m_size - 1;
+			++m_generation;
+		}
+		m_work_cv.notify_all();
+		work(0);
+		std::exception_ptr e;
+		{
+			std::unique_lock<std::mutex> lock(m_mtx);
+			m_done_cv.wait(lock, [&]() { return m_active == 0; });
+			m_job = nullptr;
+			std::swap(e, m_exception);
+		}
+		if (e) std::rethrow_exception(e);
+	}
+};
+
+} // end namespace sdsl
+
+#endif
@@ -15,6 +15,8 @@
 #include "rank_support_v.hpp"
 #include "select_support_mcl.hpp"
 #include "wt_helper.hpp"
+#include "construct_config.hpp"
+#include "construct_wt_parallel.hpp"
 #include "util.hpp"
 #include <set>		 // for calculating the alphabet size
 #include <map>		 // for mapping a symbol to its lexicographical index
@@ -136,6 +138,60 @@ private:
 		}
 	}
 
+	// batched version of inverse_select, which calls out(k, rank, symbol) for each query k
+	template <class t_out>
+	void _inverse_select_batch(const size_type* i, size_type n, t_out out) const
+	{
+		const size_type batch = 64;
+		struct state_type {
+			size_type  offset, node_size, i, k;
+			uint32_t   level;
+			value_type c;
+		};
+		state_type active[batch];
+		for (size_type b = 0; b < n; b += batch) {
+			size_type n_active = 0;
+			for (size_type k = b; k < std::min(n, b + batch); ++k) {
+				assert(i[k] < size());
+				if (m_max_level == 0) {
+					out(k, i[k], 0);
+				} else {
+					active[n_active++] = {0, m_size, i[k], k, 0, 0};
+					sdsl::prefetch_rank(m_tree_rank, i[k]);
+					sdsl::prefetch_rank(m_tree_rank, m_size);
+				}
+			}
+			while (n_active > 0) {
+				for (size_type j = 0; j < n_active;) {
+					state_type& s				= active[j];
+					size_type	ones_before_o   = m_tree_rank(s.offset);
+					size_type	ones_before_i   = m_tree_rank(s.offset + s.i) - ones_before_o;
+					size_type	ones_before_end = m_tree_rank(s.offset + s.node_size) - ones_before_o;
+					s.c <<= 1;
+					if (m_tree[s.offset + s.i]) { // go to the right child
+						s.offset += (s.node_size - ones_before_end);
+						s.node_size = ones_before_end;
+						s.i			= ones_before_i;
+						s.c |= 1;
+					} else { // go to the left child
+						s.node_size = (s.node_size - ones_before_end);
+						s.i			= (s.i - ones_before_i);
+					}
+					s.offset += m_size;
+					if (++s.level == m_max_level) {
+						out(s.k, s.i, s.c);
+						s = active[--n_active];
+					} else {
+						sdsl::prefetch_rank(m_tree_rank, s.offset);
+						sdsl::prefetch_rank(m_tree_rank, s.offset + s.i);
+						sdsl::prefetch_rank(m_tree_rank, s.offset + s.node_size);
+						++j;
+					}
+				}
+			}
+		}
+	}
+
 public:
 	const size_type&	   sigma = m_sigma; //!< Effective alphabet size of the wavelet tree.
 	const bit_vector_type& tree =
@@ -153,6 +209,11 @@ public:
          *    \par Time complexity
          *        \f$ \Order{n\log|\Sigma|}\f$, where \f$n=size\f$
          *        I.e. we need \Order{n\log n} if rac is a permutation of 0..n-1.
+         *
+         * If construct_config().num_threads is larger than one, the levels
+         * are filled in memory by several threads (see
+         * _construct_wt_levels_parallel) and no temporary files are used.
+         * The result does not depend on the number of threads.
          */
 	template <typename t_it>
 	wt_int(t_it begin, t_it end, std::string tmp_dir = ram_file_name(""))
@@ -167,6 +228,17 @@ public:
 			if (value > max_elem) max_elem = value;
 		}
 		m_max_level = bits::hi(max_elem) + 1;
+		if (parallel_threads(m_size, construct_config().num_threads) > 1) {
+			int_vector<> rac(m_size, 0, m_max_level);
+			std::copy(begin, end, rac.begin());
+			bit_vector tree;
+			m_sigma = _construct_wt_levels_parallel(rac, tree, false, construct_config().num_threads);
+			m_tree = bit_vector_type(std::move(tree));
+			util::init_support(m_tree_rank, &m_tree);
+			util::init_support(m_tree_select0, &m_tree);
+			util::init_support(m_tree_select1, &m_tree);
+			return;
+		}
 		std::string tree_out_buf_file_name = tmp_file(tmp_dir, "_m_tree");
 		{
 			int_vector<> rac(m_size, 0, m_max_level);
@@ -331,6 +403,18 @@ public:
 		return res;
 	};
 
+	//! Recovers the symbols at the positions i[0..n-1].
+	/*! \param i   Array of n indexes in the original vector.
+	 *  \param n   Number of queries.
+	 *  \param res Array of size n; res[k] = (*this)[i[k]].
+	 *
+	 *  The queries advance level by level as in rank_batch.
+	 */
+	void access_batch(const size_type* i, size_type n, value_type* res) const
+	{
+		_inverse_select_batch(i, n, [res](size_type k, size_type, value_type c) { res[k] = c; });
+	}
+
 	//! Calculates how many symbols c are in the prefix [0..i-1] of the supported vector.
 	/*!
          *  \param i The exclusive index of the prefix range [0..i-1], so \f$i\in[0..size()]\f$.
@@ -368,6 +452,69 @@ public:
 		return i;
 	};
 
+	//! Calculates rank(i[k], c[k]) for a batch of queries.
+	/*!
+	 * \param i   Array of n prefix lengths.
+	 * \param c   Array of n symbols.
+	 * \param n   Number of queries.
+	 * \param res Array of size n; res[k] = rank(i[k], c[k]).
+	 *
+	 * The queries advance level by level. Before a query descends, the rank
+	 * data of its next node is prefetched, so the cache misses of
+	 * independent queries overlap.
+	 */
+	void rank_batch(const size_type* i, const value_type* c, size_type n, size_type* res) const
+	{
+		const size_type batch = 64;
+		struct state_type {
+			size_type offset, node_size, i, k;
+			uint64_t  mask;
+			value_type c;
+		};
+		state_type active[batch];
+		for (size_type b = 0; b < n; b += batch) {
+			size_type n_active = 0;
+			for (size_type k = b; k < std::min(n, b + batch); ++k) {
+				if (((1ULL) << (m_max_level)) <= c[k]) {
+					res[k] = 0;
+				} else if (m_max_level == 0 or i[k] == 0) {
+					res[k] = i[k];
+				} else {
+					active[n_active++] = {0, m_size, i[k], k, (1ULL) << (m_max_level - 1), c[k]};
+					sdsl::prefetch_rank(m_tree_rank, i[k]);
+					sdsl::prefetch_rank(m_tree_rank, m_size);
+				}
+			}
+			while (n_active > 0) {
+				for (size_type j = 0; j < n_active;) {
+					state_type& s				= active[j];
+					size_type	ones_before_o   = m_tree_rank(s.offset);
+					size_type	ones_before_i   = m_tree_rank(s.offset + s.i) - ones_before_o;
+					size_type	ones_before_end = m_tree_rank(s.offset + s.node_size) - ones_before_o;
+					if (s.c & s.mask) {
+						s.offset += (s.node_size - ones_before_end);
+						s.node_size = ones_before_end;
+						s.i			= ones_before_i;
+					} else {
+						s.node_size = (s.node_size - ones_before_end);
+						s.i			= (s.i - ones_before_i);
+					}
+					s.offset += m_size;
+					s.mask >>= 1;
+					if (s.mask == 0 or s.i == 0) {
+						res[s.k] = s.i;
+						s		 = active[--n_active];
+					} else {
+						sdsl::prefetch_rank(m_tree_rank, s.offset);
+						sdsl::prefetch_rank(m_tree_rank, s.offset + s.i);
+						sdsl::prefetch_rank(m_tree_rank, s.offset + s.node_size);
+						++j;
+					}
+				}
+			}
+		}
+	}
+
 
 	//! Calculates how many occurrences of symbol wt[i] are in the prefix [0..i-1] of the original sequence.
 	/*!
@@ -401,6 +548,19 @@ public:
 		return std::make_pair(i, c);
 	}
 
+	//! Calculates inverse_select(i[k]) for a batch of queries.
+	/*! \param i   Array of n indexes in the original vector.
+	 *  \param n   Number of queries.
+	 *  \param res Array of size n; res[k] = inverse_select(i[k]).
+	 *
+	 *  The queries advance level by level as in rank_batch.
+	 */
+	void inverse_select_batch(const size_type* i, size_type n, std::pair<size_type, value_type>* res) const
+	{
+		_inverse_select_batch(
+		i, n, [res](size_type k, size_type r, value_type c) { res[k] = std::make_pair(r, c); });
+	}
+
 	//! Calculates the i-th occurrence of the symbol c in the supported vector.
 	/*!
          *  \param i The i-th occurrence.
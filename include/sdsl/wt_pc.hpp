@@ -13,6 +13,8 @@
 #include "rank_support.hpp"
 #include "select_support.hpp"
 #include "wt_helper.hpp"
+#include "construct_config.hpp"
+#include "construct_wt_parallel.hpp"
 #include <vector>
 #include <utility>
 #include <tuple>
@@ -148,6 +150,54 @@ private:
 		}
 	}
 
+	// batched version of inverse_select, which calls out(k, rank, symbol) for each query k
+	template <class t_out>
+	void _inverse_select_batch(const size_type* i, size_type n, t_out out) const
+	{
+		const size_type batch = 64;
+		struct state_type {
+			node_type v;
+			size_type i;
+			size_type k;
+		};
+		state_type active[batch];
+		node_type  root = m_tree.root();
+		for (size_type b = 0; b < n; b += batch) {
+			size_type n_active = 0;
+			for (size_type k = b; k < std::min(n, b + batch); ++k) {
+				assert(i[k] < size());
+				if (m_tree.is_leaf(root)) {
+					out(k, i[k], (value_type)m_tree.bv_pos_rank(root));
+				} else {
+					active[n_active++] = {root, i[k], k};
+					sdsl::prefetch_rank(m_bv_rank, m_tree.bv_pos(root) + i[k]);
+				}
+			}
+			while (n_active > 0) {
+				for (size_type j = 0; j < n_active;) {
+					state_type& s   = active[j];
+					size_type   pos = m_tree.bv_pos(s.v) + s.i;
+					size_type   r   = m_bv_rank(pos) - m_tree.bv_pos_rank(s.v);
+					if (m_bv[pos]) {
+						s.i = r;
+						s.v = m_tree.child(s.v, 1);
+					} else {
+						s.i -= r;
+						s.v = m_tree.child(s.v, 0);
+					}
+					if (m_tree.is_leaf(s.v)) {
+						// if v is a leaf bv_pos_rank returns symbol itself
+						out(s.k, s.i, (value_type)m_tree.bv_pos_rank(s.v));
+						s = active[--n_active];
+					} else {
+						sdsl::prefetch_rank(m_bv_rank, m_tree.bv_pos(s.v) + s.i);
+						++j;
+					}
+				}
+			}
+		}
+	}
+
 public:
 	const size_type&	   sigma = m_sigma;
 	const bit_vector_type& bv	= m_bv;
@@ -161,6 +211,10 @@ public:
          * \param end   Iterator one past the end of the input.
          * \par Time complexity
          *      \f$ \Order{n\log|\Sigma|}\f$, where \f$n=size\f$
+         *
+         * The bit vector is filled with construct_config().num_threads
+         * threads (see _construct_wt_pc_parallel); the result does not
+         * depend on the number of threads.
          */
 	template <typename t_it>
 	wt_pc(t_it begin, t_it end) : m_size(std::distance(begin, end))
@@ -179,30 +233,34 @@ public:
 		size_type tree_size = construct_tree_shape(C);
 		// 4. Generate wavelet tree bit sequence m_bv
 		bit_vector temp_bv(tree_size, 0);
-
-		// Initializing starting position of wavelet tree nodes
-		std::vector<uint64_t> bv_node_pos(m_tree.size(), 0);
-		for (size_type v = 0; v < m_tree.size(); ++v) {
-			bv_node_pos[v] = m_tree.bv_pos(v);
-		}
-		value_type old_chr = *begin;
-		uint32_t   times   = 0;
-		for (auto it = begin; it != end; ++it) {
-			value_type chr = *it;
-			if (chr != old_chr) {
-				insert_char(old_chr, bv_node_pos, times, temp_bv);
-				times   = 1;
-				old_chr = chr;
-			} else { // chr == old_chr
-				++times;
-				if (times == 64) {
+		if (parallel_threads(m_size, construct_config().num_threads) > 1) {
+			_construct_wt_pc_parallel(
+			begin, end, m_tree, C.size(), temp_bv, construct_config().num_threads);
+		} else {
+			// Initializing starting position of wavelet tree nodes
+			std::vector<uint64_t> bv_node_pos(m_tree.size(), 0);
+			for (size_type v = 0; v < m_tree.size(); ++v) {
+				bv_node_pos[v] = m_tree.bv_pos(v);
+			}
+			value_type old_chr = *begin;
+			uint32_t   times   = 0;
+			for (auto it = begin; it != end; ++it) {
+				value_type chr = *it;
+				if (chr != old_chr) {
 					insert_char(old_chr, bv_node_pos, times, temp_bv);
-					times = 0;
+					times   = 1;
+					old_chr = chr;
+				} else { // chr == old_chr
+					++times;
+					if (times == 64) {
+						insert_char(old_chr, bv_node_pos, times, temp_bv);
+						times = 0;
+					}
 				}
 			}
-		}
-		if (times > 0) {
-			insert_char(old_chr, bv_node_pos, times, temp_bv);
+			if (times > 0) {
+				insert_char(old_chr, bv_node_pos, times, temp_bv);
+			}
 		}
 		m_bv = bit_vector_type(std::move(temp_bv));
 		// 5. Initialize rank and select data structures for m_bv
@@ -310,6 +368,19 @@ public:
 		return m_tree.bv_pos_rank(v);
 	};
 
+	//! Recovers the symbols at the positions i[0..n-1].
+	/*!
+	 * \param i   Array of n indexes in the original vector.
+	 * \param n   Number of queries.
+	 * \param res Array of size n; res[k] = (*this)[i[k]].
+	 *
+	 * The queries advance level by level as in rank_batch.
+	 */
+	void access_batch(const size_type* i, size_type n, value_type* res) const
+	{
+		_inverse_select_batch(i, n, [res](size_type k, size_type, value_type c) { res[k] = c; });
+	}
+
 	//! Calculates how many symbols c are in the prefix [0..i-1].
 	/*!
          * \param i Exclusive right bound of the range.
@@ -346,6 +417,61 @@ public:
 		return result;
 	};
 
+	//! Calculates rank(i[k], c[k]) for a batch of queries.
+	/*!
+	 * \param i   Array of n prefix lengths.
+	 * \param c   Array of n symbols.
+	 * \param n   Number of queries.
+	 * \param res Array of size n; res[k] = rank(i[k], c[k]).
+	 *
+	 * The queries advance level by level through the tree. Before a query
+	 * descends, the rank data of its next node is prefetched, so the
+	 * cache misses of independent queries overlap.
+	 */
+	void rank_batch(const size_type* i, const value_type* c, size_type n, size_type* res) const
+	{
+		const size_type batch = 64;
+		struct state_type {
+			uint64_t  p;
+			uint32_t  path_len;
+			node_type v;
+			size_type result;
+			size_type k;
+		};
+		state_type active[batch];
+		for (size_type b = 0; b < n; b += batch) {
+			size_type n_active = 0;
+			for (size_type k = b; k < std::min(n, b + batch); ++k) {
+				if (!m_tree.is_valid(m_tree.c_to_leaf(c[k]))) {
+					res[k] = 0;
+				} else if (m_sigma == 1 or i[k] == 0) {
+					res[k] = i[k];
+				} else {
+					uint64_t p		 = m_tree.bit_path(c[k]);
+					active[n_active] = {p, (uint32_t)(p >> 56), m_tree.root(), i[k], k};
+					sdsl::prefetch_rank(m_bv_rank, m_tree.bv_pos(m_tree.root()) + i[k]);
+					++n_active;
+				}
+			}
+			while (n_active > 0) {
+				for (size_type j = 0; j < n_active;) {
+					state_type& s = active[j];
+					size_type	r = m_bv_rank(m_tree.bv_pos(s.v) + s.result) - m_tree.bv_pos_rank(s.v);
+					s.result	  = (s.p & 1) ? r : s.result - r;
+					s.v			  = m_tree.child(s.v, s.p & 1);
+					s.p >>= 1;
+					if (--s.path_len == 0 or s.result == 0) {
+						res[s.k] = s.result;
+						s		 = active[--n_active];
+					} else {
+						sdsl::prefetch_rank(m_bv_rank, m_tree.bv_pos(s.v) + s.result);
+						++j;
+					}
+				}
+			}
+		}
+	}
+
 	//! Calculates how many times symbol wt[i] occurs in the prefix [0..i-1].
 	/*!
          * \param i The index of the symbol.
@@ -373,6 +499,20 @@ public:
 		return std::make_pair(i, (value_type)m_tree.bv_pos_rank(v));
 	}
 
+	//! Calculates inverse_select(i[k]) for a batch of queries.
+	/*!
+	 * \param i   Array of n indexes in the original vector.
+	 * \param n   Number of queries.
+	 * \param res Array of size n; res[k] = inverse_select(i[k]).
+	 *
+	 * The queries advance level by level as in rank_batch.
+	 */
+	void inverse_select_batch(const size_type* i, size_type n, std::pair<size_type, value_type>* res) const
+	{
+		_inverse_select_batch(
+		i, n, [res](size_type k, size_type r, value_type c) { res[k] = std::make_pair(r, c); });
+	}
+
 	//! Calculates the ith occurrence of the symbol c in the supported vector.
 	/*!
          * \param i The ith occurrence.
@@ -1,6 +1,7 @@
 #include "sdsl/int_vector.hpp"
 #include "sdsl/bits.hpp"
 #include "sdsl/util.hpp"
+#include "sdsl/simd_popcount.hpp"
 #include "gtest/gtest.h"
 #include <vector>
 #include <string>
@@ -181,6 +182,61 @@ TEST_F(bits_test, rev)
     }
 }
 
+//! Compare the runtime dispatched kernels with the portable fallbacks
+TEST_F(bits_test, cpu_dispatch)
+{
+    const bool popcnt = sdsl::cpu_features::popcnt;
+    const bool bmi2 = sdsl::cpu_features::bmi2;
+    for (int mode=0; mode<4; ++mode) {
+        sdsl::cpu_features::popcnt = popcnt and (mode & 1);
+        sdsl::cpu_features::bmi2 = bmi2 and (mode & 2);
+        for (uint64_t i=0; i < 10000; ++i) {
+            uint64_t x = this->m_data[i];
+            uint32_t ones = cnt_naive(x);
+            ASSERT_EQ(ones, sdsl::bits::cnt(x));
+            ASSERT_EQ(hi_naive(x), sdsl::bits::hi(x));
+            ASSERT_EQ(lo_naive(x), sdsl::bits::lo(x));
+            for (uint32_t j=0, k=1; j<64; ++j) {
+                if ((x >> j)&1) {
+                    ASSERT_EQ(j, sdsl::bits::sel(x, k++)) << "mode=" << mode;
+                }
+            }
+        }
+    }
+    sdsl::cpu_features::popcnt = popcnt;
+    sdsl::cpu_features::bmi2 = bmi2;
+}
+
+TEST_F(bits_test, simd_popcount)
+{
+    const sdsl::simd_popcount::kernel_type kernels[] = {sdsl::simd_popcount::scalar,
+                                                        sdsl::simd_popcount::avx2,
+                                                        sdsl::simd_popcount::avx512
+                                                       };
+    const uint64_t* data = this->m_data.data();
+    // all block sizes up to 300 words at different offsets and the whole vector
+    for (uint64_t n=0; n<=300; ++n) {
+        for (uint64_t offset : {(uint64_t)0, (uint64_t)1, (uint64_t)5}) {
+            uint64_t expected = 0;
+            for (uint64_t i=0; i<n; ++i) {
+                expected += cnt_naive(data[offset+i]);
+            }
+            ASSERT_EQ(expected, sdsl::simd_popcount::words(data+offset, n));
+            for (auto kernel : kernels) {
+                if (sdsl::simd_popcount::supported(kernel)) {
+                    ASSERT_EQ(expected, sdsl::simd_popcount::words(kernel, data+offset, n))
+                            << "kernel = " << sdsl::simd_popcount::name(kernel);
+                }
+            }
+        }
+    }
+    uint64_t expected = sdsl::simd_popcount::words(sdsl::simd_popcount::scalar, data, m_data.size());
+    for (auto kernel : kernels) {
+        if (sdsl::simd_popcount::supported(kernel)) {
+            ASSERT_EQ(expected, sdsl::simd_popcount::words(kernel, data, m_data.size()));
+        }
+    }
+}
 
 }  // namespace
 
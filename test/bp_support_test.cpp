@@ -0,0 +1,183 @@
+#include "sdsl/bp_support.hpp"
+#include "gtest/gtest.h"
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace sdsl;
+using namespace std;
+
+namespace
+{
+
+string temp_dir;
+
+template<class T>
+class bp_support_test : public ::testing::Test { };
+
+using testing::Types;
+
+typedef Types<bp_support_rmm<64>,
+        bp_support_rmm<128, rank_support_v<>>,
+        bp_support_rmm<>,
+        bp_support_rmm<1024>
+        > Implementations;
+
+TYPED_TEST_CASE(bp_support_test, Implementations);
+
+// Random balanced parentheses sequence of length n with nested runs.
+bit_vector random_bp(uint64_t n, uint64_t seed)
+{
+    std::mt19937_64 rng(seed);
+    bit_vector bp(n, 0);
+    uint64_t excess = 0;
+    for (uint64_t i = 0; i < n; ++i) {
+        uint64_t left = n - i;
+        // deep nesting in the first half, flat sequences in the second
+        bool open = (i < n / 2) ? rng() % 8 != 0 : rng() % 2;
+        if (excess == 0 or (excess < left and open and excess + 1 < left)) {
+            bp[i] = 1;
+            ++excess;
+        } else {
+            --excess;
+        }
+    }
+    return bp;
+}
+
+struct naive_bp {
+    const bit_vector& bp;
+    vector<int64_t>   ex;
+    explicit naive_bp(const bit_vector& v) : bp(v), ex(v.size())
+    {
+        int64_t e = 0;
+        for (uint64_t i = 0; i < bp.size(); ++i)
+            ex[i] = (e += bp[i] ? 1 : -1);
+    }
+    int64_t excess(int64_t i) const { return i < 0 ? 0 : ex[i]; }
+    uint64_t fwd_excess(uint64_t i, int64_t rel) const
+    {
+        for (uint64_t j = i + 1; j < bp.size(); ++j)
+            if (ex[j] == ex[i] + rel) return j;
+        return bp.size();
+    }
+    uint64_t bwd_excess(uint64_t i, int64_t rel) const
+    {
+        for (int64_t j = (int64_t)i - 1; j >= -1; --j)
+            if (excess(j) == ex[i] + rel) return j;
+        return bp.size();
+    }
+    uint64_t find_close(uint64_t i) const { return bp[i] ? fwd_excess(i, -1) : i; }
+    uint64_t find_open(uint64_t i) const
+    {
+        if (bp[i]) return i;
+        uint64_t j = bwd_excess(i, 0);
+        return j == bp.size() ? j : j + 1;
+    }
+    uint64_t enclose(uint64_t i) const
+    {
+        if (!bp[i]) return find_open(i);
+        uint64_t j = bwd_excess(i, -2);
+        return j == bp.size() ? j : j + 1;
+    }
+    uint64_t level_anc(uint64_t i, uint64_t d) const
+    {
+        uint64_t j = bwd_excess(i, -(int64_t)d - 1);
+        return j == bp.size() ? j : j + 1;
+    }
+    uint64_t rmq(uint64_t l, uint64_t r) const
+    {
+        uint64_t res = l;
+        for (uint64_t j = l; j <= r; ++j)
+            if (ex[j] <= ex[res]) res = j;
+        return res;
+    }
+};
+
+TYPED_TEST(bp_support_test, balanced)
+{
+    for (uint64_t n : {2, 64, 1000, 20000}) {
+        bit_vector bp = random_bp(n, n);
+        naive_bp naive(bp);
+        TypeParam bps(&bp);
+        bp_support_sada<> sada(&bp);
+        ASSERT_EQ(n, bps.size());
+        for (uint64_t i = 0; i < n; ++i) {
+            ASSERT_EQ(naive.excess(i), bps.excess(i)) << " i=" << i;
+            ASSERT_EQ(naive.find_close(i), bps.find_close(i)) << " i=" << i;
+            ASSERT_EQ(naive.find_open(i), bps.find_open(i)) << " i=" << i;
+            ASSERT_EQ(naive.enclose(i), bps.enclose(i)) << " i=" << i;
+            for (uint64_t d : {0, 1, 3}) {
+                ASSERT_EQ(naive.level_anc(i, d), bps.level_anc(i, d)) << " i=" << i;
+            }
+            ASSERT_EQ(sada.preceding_closing_parentheses(i), bps.preceding_closing_parentheses(i));
+        }
+        std::mt19937_64 rng(n);
+        for (uint64_t q = 0; q < 2000; ++q) {
+            uint64_t l = rng() % n, r = rng() % n;
+            if (l > r) std::swap(l, r);
+            if (q % 2) r = std::min(n - 1, l + rng() % 300);
+            ASSERT_EQ(naive.rmq(l, r), bps.rmq(l, r)) << " l=" << l << " r=" << r;
+            if (bp[l] and bp[r] and l < r and bps.find_close(l) < r) {
+                ASSERT_EQ(sada.rr_enclose(l, r), bps.rr_enclose(l, r)) << " l=" << l << " r=" << r;
+                ASSERT_EQ(sada.double_enclose(l, r), bps.double_enclose(l, r));
+            }
+        }
+        for (uint64_t i = 1; i <= n / 2; ++i) {
+            ASSERT_EQ(sada.select(i), bps.select(i));
+            ASSERT_EQ(i, bps.rank(bps.select(i)));
+        }
+    }
+}
+
+TYPED_TEST(bp_support_test, unbalanced)
+{
+    std::mt19937_64 rng(3);
+    for (uint64_t n : {1, 100, 5000}) {
+        bit_vector bp(n, 0);
+        for (uint64_t i = 0; i < n; ++i)
+            bp[i] = rng() % 2;
+        naive_bp naive(bp);
+        TypeParam bps(&bp);
+        for (uint64_t i = 0; i < n; ++i) {
+            ASSERT_EQ(naive.find_close(i), bps.find_close(i)) << " i=" << i;
+            ASSERT_EQ(naive.find_open(i), bps.find_open(i)) << " i=" << i;
+            ASSERT_EQ(naive.enclose(i), bps.enclose(i)) << " i=" << i;
+        }
+    }
+}
+
+TYPED_TEST(bp_support_test, serialize)
+{
+    bit_vector bp = random_bp(10000, 5);
+    TypeParam bps(&bp);
+    string file = temp_dir + "/bp_support_test";
+    ASSERT_TRUE(store_to_file(bps, file));
+    TypeParam loaded;
+    {
+        std::ifstream in(file);
+        loaded.load(in, &bp);
+    }
+    TypeParam copied(bps), moved;
+    moved = std::move(copied);
+    for (uint64_t i = 0; i < bp.size(); ++i) {
+        ASSERT_EQ(bps.find_close(i), loaded.find_close(i));
+        ASSERT_EQ(bps.enclose(i), moved.enclose(i));
+    }
+    sdsl::remove(file);
+}
+
+}  // namespace
+
+int main(int argc, char** argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    if (argc < 2) {
+        // LCOV_EXCL_START
+        std::cout << "Usage: " << argv[0] << " tmp_dir" << std::endl;
+        return 1;
+        // LCOV_EXCL_STOP
+    }
+    temp_dir = argv[1];
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,112 @@
+#include "sdsl/construct.hpp"
+#include "sdsl/suffix_arrays.hpp"
+#include "sdsl/suffix_trees.hpp"
+#include "gtest/gtest.h"
+#include <random>
+#include <sstream>
+#include <string>
+
+namespace
+{
+
+using namespace sdsl;
+
+std::string temp_dir;
+
+class construct_plan_test : public ::testing::Test
+{
+};
+
+const uint64_t n = 1000000;
+
+TEST_F(construct_plan_test, plan)
+{
+    const uint64_t m = 100000000;
+    // unlimited memory: fastest algorithms
+    auto plan = plan_construction(m, 8, 8, true, false, 100 * m, 4);
+    ASSERT_TRUE(plan.fits);
+    ASSERT_TRUE(plan.bwt_is);
+    ASSERT_EQ((uint64_t)4, plan.wt_threads);
+    plan = plan_construction(m, 8, 8, true, true, 100 * m, 4);
+    ASSERT_FALSE(plan.bwt_is);
+    ASSERT_EQ(PARALLEL_PREFIX_DOUBLING, plan.sa_algo);
+    ASSERT_EQ((uint64_t)4, plan.sa_threads);
+    ASSERT_EQ(LCP_PHI_PARALLEL, plan.lcp_algo);
+    ASSERT_EQ((uint64_t)4, plan.lcp_threads);
+    // sequential in-memory algorithms
+    plan = plan_construction(m, 8, 8, false, true, 6 * m, 4);
+    ASSERT_TRUE(plan.fits);
+    ASSERT_EQ(LIBDIVSUFSORT, plan.sa_algo);
+    ASSERT_EQ((uint64_t)1, plan.sa_threads);
+    ASSERT_EQ(LCP_PHI, plan.lcp_algo);
+    ASSERT_LE(plan.peak_bytes, 6 * m);
+    // no SA algorithm fits: the leanest one is taken
+    plan = plan_construction(m, 8, 8, true, true, 4 * m, 4);
+    ASSERT_FALSE(plan.fits);
+    ASSERT_FALSE(plan.bwt_is);
+    ASSERT_EQ(LIBDIVSUFSORT, plan.sa_algo);
+    ASSERT_EQ(LCP_SEMI_EXTERN_PHI, plan.lcp_algo);
+    ASSERT_NE(std::string::npos, plan.to_string().find("exceeds budget"));
+    // divsufsort needs 64-bit integers for large inputs
+    plan = plan_construction(3000000000ULL, 8, 8, false, false, 8 * 3000000000ULL, 1);
+    ASSERT_TRUE(plan.fits);
+    ASSERT_EQ(SE_SAIS, plan.sa_algo);
+}
+
+template <class t_index>
+std::string build(const std::string& file, uint64_t budget)
+{
+    construct_config().memory_budget = budget;
+    t_index idx;
+    construct(idx, file, 1);
+    construct_config().memory_budget = 0;
+    std::stringstream ss;
+    idx.serialize(ss);
+    return ss.str();
+}
+
+TEST_F(construct_plan_test, construct)
+{
+    std::string file = temp_dir + "/construct_plan_test";
+    {
+        std::mt19937_64 rng(17);
+        std::string text(n, 'a');
+        for (auto& c : text) {
+            c = 'a' + rng() % 4;
+        }
+        std::ofstream out(file);
+        out << text;
+    }
+    construct_config().num_threads = 2;
+    std::string csa = build<csa_wt<>>(file, 0);
+    ASSERT_EQ(csa, build<csa_wt<>>(file, 7 * n));
+    ASSERT_EQ(LIBDIVSUFSORT, last_construct_plan().sa_algo);
+    ASSERT_TRUE(last_construct_plan().fits);
+    ASSERT_EQ(csa, build<csa_wt<>>(file, 100 * n));
+    ASSERT_TRUE(last_construct_plan().bwt_is);
+
+    std::string cst = build<cst_sct3<>>(file, 0);
+    ASSERT_EQ(cst, build<cst_sct3<>>(file, 3 * n));
+    ASSERT_FALSE(last_construct_plan().fits);
+    ASSERT_EQ(cst, build<cst_sct3<>>(file, 100 * n));
+    ASSERT_EQ(LCP_PHI_PARALLEL, last_construct_plan().lcp_algo);
+    // the settings are restored after the construction
+    ASSERT_EQ((uint64_t)2, construct_config().num_threads);
+    construct_config().num_threads = 1;
+    sdsl::remove(file);
+}
+
+}  // namespace
+
+int main(int argc, char** argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    if (argc < 2) {
+        // LCOV_EXCL_START
+        std::cout << "Usage: " << argv[0] << " tmp_dir" << std::endl;
+        return 1;
+        // LCOV_EXCL_STOP
+    }
+    temp_dir = argv[1];
+    return RUN_ALL_TESTS();
+}
@@ -1,9 +1,13 @@
 #include "common.hpp"
 #include "sdsl/suffix_arrays.hpp"
 #include "sdsl/coder.hpp"
+#include "sdsl/query_executor.hpp"
 #include "gtest/gtest.h"
 #include <vector>
 #include <string>
+#include <array>
+#include <random>
+#include <sstream>
 
 namespace
 {
@@ -66,6 +70,38 @@ TYPED_TEST(csa_byte_test, backward_search)
     ASSERT_EQ(r_res, (size_type)(csa.size() - 1));
 }
 
+//! Test backward_search_batch against backward_search
+TYPED_TEST(csa_byte_test, backward_search_batch)
+{
+    TypeParam csa;
+    ASSERT_TRUE(load_from_file(csa, temp_file));
+    int_vector<8> text;
+    ASSERT_TRUE(load_vector_from_file(text, test_file, 1));
+    std::mt19937_64 rng(17);
+    vector<string> patterns(1000);
+    for (size_type k=0; k<patterns.size(); ++k) {
+        if (text.size() > 0) {
+            size_type pos = rng() % text.size();
+            size_type len = 1 + rng() % 20;
+            for (size_type j=pos; j < text.size() and j < pos+len; ++j) {
+                patterns[k].push_back(text[j]);
+            }
+            if (k % 3 == 0) { // patterns which probably do not occur
+                patterns[k][rng() % patterns[k].size()] = 1 + rng() % 255;
+            }
+        }
+    }
+    vector<array<size_type, 2>> ranges;
+    backward_search_batch(csa, patterns, ranges);
+    ASSERT_EQ(patterns.size(), ranges.size());
+    for (size_type k=0; k<patterns.size(); ++k) {
+        size_type l_res, r_res;
+        backward_search(csa, 0, csa.size()-1, patterns[k].begin(), patterns[k].end(), l_res, r_res);
+        ASSERT_EQ(l_res, ranges[k][0]) << " k=" << k;
+        ASSERT_EQ(r_res, ranges[k][1]) << " k=" << k;
+    }
+}
+
 //! Test forward_search
 TYPED_TEST(csa_byte_test, forward_search)
 {
@@ -129,6 +165,37 @@ TYPED_TEST(csa_byte_test, sa_access)
     }
 }
 
+//! Test sa_range_batch against the suffix array
+TYPED_TEST(csa_byte_test, sa_range_batch)
+{
+    TypeParam csa;
+    ASSERT_TRUE(load_from_file(csa, temp_file));
+    int_vector<> sa;
+    load_from_file(sa, test_case_file_map[conf::KEY_SA]);
+    size_type n = sa.size();
+    int_vector<> packed(0, 0, bits::hi(n)+1);
+    for (size_type threads : {1, 3}) {
+        sa_range_batch(csa, 0, n-1, packed, threads);
+        ASSERT_EQ(n, packed.size());
+        for (size_type j=0; j<n; ++j) {
+            ASSERT_EQ(sa[j], packed[j])<<" j="<<j<<" threads="<<threads;
+        }
+    }
+    std::mt19937_64 rng(31);
+    std::vector<uint64_t> buf;
+    for (size_type k=0; k<100; ++k) {
+        size_type l = rng() % n;
+        size_type r = l + rng() % std::min(n-l, (size_type)500);
+        sa_range_batch(csa, l, r, buf, 2);
+        ASSERT_EQ(r+1-l, buf.size());
+        for (size_type j=l; j<=r; ++j) {
+            ASSERT_EQ(sa[j], buf[j-l])<<" j="<<j;
+        }
+    }
+    sa_range_batch(csa, 1, 0, buf);
+    ASSERT_EQ((size_type)0, buf.size());
+}
+
 //! Test inverse suffix access methods
 TYPED_TEST(csa_byte_test, isa_access)
 {
@@ -256,6 +323,164 @@ TYPED_TEST(csa_byte_test, swap)
 }
 
 
+//! Test locate against the SA values of the lexicographic interval
+TYPED_TEST(csa_byte_test, locate)
+{
+    TypeParam csa;
+    ASSERT_TRUE(load_from_file(csa, temp_file));
+    int_vector<8> text;
+    ASSERT_TRUE(load_vector_from_file(text, test_file, 1));
+    std::mt19937_64 rng(29);
+    std::vector<uint64_t> buf;
+    for (size_type k=0; k<1000 and text.size() > 0; ++k) {
+        size_type pos = rng() % text.size();
+        size_type len = 1 + rng() % 20;
+        string pat;
+        for (size_type j=pos; j < text.size() and j < pos+len; ++j) {
+            pat.push_back(text[j]);
+        }
+        auto occ = locate(csa, pat.begin(), pat.end());
+        auto interval = lex_interval(csa, pat.begin(), pat.end());
+        ASSERT_EQ(interval[1]+1-interval[0], occ.size()) << " k=" << k;
+        for (size_type i=0; i<occ.size(); ++i) {
+            ASSERT_EQ(csa[interval[0]+i], occ[i]) << " k=" << k << " i=" << i;
+        }
+        ASSERT_EQ(occ.size(), locate(csa, pat.begin(), pat.end(), buf, 2)) << " k=" << k;
+        for (size_type i=0; i<occ.size(); ++i) {
+            ASSERT_EQ(occ[i], buf[i]) << " k=" << k << " i=" << i;
+        }
+    }
+}
+
+//! Test the lazy locate_range and locate_first_k against the suffix array
+TYPED_TEST(csa_byte_test, locate_range)
+{
+    TypeParam csa;
+    ASSERT_TRUE(load_from_file(csa, temp_file));
+    int_vector<8> text;
+    ASSERT_TRUE(load_vector_from_file(text, test_file, 1));
+    std::mt19937_64 rng(37);
+    std::vector<uint64_t> buf;
+    bool large_walked = false;
+    for (size_type k=0; k<300 and text.size() > 0; ++k) {
+        size_type pos = rng() % text.size();
+        size_type len = rng() % 4; // short patterns have many occurrences
+        string pat;
+        for (size_type j=pos; j < text.size() and j < pos+len; ++j) {
+            pat.push_back(text[j]);
+        }
+        auto interval = lex_interval(csa, pat.begin(), pat.end());
+        size_type occs_cnt = interval[1]+1-interval[0];
+        locate_range<TypeParam> occs(csa, pat.begin(), pat.end());
+        ASSERT_EQ(occs_cnt, occs.size()) << " k=" << k;
+        ASSERT_EQ(occs_cnt, (size_type)(occs.end() - occs.begin()));
+        ASSERT_EQ(interval, occs.sa_interval());
+        // walk a large interval only once, short patterns match most of the text
+        size_type walk = 50;
+        if (occs_cnt <= 1000 or !large_walked) {
+            large_walked |= (occs_cnt > 1000);
+            walk = occs_cnt;
+        }
+        size_type i = 0;
+        for (auto it = occs.begin(); it != occs.end() and i < walk; ++it, ++i) {
+            ASSERT_EQ(csa[interval[0]+i], *it) << " k=" << k << " i=" << i;
+        }
+        ASSERT_EQ(std::min(walk, occs_cnt), i);
+        size_type first = rng() % (occs_cnt + 1), m = rng() % 40;
+        size_type got = occs.page(first, m, buf);
+        ASSERT_EQ(std::min(m, occs_cnt-first), got);
+        ASSERT_EQ(got, buf.size());
+        for (size_type j=0; j<got; ++j) {
+            ASSERT_EQ(csa[interval[0]+first+j], buf[j]) << " k=" << k << " j=" << j;
+        }
+        ASSERT_EQ(occs_cnt, locate_first_k(csa, pat.begin(), pat.end(), m, buf));
+        ASSERT_EQ(std::min(m, occs_cnt), buf.size());
+        for (size_type j=0; j<buf.size(); ++j) {
+            ASSERT_EQ(csa[interval[0]+j], buf[j]) << " k=" << k << " j=" << j;
+        }
+        ASSERT_EQ(interval, locate_range<TypeParam>(csa, interval).sa_interval());
+    }
+}
+
+//! Test loading from a memory mapped file
+TYPED_TEST(csa_byte_test, load_mapped)
+{
+    TypeParam csa1, csa2;
+    ASSERT_TRUE(load_from_file(csa1, temp_file));
+    ASSERT_TRUE(load_mapped(csa2, temp_file));
+    ASSERT_EQ(csa1.size(), csa2.size());
+    for (size_type j=0; j<csa1.size(); ++j) {
+        ASSERT_EQ(csa1[j], csa2[j]) << " j=" << j;
+        ASSERT_EQ(csa1.bwt[j], csa2.bwt[j]) << " j=" << j;
+    }
+    // aligned format
+    string aligned_file = temp_file + ".aligned";
+    ASSERT_TRUE(store_to_file_aligned(csa1, aligned_file));
+    TypeParam csa3, csa4;
+    ASSERT_TRUE(load_from_file(csa3, aligned_file));
+    uint64_t regions = mapped_regions::size();
+    ASSERT_TRUE(load_mapped(csa4, aligned_file));
+    // load_mapped falls back to load_from_file, check that csa4 points into the file
+    ASSERT_EQ(regions+1, mapped_regions::size());
+    ASSERT_EQ(size_in_bytes(csa1), size_in_bytes(csa4));
+    for (size_type j=0; j<csa1.size(); ++j) {
+        ASSERT_EQ(csa1[j], csa3[j]) << " j=" << j;
+        ASSERT_EQ(csa1[j], csa4[j]) << " j=" << j;
+        ASSERT_EQ(csa1.bwt[j], csa4.bwt[j]) << " j=" << j;
+    }
+    sdsl::remove(aligned_file);
+}
+
+//! Test that concurrent queries on a const CSA give the sequential results
+TYPED_TEST(csa_byte_test, query_executor)
+{
+    TypeParam csa;
+    ASSERT_TRUE(load_from_file(csa, temp_file));
+    int_vector<8> text;
+    ASSERT_TRUE(load_vector_from_file(text, test_file, 1));
+    std::mt19937_64 rng(23);
+    vector<string> patterns(2000);
+    vector<array<size_type, 2>> ranges(patterns.size());
+    for (size_type k=0; k<patterns.size(); ++k) {
+        size_type pos = rng() % csa.size();
+        size_type len = 1 + rng() % 10;
+        for (size_type j=pos; j < text.size() and j < pos+len; ++j) {
+            patterns[k].push_back(text[j]);
+        }
+        ranges[k] = {{pos, std::min(pos+len, csa.size())-1}};
+    }
+    query_executor<TypeParam> exec(csa, 4, 7);
+    ASSERT_EQ((size_type)4, exec.threads());
+    auto counts = exec.count(patterns);
+    auto occs = exec.locate(patterns);
+    auto strs = exec.extract(ranges);
+    ASSERT_EQ(patterns.size(), counts.size());
+    for (size_type k=0; k<patterns.size(); ++k) {
+        ASSERT_EQ(count(csa, patterns[k].begin(), patterns[k].end()), counts[k]) << " k=" << k;
+        auto exp_occ = locate(csa, patterns[k].begin(), patterns[k].end());
+        ASSERT_EQ(exp_occ, occs[k]) << " k=" << k;
+        ASSERT_EQ(extract(csa, ranges[k][0], ranges[k][1]), strs[k]) << " k=" << k;
+    }
+}
+
+//! Test construction of BWT and samples by induced sorting
+TYPED_TEST(csa_byte_test, bwt_is)
+{
+    TypeParam csa1, csa2;
+    ASSERT_TRUE(load_from_file(csa1, temp_file));
+    cache_config config(false, temp_dir, util::basename(test_file) + "_bwt_is");
+    construct_config().byte_bwt_is = true;
+    construct(csa2, test_file, config, 1);
+    construct_config().byte_bwt_is = false;
+    bool sa_cached = cache_file_exists(conf::KEY_SA, config);
+    util::delete_all_files(config.file_map);
+    ASSERT_FALSE(sa_cached and decltype(_bwt_is_support<TypeParam>(0))::value);
+    std::stringstream ss1, ss2;
+    csa1.serialize(ss1);
+    csa2.serialize(ss2);
+    ASSERT_EQ(ss1.str(), ss2.str());
+}
+
 TYPED_TEST(csa_byte_test, delete_)
 {
     sdsl::remove(temp_file);
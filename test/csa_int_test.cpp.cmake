@@ -4,6 +4,7 @@
 #include <cstdlib>
 #include <vector>
 #include <string>
+#include <random>
 #include <algorithm>
 
 namespace
@@ -77,6 +78,37 @@ TYPED_TEST(csa_int_test, sa_access)
 }
 
 
+//! Test sa_range_batch against the suffix array
+TYPED_TEST(csa_int_test, sa_range_batch)
+{
+    TypeParam csa;
+    ASSERT_TRUE(load_from_file(csa, temp_file));
+    int_vector<> sa;
+    load_from_file(sa, test_case_file_map[conf::KEY_SA]);
+    size_type n = sa.size();
+    int_vector<> packed(0, 0, bits::hi(n)+1);
+    for (size_type threads : {1, 3}) {
+        sa_range_batch(csa, 0, n-1, packed, threads);
+        ASSERT_EQ(n, packed.size());
+        for (size_type j=0; j<n; ++j) {
+            ASSERT_EQ(sa[j], packed[j])<<" j="<<j<<" threads="<<threads;
+        }
+    }
+    std::mt19937_64 rng(31);
+    std::vector<uint64_t> buf;
+    for (size_type k=0; k<100; ++k) {
+        size_type l = rng() % n;
+        size_type r = l + rng() % std::min(n-l, (size_type)500);
+        sa_range_batch(csa, l, r, buf, 2);
+        ASSERT_EQ(r+1-l, buf.size());
+        for (size_type j=l; j<=r; ++j) {
+            ASSERT_EQ(sa[j], buf[j-l])<<" j="<<j;
+        }
+    }
+    sa_range_batch(csa, 1, 0, buf);
+    ASSERT_EQ((size_type)0, buf.size());
+}
+
 //! Test inverse suffix access methods
 TYPED_TEST(csa_int_test, isa_access)
 {
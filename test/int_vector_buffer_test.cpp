@@ -689,6 +689,74 @@ TEST_F(int_vector_buffer_test, Reset)
     test_reset< sdsl::int_vector_buffer<64> >(vec_sizes);
 }
 
+
+template<class t_T>
+void test_async_io(size_type width, size_type depth)
+{
+    std::mt19937_64 rng(13);
+    std::string file_name = temp_dir+"/int_vector_buffer";
+    size_type buffersize = 1000;
+    size_type n = 20000;
+    uint64_t mask = sdsl::bits::lo_set[width];
+    std::vector<uint64_t> exp;
+    {
+        t_T ivb(file_name, std::ios::out, buffersize, width);
+        ivb.async_io(depth);
+        ASSERT_EQ(depth, ivb.async_io());
+        // sequential output
+        for (size_type i=0; i < n; ++i) {
+            exp.push_back(rng() & mask);
+            ivb.push_back(exp.back());
+        }
+        // sequential scan with modifications, forward and backward
+        for (size_type i=0; i < n; i += 3) {
+            ASSERT_EQ(exp[i], (uint64_t)ivb[i]);
+            exp[i] = rng() & mask;
+            ivb[i] = exp[i];
+        }
+        for (size_type i=n; i > 0; --i) {
+            ASSERT_EQ(exp[i-1], (uint64_t)ivb[i-1]);
+        }
+        // random access
+        for (size_type k=0; k < 2000; ++k) {
+            size_type i = rng() % n;
+            ASSERT_EQ(exp[i], (uint64_t)ivb[i]);
+            exp[i] = rng() & mask;
+            ivb[i] = exp[i];
+        }
+        ivb.buffersize(buffersize/2);
+        ASSERT_EQ(depth, ivb.async_io());
+        for (size_type i=0; i < n; ++i) {
+            ASSERT_EQ(exp[i], (uint64_t)ivb[i]);
+        }
+        ivb[5] = exp[5] = 1 & mask;
+        t_T ivb2(std::move(ivb));
+        ASSERT_EQ(depth, ivb2.async_io());
+        ASSERT_EQ(exp[5], (uint64_t)ivb2[5]);
+        ASSERT_TRUE(ivb2.good());
+        ivb2.close();
+    }
+    t_T ivb(file_name, std::ios::in, buffersize);
+    ivb.async_io(depth);
+    ASSERT_EQ((size_type)n, ivb.size());
+    for (size_type i=0; i < n; ++i) {
+        ASSERT_EQ(exp[i], (uint64_t)ivb[i]);
+    }
+    ASSERT_TRUE(ivb.good());
+    ivb.close(true);
+}
+
+//! Test read ahead and write behind of the asynchronous mode
+TEST_F(int_vector_buffer_test, async_io)
+{
+    for (size_type depth : {1, 2, 8}) {
+        for (size_type width : {1, 7, 13, 32, 64}) {
+            test_async_io< sdsl::int_vector_buffer<> >(width, depth);
+        }
+        test_async_io< sdsl::int_vector_buffer<8> >(8, depth);
+    }
+}
+
 }  // namespace
 
 int main(int argc, char** argv)
@@ -562,6 +562,92 @@ TEST_F(int_vector_test, serialize_and_load)
     test_SerializeAndLoad<sdsl::int_vector<64> >();
 }
 
+template<class t_iv>
+void test_LoadMapped(uint8_t width=1)
+{
+    std::mt19937_64 rng;
+    t_iv iv(1000000, 0, width);
+    for (size_type i=0; i<iv.size(); ++i)
+        iv[i] = rng();
+    std::string file_name = temp_dir+"/int_vector_mapped";
+    sdsl::store_to_file(iv, file_name);
+    {
+        t_iv iv2;
+        ASSERT_TRUE(sdsl::load_mapped(iv2, file_name));
+        ASSERT_TRUE(sdsl::memory_manager::is_mapped(iv2.data()));
+        ASSERT_TRUE(sdsl::memory_manager::is_mapped(iv2));
+        ASSERT_EQ(iv, iv2);
+        {
+            // a copy lives on the heap, a move keeps the mapping
+            t_iv copy(iv2);
+            ASSERT_FALSE(sdsl::memory_manager::is_mapped(copy));
+            t_iv moved(std::move(iv2));
+            ASSERT_TRUE(sdsl::memory_manager::is_mapped(moved));
+            ASSERT_FALSE(sdsl::memory_manager::is_mapped(iv2));
+            iv2 = std::move(moved);
+            ASSERT_TRUE(sdsl::memory_manager::is_mapped(iv2));
+        }
+        // modifications are private to the process
+        iv2[0] = iv[0] ^ 1;
+        t_iv iv3;
+        sdsl::load_from_file(iv3, file_name);
+        ASSERT_EQ(iv, iv3);
+        // resizing moves the data to the heap
+        iv2.resize(iv2.size() + 100);
+        ASSERT_FALSE(sdsl::memory_manager::is_mapped(iv2.data()));
+        ASSERT_FALSE(sdsl::memory_manager::is_mapped(iv2));
+        ASSERT_EQ(iv[1], iv2[1]);
+    }
+    {
+        // move assignment releases the mapping of the assigned vector
+        t_iv iv4;
+        ASSERT_TRUE(sdsl::load_mapped(iv4, file_name));
+        const uint64_t* mapped = iv4.data();
+        ASSERT_TRUE(sdsl::memory_manager::is_mapped(mapped));
+        iv4 = t_iv(10, 0, width);
+        ASSERT_FALSE(sdsl::memory_manager::is_mapped(iv4));
+        ASSERT_FALSE(sdsl::memory_manager::is_mapped(mapped));
+    }
+    sdsl::remove(file_name);
+}
+
+TEST_F(int_vector_test, load_mapped)
+{
+    test_LoadMapped<sdsl::bit_vector>();
+    test_LoadMapped<sdsl::int_vector<64> >();
+    test_LoadMapped<sdsl::int_vector<> >(13);
+}
+
+TEST_F(int_vector_test, store_aligned)
+{
+    std::mt19937_64 rng;
+    std::string file_name = temp_dir+"/int_vector_aligned";
+    for (uint8_t width : {1, 7, 64}) {
+        sdsl::int_vector<> iv(100000+width, 0, width);
+        for (size_type i=0; i<iv.size(); ++i)
+            iv[i] = rng();
+        ASSERT_TRUE(sdsl::store_to_file_aligned(iv, file_name));
+        std::vector<sdsl::toc_entry> toc;
+        ASSERT_TRUE(sdsl::read_toc(file_name, toc));
+        ASSERT_EQ((size_t)1, toc.size());
+        ASSERT_EQ((uint64_t)0, toc[0].offset % sdsl::aligned_format::alignment());
+        ASSERT_EQ(((iv.bit_size()+63)>>6)<<3, toc[0].size);
+        sdsl::int_vector<> iv2, iv3;
+        ASSERT_TRUE(sdsl::load_from_file(iv2, file_name));
+        ASSERT_EQ(iv, iv2);
+        ASSERT_TRUE(sdsl::load_mapped(iv3, file_name));
+        ASSERT_TRUE(sdsl::memory_manager::is_mapped(iv3.data()));
+        ASSERT_EQ(0U, ((uintptr_t)iv3.data()) % sdsl::aligned_format::alignment());
+        ASSERT_EQ(iv, iv3);
+    }
+    // files in the plain format have no table of contents
+    sdsl::int_vector<> iv(10, 3);
+    sdsl::store_to_file(iv, file_name);
+    std::vector<sdsl::toc_entry> toc;
+    ASSERT_FALSE(sdsl::read_toc(file_name, toc));
+    sdsl::remove(file_name);
+}
+
 TEST_F(int_vector_test, iterator_test)
 {
     for (auto i : vec_sizes) {
@@ -1,6 +1,9 @@
 #include "sdsl/k2_tree.hpp"
 #include "gtest/gtest.h"
 
+#include <algorithm>
+#include <random>
+#include <set>
 #include <sstream>
 #include <tuple>
 #include <vector>
@@ -13,6 +16,8 @@ using namespace std;
 
 typedef int_vector<>::size_type size_type;
 
+std::string temp_dir = ".";
+
 template<class T>
 class k2_tree_test_k_2 : public ::testing::Test { };
 
@@ -538,11 +543,125 @@ TYPED_TEST(k2_tree_test, serialize_test)
 
 }
 
+TYPED_TEST(k2_tree_test, build_from_files)
+{
+    typedef std::tuple<typename TypeParam::idx_type,
+            typename TypeParam::idx_type> t_tuple;
+    std::mt19937_64 rng(7);
+    std::string file = temp_dir + "/k2_tree_test_edges";
+    for (size_type size : {1, 2, 10, 100, 1000}) {
+        vector<t_tuple> e;
+        int_vector<> x(3 * size), y(3 * size);
+        for (size_type i = 0; i < x.size(); ++i) {
+            // duplicate some edges
+            size_type j = (i % 5 == 4) ? i - 1 : i;
+            x[i] = (j * 7919 + rng() % 3) % size;
+            y[i] = (j * 104729 + rng() % 3) % size;
+            if (j != i) {
+                x[i] = x[j];
+                y[i] = y[j];
+            }
+            e.push_back(t_tuple {x[i], y[i]});
+        }
+        store_to_file(x, file + ".x");
+        store_to_file(y, file + ".y");
+        TypeParam expected(e, size);
+        for (uint64_t threads : {1, 4}) {
+            construct_config().num_threads = threads;
+            // a run size of 7 edges merges several runs from disk
+            for (size_type run_size : {7, 1 << 20}) {
+                TypeParam tree(file, size, run_size);
+                ASSERT_EQ(expected, tree);
+            }
+        }
+        construct_config().num_threads = 1;
+    }
+    sdsl::remove(file + ".x");
+    sdsl::remove(file + ".y");
+}
+
+TYPED_TEST(k2_tree_test, build_from_files_large_ids)
+{
+    typedef std::tuple<typename TypeParam::idx_type,
+            typename TypeParam::idx_type> t_tuple;
+    std::string file = temp_dir + "/k2_tree_test_large";
+    // (k^2)^height exceeds 2^64, so the Z-order codes do not fit in a word
+    const size_type big = 1ULL << 40;
+    int_vector<> x = {0, 5, big - 1, big / 3};
+    int_vector<> y = {big - 1, 5, 0, big / 7};
+    vector<t_tuple> e;
+    for (size_type i = 0; i < x.size(); ++i) {
+        e.push_back(t_tuple {x[i], y[i]});
+    }
+    store_to_file(x, file + ".x");
+    store_to_file(y, file + ".y");
+    TypeParam expected(e, big);
+    TypeParam tree(file);
+    ASSERT_EQ(expected, tree);
+    for (size_type i = 0; i < x.size(); ++i) {
+        ASSERT_TRUE(tree.adj(x[i], y[i]));
+    }
+    ASSERT_FALSE(tree.adj(5, 0));
+    sdsl::remove(file + ".x");
+    sdsl::remove(file + ".y");
+}
+
+TYPED_TEST(k2_tree_test, neighbors_random)
+{
+    typedef typename TypeParam::idx_type idx_type;
+    typedef std::tuple<idx_type, idx_type> t_tuple;
+    std::mt19937_64 rng(13);
+    for (size_type size : {1, 7, 50, 300}) {
+        vector<t_tuple> e;
+        std::set<std::pair<idx_type, idx_type>> edges;
+        for (size_type i = 0; i < 4 * size; ++i) {
+            idx_type x = rng() % size, y = rng() % size;
+            e.push_back(t_tuple {x, y});
+            edges.insert({x, y});
+        }
+        TypeParam tree(e, size);
+        vector<idx_type> rows;
+        for (idx_type i = 0; i < size; ++i) {
+            vector<idx_type> neigh, reverse_neigh;
+            for (idx_type j = 0; j < size; ++j) {
+                if (edges.count({i, j})) neigh.push_back(j);
+                if (edges.count({j, i})) reverse_neigh.push_back(j);
+            }
+            ASSERT_EQ(neigh, tree.neigh(i));
+            ASSERT_EQ(reverse_neigh, tree.reverse_neigh(i));
+            rows.push_back(i);
+            rows.push_back(rng() % size);
+        }
+        auto neigh = tree.neigh_batch(rows);
+        auto reverse_neigh = tree.reverse_neigh_batch(rows);
+        ASSERT_EQ(rows.size(), neigh.size());
+        ASSERT_EQ(rows.size(), reverse_neigh.size());
+        for (size_type b = 0; b < rows.size(); ++b) {
+            ASSERT_EQ(tree.neigh(rows[b]), neigh[b]);
+            ASSERT_EQ(tree.reverse_neigh(rows[b]), reverse_neigh[b]);
+        }
+        for (uint64_t threads : {1, 4}) {
+            vector<vector<std::pair<idx_type, idx_type>>> found(threads);
+            tree.edge_scan([&](uint64_t t, idx_type i, idx_type j) {
+                found[t].push_back({i, j});
+            }, threads);
+            vector<std::pair<idx_type, idx_type>> all;
+            for (auto& f : found)
+                all.insert(all.end(), f.begin(), f.end());
+            std::sort(all.begin(), all.end());
+            vector<std::pair<idx_type, idx_type>> expected(edges.begin(), edges.end());
+            ASSERT_EQ(expected, all);
+        }
+    }
+}
+
 }  // namespace
 
 int main(int argc, char** argv)
 {
     ::testing::InitGoogleTest(&argc, argv);
-
+    if (argc > 1) {
+        temp_dir = argv[1];
+    }
     return RUN_ALL_TESTS();
 }
@@ -33,6 +33,8 @@ class lcp_construct_test : public ::testing::Test
             lcp_function["goPHI"] = &construct_lcp_goPHI;
             lcp_function["bwt_based"] = &construct_lcp_bwt_based<>;
             lcp_function["bwt_based2"] = &construct_lcp_bwt_based2<>;
+            lcp_function["PHI_parallel"] = &construct_lcp_PHI_parallel<8>;
+            construct_config().num_threads = 4;
 
             uint8_t num_bytes = 1;
             {
@@ -65,6 +67,7 @@ class lcp_construct_test : public ::testing::Test
         virtual void TearDown()
         {
             sdsl::remove(cache_file_name(CHECK_KEY, test_config));
+            construct_config().num_threads = 1;
         }
 
         cache_config test_config;
@@ -0,0 +1,156 @@
+#include "sdsl/int_vector.hpp"
+#include "sdsl/int_vector_buffer.hpp"
+#include "sdsl/io.hpp"
+#include "gtest/gtest.h"
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+SDSL_TRACK_ALL_ALLOCATIONS()
+
+namespace
+{
+
+using namespace sdsl;
+
+std::string temp_dir;
+
+class memory_monitor_test : public ::testing::Test
+{
+};
+
+// Returns the value of field of the event with the given name in the JSON profile.
+int64_t profile_value(const std::string& json, const std::string& name, const std::string& field)
+{
+    size_t pos = json.find("\"name\" : \"" + name + "\"");
+    if (pos == std::string::npos) {
+        return -1;
+    }
+    pos = json.find("\"" + field + "\" : ", pos);
+    if (pos == std::string::npos) {
+        return -1;
+    }
+    return std::stoll(json.substr(pos + field.size() + 5));
+}
+
+TEST_F(memory_monitor_test, profile)
+{
+    std::string file = temp_dir + "/memory_monitor_test";
+    memory_monitor::start();
+    {
+        auto event = memory_monitor::event("outer");
+        {
+            auto event = memory_monitor::event("write");
+            int_vector_buffer<64> buf(file, std::ios::out, 8 * 1024);
+            for (size_t i = 0; i < 100000; ++i) {
+                buf.push_back(i);
+            }
+        }
+        {
+            auto event = memory_monitor::event("load");
+            int_vector<64> v;
+            ASSERT_TRUE(load_from_file(v, file));
+            ASSERT_EQ((size_t)100000, v.size());
+        }
+        sdsl::remove(file);
+    }
+    memory_monitor::stop();
+
+    std::stringstream json;
+    memory_monitor::write_profile<JSON_FORMAT>(json);
+    std::string s = json.str();
+    ASSERT_LE(800000, profile_value(s, "write", "bytes_written"));
+    ASSERT_EQ(0, profile_value(s, "write", "bytes_read"));
+    ASSERT_LE(800000, profile_value(s, "load", "bytes_read"));
+    ASSERT_LE(800000, profile_value(s, "load", "peak_bytes"));
+    ASSERT_EQ(1, profile_value(s, "outer", "depth"));
+    ASSERT_EQ(2, profile_value(s, "load", "depth"));
+    // values of an event include its sub-events
+    ASSERT_LE(profile_value(s, "write", "bytes_written"), profile_value(s, "outer", "bytes_written"));
+    ASSERT_LE(profile_value(s, "load", "peak_bytes"), profile_value(s, "outer", "peak_bytes"));
+    ASSERT_LE(0, profile_value(s, "outer", "cpu_ms"));
+    ASSERT_LE(profile_value(s, "load", "wall_ms"), profile_value(s, "outer", "wall_ms"));
+
+    std::stringstream html;
+    memory_monitor::write_profile<HTML_FORMAT>(html);
+    ASSERT_NE(std::string::npos, html.str().find("\"name\" : \"outer\""));
+}
+
+TEST_F(memory_monitor_test, threads)
+{
+    const size_t threads = 8;
+    const size_t bytes = 1 << 20;
+    memory_monitor::start();
+    {
+        auto event = memory_monitor::event("threads");
+        std::vector<int_vector<8>> vectors(threads);
+        std::vector<std::thread> workers;
+        for (size_t t = 0; t < threads; ++t) {
+            workers.emplace_back([&vectors, t, bytes]() {
+                // many small allocations and frees besides the large one
+                for (size_t i = 0; i < 1000; ++i) {
+                    int_vector<8> tmp(i, 0);
+                }
+                vectors[t] = int_vector<8>(bytes, 0);
+            });
+        }
+        for (auto& w : workers) {
+            w.join();
+        }
+    }
+    memory_monitor::stop();
+
+    std::stringstream json;
+    memory_monitor::write_profile<JSON_FORMAT>(json);
+    std::string s = json.str();
+    ASSERT_LE((int64_t)(threads * bytes), profile_value(s, "threads", "peak_bytes"));
+    ASSERT_LE((int64_t)(threads * bytes), memory_monitor::peak());
+}
+
+TEST_F(memory_monitor_test, all_allocations)
+{
+    const size_t bytes = 4 << 20;
+    memory_monitor::start();
+    {
+        auto event = memory_monitor::event("std::vector");
+        std::vector<uint64_t> v(bytes / sizeof(uint64_t), 1);
+        ASSERT_EQ((uint64_t)1, v.back());
+    }
+    memory_monitor::stop();
+
+    std::stringstream json;
+    memory_monitor::write_profile<JSON_FORMAT>(json);
+    ASSERT_LE((int64_t)bytes, profile_value(json.str(), "std::vector", "peak_bytes"));
+}
+
+TEST_F(memory_monitor_test, own_allocations)
+{
+    // long names are not stored inline in a std::string
+    std::vector<std::string> names;
+    for (size_t i = 0; i < 1000; ++i) {
+        names.push_back("an event name which does not fit into the string " + std::to_string(i));
+    }
+    memory_monitor::start();
+    for (const auto& name : names) {
+        auto event = memory_monitor::event(name);
+    }
+    memory_monitor::stop();
+    // the event stack and the completed events are not counted
+    ASSERT_EQ(0, memory_monitor::peak());
+}
+
+}  // namespace
+
+int main(int argc, char** argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    if (argc < 2) {
+        // LCOV_EXCL_START
+        std::cout << "Usage: " << argv[0] << " tmp_dir" << std::endl;
+        return 1;
+        // LCOV_EXCL_STOP
+    }
+    temp_dir = argv[1];
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,247 @@
+#include "sdsl/query_cache.hpp"
+#include "sdsl/bp_support_sada.hpp"
+#include "sdsl/suffix_arrays.hpp"
+#include "sdsl/util.hpp"
+#include "gtest/gtest.h"
+#include <condition_variable>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+using namespace sdsl;
+
+std::string temp_dir;
+
+class query_cache_test : public ::testing::Test
+{
+};
+
+TEST_F(query_cache_test, disabled)
+{
+    query_cache c;
+    ASSERT_FALSE(c.enabled());
+    ASSERT_EQ((uint64_t)0, c.capacity());
+    uint64_t v = 0;
+    c.store(1, 2);
+    ASSERT_FALSE(c.lookup(1, v));
+    ASSERT_EQ((uint64_t)0, c.stats().hits + c.stats().misses);
+    c.configure(query_cache::shared, 0);
+    ASSERT_FALSE(c.enabled());
+}
+
+TEST_F(query_cache_test, policies_and_counters)
+{
+    for (auto policy : {query_cache::per_thread, query_cache::shared}) {
+        query_cache c(policy, 1000);
+        ASSERT_TRUE(c.enabled());
+        ASSERT_EQ(policy, c.policy());
+        ASSERT_EQ((uint64_t)1024, c.capacity());
+        uint64_t v = 0;
+        ASSERT_FALSE(c.lookup(42, v));
+        c.store(42, 4242);
+        ASSERT_TRUE(c.lookup(42, v));
+        ASSERT_EQ((uint64_t)4242, v);
+        ASSERT_FALSE(c.lookup(43, v));
+        ASSERT_EQ((uint64_t)1, c.stats().hits);
+        ASSERT_EQ((uint64_t)2, c.stats().misses);
+        c.reset_stats();
+        ASSERT_EQ((uint64_t)0, c.stats().hits + c.stats().misses);
+        // reconfiguring drops the entries
+        c.configure(policy, 1000);
+        ASSERT_FALSE(c.lookup(42, v));
+    }
+}
+
+TEST_F(query_cache_test, copy_and_move)
+{
+    for (auto policy : {query_cache::per_thread, query_cache::shared}) {
+        query_cache c1(policy, 64);
+        c1.store(7, 8);
+        // a copy has the same configuration, but no entries
+        query_cache c2(c1);
+        uint64_t    v = 0;
+        ASSERT_EQ(policy, c2.policy());
+        ASSERT_EQ(c1.capacity(), c2.capacity());
+        ASSERT_FALSE(c2.lookup(7, v));
+        ASSERT_TRUE(c1.lookup(7, v));
+        // a move transfers the entries
+        query_cache c3(std::move(c1));
+        ASSERT_FALSE(c1.enabled());
+        ASSERT_TRUE(c3.lookup(7, v));
+        ASSERT_EQ((uint64_t)8, v);
+    }
+}
+
+// A long-lived worker thread touches caches which are created, reconfigured
+// and destroyed by the main thread. Their tables must not stay allocated.
+TEST_F(query_cache_test, per_thread_tables_are_freed)
+{
+    const uint64_t          capacity = 1 << 16;
+    std::mutex              mtx;
+    std::condition_variable cv;
+    const query_cache*      task = nullptr;
+    bool                    done = false;
+    std::thread worker([&]() {
+        std::unique_lock<std::mutex> lock(mtx);
+        while (true) {
+            cv.wait(lock, [&]() { return task != nullptr or done; });
+            if (task == nullptr) return;
+            uint64_t v = 0;
+            task->store(1, 2);
+            task->lookup(1, v);
+            task = nullptr;
+            cv.notify_all();
+        }
+    });
+    auto run_on_worker = [&](const query_cache& c) {
+        std::unique_lock<std::mutex> lock(mtx);
+        task = &c;
+        cv.notify_all();
+        cv.wait(lock, [&]() { return task == nullptr; });
+    };
+    uint64_t before = query_cache::thread_table_bytes();
+    for (size_t i = 0; i < 100; ++i) {
+        query_cache c(query_cache::per_thread, capacity);
+        run_on_worker(c);
+        ASSERT_LT(before, query_cache::thread_table_bytes());
+        if (i % 2) {
+            c.configure(query_cache::per_thread, capacity);
+            ASSERT_EQ(before, query_cache::thread_table_bytes());
+            run_on_worker(c);
+        }
+    }
+    ASSERT_EQ(before, query_cache::thread_table_bytes());
+
+    // the table of an exiting thread is freed, while the cache lives on
+    query_cache c(query_cache::per_thread, capacity);
+    run_on_worker(c);
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        done = true;
+        cv.notify_all();
+    }
+    worker.join();
+    ASSERT_EQ(before, query_cache::thread_table_bytes());
+}
+
+// Each thread stores f(key) and checks every hit against f(key).
+TEST_F(query_cache_test, concurrent)
+{
+    auto f = [](uint64_t key) { return key * 0x9E3779B97F4A7C15ULL + 1; };
+    for (auto policy : {query_cache::per_thread, query_cache::shared}) {
+        query_cache              c(policy, 256);
+        std::vector<std::thread> threads;
+        std::vector<uint64_t>    errors(4, 0);
+        for (size_t t = 0; t < 4; ++t) {
+            threads.emplace_back([&, t]() {
+                std::mt19937_64 rng(t);
+                for (size_t i = 0; i < 200000; ++i) {
+                    uint64_t key = rng() % 1024, v = 0;
+                    if (c.lookup(key, v)) {
+                        errors[t] += (v != f(key));
+                    } else {
+                        c.store(key, f(key));
+                    }
+                }
+            });
+        }
+        for (auto& t : threads)
+            t.join();
+        for (auto e : errors)
+            ASSERT_EQ((uint64_t)0, e);
+        auto stats = c.stats();
+        ASSERT_EQ((uint64_t)800000, stats.hits + stats.misses);
+        ASSERT_LT((uint64_t)0, stats.hits);
+    }
+}
+
+// Answers of bp_support_sada must not depend on the cache.
+TEST_F(query_cache_test, bp_support_sada)
+{
+    std::mt19937_64 rng(17);
+    bit_vector      bp(100000, 0);
+    size_t          excess = 0;
+    for (size_t i = 0; i < bp.size(); ++i) {
+        size_t left = bp.size() - i;
+        if (excess == 0 or (excess < left - 1 and rng() % 2)) {
+            bp[i] = 1;
+            ++excess;
+        } else {
+            --excess;
+        }
+    }
+    bp_support_sada<> bps(&bp);
+    std::vector<uint64_t> expected;
+    for (size_t i = 0; i < bp.size(); ++i) {
+        expected.push_back(bp[i] ? bps.find_close(i) : bps.find_open(i));
+    }
+    for (auto policy : {query_cache::per_thread, query_cache::shared}) {
+        bps.cache().configure(policy, 1024);
+        for (size_t round = 0; round < 2; ++round) {
+            for (size_t i = 0; i < bp.size(); ++i) {
+                uint64_t r = bp[i] ? bps.find_close(i) : bps.find_open(i);
+                ASSERT_EQ(expected[i], r) << " i=" << i;
+            }
+            for (size_t i = 1; i <= bp.size() / 2; i += 97) {
+                ASSERT_LT(bps.select(i), bp.size());
+                ASSERT_TRUE(bp[bps.select(i)]);
+            }
+        }
+        ASSERT_LT((uint64_t)0, bps.cache().stats().hits);
+    }
+}
+
+// locate on a csa_wt must use its cache, if the cache is enabled.
+TEST_F(query_cache_test, csa_wt_locate)
+{
+    std::mt19937_64 rng(19);
+    std::string     text(20000, 'a');
+    for (auto& c : text) {
+        c = "acgt"[rng() % 4];
+    }
+    csa_wt<> csa;
+    construct_im(csa, text, 1);
+    std::vector<std::string> patterns;
+    for (size_t k = 0; k < 100; ++k) {
+        patterns.push_back(text.substr(rng() % (text.size() - 4), 4));
+    }
+    std::vector<std::vector<uint64_t>> expected;
+    for (const auto& pat : patterns) {
+        expected.push_back(locate<csa_wt<>, std::string::const_iterator, std::vector<uint64_t>>(
+        csa, pat.begin(), pat.end()));
+        for (auto pos : expected.back()) {
+            ASSERT_EQ(pat, text.substr(pos, pat.size()));
+        }
+    }
+    std::vector<uint64_t> buf;
+    for (auto policy : {query_cache::per_thread, query_cache::shared}) {
+        csa.cache().configure(policy, 1024);
+        for (size_t round = 0; round < 2; ++round) {
+            for (size_t k = 0; k < patterns.size(); ++k) {
+                locate(csa, patterns[k].begin(), patterns[k].end(), buf);
+                ASSERT_EQ(expected[k], buf) << " k=" << k;
+            }
+        }
+        ASSERT_LT((uint64_t)0, csa.cache().stats().hits);
+    }
+}
+
+}  // namespace
+
+int main(int argc, char** argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    if (argc < 2) {
+        // LCOV_EXCL_START
+        std::cout << "Usage: " << argv[0] << " tmp_dir" << std::endl;
+        return 1;
+        // LCOV_EXCL_STOP
+    }
+    temp_dir = argv[1];
+    return RUN_ALL_TESTS();
+}
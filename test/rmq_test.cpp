@@ -1,9 +1,11 @@
 #include "common.hpp"
 #include "sdsl/rmq_support.hpp"
+#include "sdsl/bp_support_rmm.hpp"
 #include "gtest/gtest.h"
 #include <vector>
 #include <string>
 #include <stack>
+#include <random>
 
 using namespace std;
 using namespace sdsl;
@@ -24,7 +26,11 @@ class rmq_test : public ::testing::Test { };
 using testing::Types;
 
 typedef Types<sdsl::rmq_succinct_sct<>,
-        sdsl::rmq_succinct_sada<>
+        sdsl::rmq_succinct_sada<>,
+        sdsl::rmq_succinct_sct<true, sdsl::bp_support_rmm<>>,
+        sdsl::rmq_succinct_sada<true, sdsl::bp_support_rmm<>>,
+        sdsl::rmq_support_block<>,
+        sdsl::rmq_support_block<int_vector<>, true, 16>
         > Implementations;
 
 TYPED_TEST_CASE(rmq_test, Implementations);
@@ -130,6 +136,39 @@ TYPED_TEST(rmq_test, rmq_load_and_move_and_query)
 }
 
 
+//! Test rmq_batch of rmq_support_block against the sparse table
+TEST(rmq_block_test, batch_and_maximum)
+{
+    int_vector<> v;
+    ASSERT_TRUE(load_from_file(v, test_file));
+    if (v.size() == 0)
+        return;
+    rmq_support_block<> rmq_min(&v);
+    range_maximum_support_block<> rmq_max(&v);
+    rmq_support_sparse_table<> st_min(&v);
+    range_maximum_support_sparse_table<> st_max(&v);
+    std::mt19937_64 rng(17);
+    vector<pair<uint64_t, uint64_t>> q(10000);
+    for (uint64_t k = 0; k < q.size(); ++k) {
+        uint64_t l = rng() % v.size(), r = rng() % v.size();
+        if (l > r)
+            std::swap(l, r);
+        if (k % 2)
+            r = std::min(v.size() - 1, l + rng() % 200); // short queries
+        q[k] = {l, r};
+    }
+    vector<uint64_t> res_min(q.size()), res_max(q.size());
+    rmq_min.rmq_batch(q.data(), q.size(), res_min.data());
+    rmq_max.rmq_batch(q.data(), q.size(), res_max.data());
+    for (uint64_t k = 0; k < q.size(); ++k) {
+        uint64_t l = q[k].first, r = q[k].second;
+        ASSERT_EQ(st_min(l, r), res_min[k]) << "[" << l << "," << r << "]";
+        ASSERT_EQ(st_min(l, r), rmq_min(l, r));
+        ASSERT_EQ(st_max(l, r), res_max[k]) << "[" << l << "," << r << "]";
+        ASSERT_EQ(st_max(l, r), rmq_max(l, r));
+    }
+}
+
 TYPED_TEST(rmq_test, delete_)
 {
     sdsl::remove(temp_file);
@@ -52,6 +52,28 @@ TEST_F(sa_construct_test, divsufsort)
          << " bytes in total" << endl;
 }
 
+TEST_F(sa_construct_test, parallel)
+{
+    // Construct SA with the parallel prefix doubling algorithm
+    construct_config().byte_algo_sa = PARALLEL_PREFIX_DOUBLING;
+    for (uint64_t threads : {1, 4}) {
+        construct_config().num_threads = threads;
+        construct_sa<8>(config);
+        {
+            int_vector_buffer<> sa_check(cache_file_name("check_sa", config));
+            int_vector_buffer<> sa(cache_file_name(conf::KEY_SA, config));
+            ASSERT_EQ(sa_check.size(), sa.size()) << " suffix array size differ";
+            for (uint64_t i=0; i<sa_check.size(); ++i) {
+                ASSERT_EQ(sa_check[i], sa[i]) << " sa differs at position " << i
+                                              << " for " << threads << " threads";
+            }
+        }
+        sdsl::remove(cache_file_name(conf::KEY_SA, config));
+        config.file_map.erase(conf::KEY_SA);
+    }
+    construct_config().num_threads = 1;
+}
+
 TEST_F(sa_construct_test, sesais)
 {
     // Construct SA with seSAIS
@@ -155,6 +155,81 @@ TYPED_TEST(wt_byte_test, inverse_select)
     }
 }
 
+template<class t_wt>
+auto
+test_batch(const t_wt& wt, const int_vector<8>& text, int)
+-> decltype(wt.access_batch(nullptr, 0, nullptr), void())
+{
+    typedef typename t_wt::value_type value_type;
+    if (text.empty()) return;
+    std::mt19937_64 rng(13);
+    size_type n = std::min((size_type)20000, 3*text.size());
+    std::vector<size_type> idx(n), pos(n), ranks(n);
+    std::vector<value_type> c(n), syms(n);
+    std::vector<std::pair<size_type, value_type>> inv(n);
+    for (size_type k=0; k < n; ++k) {
+        idx[k] = rng() % text.size();
+        pos[k] = rng() % (text.size()+1);
+        c[k] = (k % 8 == 7) ? (value_type)(rng() % 256) : (value_type)text[rng() % text.size()];
+    }
+    wt.access_batch(idx.data(), n, syms.data());
+    wt.inverse_select_batch(idx.data(), n, inv.data());
+    wt.rank_batch(pos.data(), c.data(), n, ranks.data());
+    for (size_type k=0; k < n; ++k) {
+        ASSERT_EQ(text[idx[k]], syms[k]) << " k=" << k;
+        ASSERT_EQ(wt.inverse_select(idx[k]), inv[k]) << " k=" << k;
+        ASSERT_EQ(wt.rank(pos[k], c[k]), ranks[k]) << " k=" << k << " c=" << c[k];
+    }
+}
+
+template<class t_wt>
+void
+test_batch(const t_wt&, const int_vector<8>&, long)
+{
+    // batch methods not implemented
+}
+
+//! Test the batched access, rank and inverse_select methods
+TYPED_TEST(wt_byte_test, batch)
+{
+    TypeParam wt;
+    ASSERT_TRUE(load_from_file(wt, temp_file));
+    int_vector<8> text;
+    ASSERT_TRUE(load_vector_from_file(text, test_file, 1));
+    ASSERT_EQ(text.size(), wt.size());
+    test_batch<TypeParam>(wt, text, 0);
+}
+
+//! Test that the construction with several threads yields the same sequence
+TYPED_TEST(wt_byte_test, parallel_construct)
+{
+    int_vector<8> text;
+    ASSERT_TRUE(load_vector_from_file(text, test_file, 1));
+    if (text.size() == 0) {
+        return;
+    }
+    // repeat the text, so that it is split among the threads
+    int_vector<8> big(std::max((size_type)1 << 18, text.size()));
+    for (size_type i=0; i < big.size(); ++i) {
+        big[i] = text[i % text.size()];
+    }
+    TypeParam wt_seq, wt_par;
+    construct_im(wt_seq, big);
+    construct_config().num_threads = 4;
+    construct_im(wt_par, big);
+    construct_config().num_threads = 1;
+    // compare the answers, the serialized bytes may contain uninitialized padding
+    ASSERT_EQ(wt_seq.size(), wt_par.size());
+    ASSERT_EQ(wt_seq.sigma, wt_par.sigma);
+    for (size_type i=0; i < big.size(); ++i) {
+        auto c = wt_seq[i];
+        ASSERT_EQ(c, wt_par[i]) << " i=" << i;
+        size_type r = wt_seq.rank(i, c);
+        ASSERT_EQ(r, wt_par.rank(i, c)) << " i=" << i;
+        ASSERT_EQ(i, wt_par.select(r+1, c)) << " i=" << i;
+    }
+}
+
 template<class t_wt>
 void
 test_interval_symbols(typename std::enable_if<!(has_node_type<t_wt>::value),